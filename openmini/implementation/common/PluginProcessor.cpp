@@ -22,21 +22,43 @@
 // This file is NOT generated by Juce (at least not after the first time),
 // That's why we apply our coding style here
 
+// std::numeric_limits
+#include <limits>
 
 #include "openmini/implementation/common/PluginProcessor.h"
 #include "openmini/implementation/common/PluginEditor.h"
 #include "openmini/src/synthesizer/parameter_meta.h"
+#include "openmini/src/synthesizer/parameters.h"
 
 OpenMiniAudioProcessor::OpenMiniAudioProcessor()
   : keyboard_state_(),
     lastUIWidth(kMaxWindowWidth / 2),
     lastUIHeight(kMaxWindowHeight / 2),
+#if defined(_ENABLE_MULTITIMBRAL)
+    parts_(),
+#else
     synth_(),
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+#if defined(_ENABLE_RENDER_AHEAD)
+    render_ahead_(nullptr),
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+    pooled_renderer_(nullptr),
+#endif  // defined(_ENABLE_SHARED_POOL)
     process_time_(0.0) {
-  // Manually create one output bus
   busArrangement.inputBuses.clear();
   busArrangement.outputBuses.clear();
+#if defined(_ENABLE_MULTITIMBRAL)
+  // One output bus per part
+  for (unsigned int channel(0);
+       channel < openmini::synthesizer::kMidiChannelsCount;
+       ++channel) {
+    busArrangement.outputBuses.add(AudioProcessorBus(String("Output #") += String(channel + 1), AudioChannelSet::mono()));
+  }
+#else
+  // Manually create one output bus
   busArrangement.outputBuses.add(AudioProcessorBus(String("Output #") += String(1), AudioChannelSet::mono()));
+#endif  // defined(_ENABLE_MULTITIMBRAL)
 }
 
 OpenMiniAudioProcessor::~OpenMiniAudioProcessor() {
@@ -47,25 +69,45 @@ const juce::String OpenMiniAudioProcessor::getName() const {
 }
 
 int OpenMiniAudioProcessor::getNumParameters() {
+#if defined(_ENABLE_MULTITIMBRAL)
+  return ParameterOwner(0).ParametersCount()
+         * openmini::synthesizer::kMidiChannelsCount;
+#else
   return synth_.ParametersCount();
+#endif  // defined(_ENABLE_MULTITIMBRAL)
 }
 
 float OpenMiniAudioProcessor::getParameter(int index) {
-  return synth_.GetValue(index);
+#if defined(_ENABLE_RENDER_AHEAD)
+  if (render_ahead_ != nullptr) {
+    // The worker thread owns the synthesizer: last values set are cached
+    return render_ahead_->GetValue(index);
+  }
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+  return ParameterOwner(index).GetValue(ParameterId(index));
 }
 
 void OpenMiniAudioProcessor::setParameter(int index, float newValue) {
-  synth_.SetValue(index, newValue);
+#if defined(_ENABLE_RENDER_AHEAD)
+  if (render_ahead_ != nullptr) {
+    // The worker thread owns the synthesizer
+    render_ahead_->SetValue(index, newValue);
+  } else {
+    synth_.SetValue(index, newValue);
+  }
+#else
+  ParameterOwner(index).SetValue(ParameterId(index), newValue);
+#endif  // defined(_ENABLE_RENDER_AHEAD)
   // Inform UI of any change
   sendChangeMessage();
 }
 
 const juce::String OpenMiniAudioProcessor::getParameterName(int index) {
-  return juce::String(synth_.GetMetadata(index).name());
+  return juce::String(ParameterOwner(index).GetMetadata(ParameterId(index)).name());
 }
 
 const juce::String OpenMiniAudioProcessor::getParameterText(int index) {
-  return juce::String(synth_.GetMetadata(index).description());
+  return juce::String(ParameterOwner(index).GetMetadata(ParameterId(index)).description());
 }
 
 bool OpenMiniAudioProcessor::acceptsMidi() const {
@@ -85,7 +127,24 @@ bool OpenMiniAudioProcessor::producesMidi() const {
 }
 
 double OpenMiniAudioProcessor::getTailLengthSeconds() const {
-  return 0.0;
+#if defined(_ENABLE_MULTITIMBRAL)
+  const unsigned int tail(parts_.TailLength());
+#elif defined(_ENABLE_RENDER_AHEAD)
+  // The worker thread owns the synthesizer: its last tail is published
+  const unsigned int tail((render_ahead_ != nullptr)
+                          ? render_ahead_->TailLength()
+                          : synth_.TailLength());
+#else
+  const unsigned int tail(synth_.TailLength());
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+  if (tail == openmini::synthesizer::kInfiniteTail) {
+    return std::numeric_limits<double>::infinity();
+  }
+  const double sampling_rate(getSampleRate());
+  if (sampling_rate <= 0.0) {
+    return 0.0;
+  }
+  return static_cast<double>(tail) / sampling_rate;
 }
 
 int OpenMiniAudioProcessor::getNumPrograms() {
@@ -111,13 +170,56 @@ void OpenMiniAudioProcessor::prepareToPlay(double sampleRate,
                                            int samplesPerBlock) {
   // Notify UI of the last changes
   sendChangeMessage();
+#if defined(_ENABLE_RENDER_AHEAD)
+  // The synthesizer has to be released by the worker before being prepared
+  render_ahead_ = nullptr;
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+  // Same with the pool
+  pooled_renderer_ = nullptr;
+#endif  // defined(_ENABLE_SHARED_POOL)
+#if defined(_ENABLE_MULTITIMBRAL)
+  parts_.SetOutputSamplingFrequency(static_cast<float>(sampleRate));
+  // Internal buffers are allocated and parts registered into the pool here
+  if (samplesPerBlock > 0) {
+    parts_.SetMaxBlockSize(static_cast<unsigned int>(samplesPerBlock));
+  }
+#else
   synth_.SetOutputSamplingFrequency(static_cast<float>(sampleRate));
+  // Internal buffers are allocated here, not during processing
+  if (samplesPerBlock > 0) {
+    synth_.SetMaxBlockSize(static_cast<unsigned int>(samplesPerBlock));
+  }
+#endif  // defined(_ENABLE_MULTITIMBRAL)
   keyboard_state_.reset();
+#if defined(_ENABLE_RENDER_AHEAD)
+  render_ahead_ = new openmini::synthesizer::RenderAhead(&synth_,
+                                                         _RENDER_AHEAD_SAMPLES);
+  // Events are re-rendered as soon as received: no latency to report,
+  // they only are quantized to one block (as direct rendering does)
+  setLatencySamples(0);
+  render_ahead_->Start();
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+  if (samplesPerBlock > 0) {
+    pooled_renderer_ = new openmini::synthesizer::PooledRenderer(
+      &synth_,
+      static_cast<unsigned int>(samplesPerBlock));
+    // Output is delayed by one block
+    setLatencySamples(static_cast<int>(pooled_renderer_->Latency()));
+  }
+#endif  // defined(_ENABLE_SHARED_POOL)
 }
 
 void OpenMiniAudioProcessor::releaseResources() {
   // When playback stops, you can use this as an opportunity to free up any
   // spare memory, etc.
+#if defined(_ENABLE_RENDER_AHEAD)
+  render_ahead_ = nullptr;
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+  pooled_renderer_ = nullptr;
+#endif  // defined(_ENABLE_SHARED_POOL)
 }
 
 void OpenMiniAudioProcessor::processBlock(juce::AudioSampleBuffer& buffer,
@@ -129,6 +231,13 @@ void OpenMiniAudioProcessor::processBlock(juce::AudioSampleBuffer& buffer,
                                         buffer.getNumSamples(),
                                         true);
 
+#if defined(_ENABLE_SHARED_POOL)
+  // The synthesizer may be being rendered by the pool since the last block
+  if (pooled_renderer_ != nullptr) {
+    pooled_renderer_->Sync();
+  }
+#endif  // defined(_ENABLE_SHARED_POOL)
+
   // Iterating on midi messages...
   juce::MidiBuffer::Iterator midi_iterator(midiMessages);
   juce::MidiMessage midi_message;
@@ -137,9 +246,9 @@ void OpenMiniAudioProcessor::processBlock(juce::AudioSampleBuffer& buffer,
                                                 midi_event_position);
   while (event_found) {
     if (midi_message.isNoteOn()) {
-      triggerNoteOn(midi_message.getNoteNumber());
+      triggerNoteOn(midi_message.getChannel(), midi_message.getNoteNumber());
     } else if (midi_message.isNoteOff()) {
-      triggerNoteOff(midi_message.getNoteNumber());
+      triggerNoteOff(midi_message.getChannel(), midi_message.getNoteNumber());
     }
     event_found = midi_iterator.getNextEvent(midi_message,
                                              midi_event_position);
@@ -148,7 +257,57 @@ void OpenMiniAudioProcessor::processBlock(juce::AudioSampleBuffer& buffer,
 
   const double counter_start(juce::Time::getMillisecondCounterHiRes());
 
+#if defined(_ENABLE_RENDER_AHEAD)
+  bool silent(false);
+  if (render_ahead_ != nullptr) {
+    render_ahead_->ProcessAudio(buffer.getArrayOfWritePointers()[0],
+                                buffer.getNumSamples());
+    silent = render_ahead_->IsOutputSilent();
+  } else {
+    synth_.ProcessAudio(buffer.getArrayOfWritePointers()[0],
+                        buffer.getNumSamples());
+    silent = synth_.IsOutputSilent();
+  }
+  // Flag the buffer as silent so that hosts may skip mixing it
+  if (silent) {
+    buffer.clear();
+  }
+#elif defined(_ENABLE_SHARED_POOL)
+  bool silent(false);
+  if (pooled_renderer_ != nullptr) {
+    pooled_renderer_->ProcessAudio(buffer.getArrayOfWritePointers()[0],
+                                   buffer.getNumSamples());
+    silent = pooled_renderer_->IsOutputSilent();
+  } else {
+    synth_.ProcessAudio(buffer.getArrayOfWritePointers()[0],
+                        buffer.getNumSamples());
+    silent = synth_.IsOutputSilent();
+  }
+  // Flag the buffer as silent so that hosts may skip mixing it
+  if (silent) {
+    buffer.clear();
+  }
+#elif defined(_ENABLE_MULTITIMBRAL)
+  if (buffer.getNumChannels()
+      >= static_cast<int>(openmini::synthesizer::kMidiChannelsCount)) {
+    parts_.ProcessAudio(buffer.getArrayOfWritePointers(),
+                        buffer.getNumSamples());
+  } else {
+    // Not all output buses are enabled: all parts are summed into the first
+    buffer.clear();
+    parts_.ProcessAudio(buffer.getWritePointer(0), buffer.getNumSamples());
+  }
+  // Flag the buffer as silent so that hosts may skip mixing it
+  if (parts_.IsOutputSilent()) {
+    buffer.clear();
+  }
+#else
   synth_.ProcessAudio(buffer.getArrayOfWritePointers()[0], buffer.getNumSamples());
+  // Flag the buffer as silent so that hosts may skip mixing it
+  if (synth_.IsOutputSilent()) {
+    buffer.clear();
+  }
+#endif  // defined(_ENABLE_RENDER_AHEAD)
 
   process_time_ = juce::Time::getMillisecondCounterHiRes() - counter_start;
 }
@@ -180,10 +339,59 @@ void OpenMiniAudioProcessor::addChangeListener(
 }
 
 void OpenMiniAudioProcessor::triggerNoteOn(const int midi_note) {
-  synth_.NoteOn(midi_note);
+  // Notes not coming from the host (e.g. UI keyboard) are on the first channel
+  triggerNoteOn(1, midi_note);
 }
 void OpenMiniAudioProcessor::triggerNoteOff(const int midi_note) {
+  triggerNoteOff(1, midi_note);
+}
+
+void OpenMiniAudioProcessor::triggerNoteOn(const int midi_channel,
+                                           const int midi_note) {
+#if defined(_ENABLE_MULTITIMBRAL)
+  // MIDI channels are numbered from 1
+  parts_.NoteOn(static_cast<unsigned int>(midi_channel - 1), midi_note);
+#else
+#if defined(_ENABLE_RENDER_AHEAD)
+  if (render_ahead_ != nullptr) {
+    render_ahead_->NoteOn(midi_note);
+    return;
+  }
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+  synth_.NoteOn(midi_note);
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+}
+void OpenMiniAudioProcessor::triggerNoteOff(const int midi_channel,
+                                            const int midi_note) {
+#if defined(_ENABLE_MULTITIMBRAL)
+  parts_.NoteOff(static_cast<unsigned int>(midi_channel - 1), midi_note);
+#else
+#if defined(_ENABLE_RENDER_AHEAD)
+  if (render_ahead_ != nullptr) {
+    render_ahead_->NoteOff(midi_note);
+    return;
+  }
+#endif  // defined(_ENABLE_RENDER_AHEAD)
   synth_.NoteOff(midi_note);
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+}
+
+openmini::synthesizer::Synthesizer& OpenMiniAudioProcessor::ParameterOwner(
+    const int index) {
+#if defined(_ENABLE_MULTITIMBRAL)
+  return parts_.Part(static_cast<unsigned int>(index)
+                     / openmini::synthesizer::Parameters::kCount);
+#else
+  return synth_;
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+}
+
+int OpenMiniAudioProcessor::ParameterId(const int index) const {
+#if defined(_ENABLE_MULTITIMBRAL)
+  return index % openmini::synthesizer::Parameters::kCount;
+#else
+  return index;
+#endif  // defined(_ENABLE_MULTITIMBRAL)
 }
 
 // DEBUG
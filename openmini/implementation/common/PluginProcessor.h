@@ -27,6 +27,15 @@
 
 #include "JuceHeader.h"
 #include "openmini/src/synthesizer/synthesizer.h"
+#if defined(_ENABLE_MULTITIMBRAL)
+#include "openmini/src/synthesizer/multi_timbral.h"
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+#if defined(_ENABLE_RENDER_AHEAD)
+#include "openmini/src/synthesizer/render_ahead.h"
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+#include "openmini/src/synthesizer/worker_pool.h"
+#endif  // defined(_ENABLE_SHARED_POOL)
 
 /// @brief Plugin "processor" class
 ///
@@ -74,6 +83,8 @@ class OpenMiniAudioProcessor  : public juce::AudioProcessor,
   // OpenMini-specifics
   void triggerNoteOn(const int midi_note);
   void triggerNoteOff(const int midi_note);
+  void triggerNoteOn(const int midi_channel, const int midi_note);
+  void triggerNoteOff(const int midi_channel, const int midi_note);
 
   // DEBUG
   double GetLastProcessTime() const;
@@ -84,7 +95,26 @@ class OpenMiniAudioProcessor  : public juce::AudioProcessor,
   int lastUIWidth, lastUIHeight;
 
  private:
+  // Synthesizer owning the given plugin parameter
+  openmini::synthesizer::Synthesizer& ParameterOwner(const int index);
+  // Parameter ID within its owner
+  int ParameterId(const int index) const;
+
+#if defined(_ENABLE_MULTITIMBRAL)
+  // One synthesizer per MIDI channel,
+  // plugin parameters being all parts ones one after the other
+  openmini::synthesizer::MultiTimbral parts_;
+#else
   openmini::synthesizer::Synthesizer synth_;
+#endif  // defined(_ENABLE_MULTITIMBRAL)
+#if defined(_ENABLE_RENDER_AHEAD)
+  // Renders synth_ on a worker thread, once prepared
+  juce::ScopedPointer<openmini::synthesizer::RenderAhead> render_ahead_;
+#endif  // defined(_ENABLE_RENDER_AHEAD)
+#if defined(_ENABLE_SHARED_POOL)
+  // Renders synth_ through the process-wide pool, once prepared
+  juce::ScopedPointer<openmini::synthesizer::PooledRenderer> pooled_renderer_;
+#endif  // defined(_ENABLE_SHARED_POOL)
   double process_time_;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OpenMiniAudioProcessor)
@@ -99,6 +99,25 @@ enum Type {
 };
 }  // namespace Waveform
 
+/// @brief Allowed noise colors
+namespace NoiseColor {
+enum Type {
+  kWhite = 0,
+  kPink,
+  kCount
+};
+}  // namespace NoiseColor
+
+/// @brief Allowed oscillators engines, i.e. generators families
+namespace OscillatorEngine {
+enum Type {
+  kDPW = 0,
+  kPolyBlep,
+  kWavetable,
+  kCount
+};
+}  // namespace OscillatorEngine
+
 /// @brief Allocation function wrapper
 ///
 /// Allow aligned memory allocation
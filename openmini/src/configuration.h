@@ -59,11 +59,11 @@
 
 /// @brief Architecture detection - compiler specific preprocessor macros
 #if _COMPILER_MSVC
-  #if defined(_M_IX86)
+  #if (defined(_M_IX86) || defined(_M_X64))
     #define _ARCH_X86 1
   #endif
 #elif _COMPILER_GCC
-  #if (defined(__i386__))
+  #if (defined(__i386__) || defined(__x86_64__))
     #define _ARCH_X86 1
   #endif
 #endif
@@ -0,0 +1,75 @@
+/// @filename arena.cc
+/// @brief Per-instance memory arena - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/arena.h"
+
+// uintptr_t
+#include <cstdint>
+
+namespace openmini {
+namespace synthesizer {
+
+Arena::Arena(const size_t capacity)
+    // The allocation is only aligned on the Sample size:
+    // one more cache line leaves room for aligning it
+    : memory_(::openmini::Allocate(capacity + kCacheLineSize)),
+      begin_(nullptr),
+      capacity_(capacity),
+      used_(0) {
+  OPENMINI_ASSERT(memory_ != nullptr);
+  OPENMINI_ASSERT(IsMultipleOf(static_cast<unsigned int>(capacity),
+                               kCacheLineSize));
+  const uintptr_t address(reinterpret_cast<uintptr_t>(memory_));
+  begin_ = static_cast<char*>(memory_)
+           + (kCacheLineSize - address % kCacheLineSize) % kCacheLineSize;
+}
+
+Arena::~Arena() {
+  Deallocate(memory_);
+  memory_ = nullptr;
+}
+
+void* Arena::Allocate(const size_t size) {
+  const size_t aligned_size(AlignedSize(size));
+  OPENMINI_ASSERT(used_ + aligned_size <= capacity_);
+  void* block(&begin_[used_]);
+  used_ += aligned_size;
+  return block;
+}
+
+size_t Arena::Capacity(void) const {
+  return capacity_;
+}
+
+size_t Arena::Used(void) const {
+  return used_;
+}
+
+bool Arena::Contains(const void* const memory) const {
+  const char* const address(static_cast<const char*>(memory));
+  return (address >= begin_) && (address < &begin_[capacity_]);
+}
+
+size_t Arena::AlignedSize(const size_t size) {
+  return GetNextMultiple(static_cast<unsigned int>(size), kCacheLineSize);
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
@@ -0,0 +1,89 @@
+/// @filename arena.h
+/// @brief Per-instance memory arena
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_ARENA_H_
+#define OPENMINI_SRC_SYNTHESIZER_ARENA_H_
+
+#include "openmini/src/common.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Per-instance memory arena
+///
+/// The whole arena is allocated at once on construction, then handed out
+/// by cache line aligned blocks, in the order they are requested:
+/// requesting them in processing order keeps all of an instance data
+/// contiguous.
+///
+/// Nothing is ever freed before the arena itself is destroyed,
+/// and destroying objects placed into it is up to their owner.
+/// Running out of space asserts - there are no return values nor exceptions.
+class Arena {
+ public:
+  /// @brief Default constructor: allocates the whole arena
+  ///
+  /// @param[in]  capacity    Arena size in bytes, @see AlignedSize()
+  explicit Arena(const size_t capacity);
+  ~Arena();
+
+  /// @brief Retrieve a cache line aligned block from the arena
+  ///
+  /// @param[in]  size    Block size in bytes
+  void* Allocate(const size_t size);
+
+  /// @brief Syntactic nicety of the one above
+  ///
+  /// @param[in]  count   Count of elements of the given type
+  template <typename TypeValue>
+  TypeValue* Allocate(const unsigned int count = 1) {
+    return static_cast<TypeValue*>(Allocate(count * sizeof(TypeValue)));
+  }
+
+  /// @brief Arena size in bytes
+  size_t Capacity(void) const;
+
+  /// @brief Bytes already handed out
+  size_t Used(void) const;
+
+  /// @brief Check if the given memory belongs to the arena
+  bool Contains(const void* const memory) const;
+
+  /// @brief Arena room actually taken by a block of the given size
+  ///
+  /// @param[in]  size    Block size in bytes
+  static size_t AlignedSize(const size_t size);
+
+ private:
+  // No copy nor assignment operator for this class
+  Arena(const Arena& right);
+  Arena& operator=(const Arena& right);
+
+  void* memory_;  ///< Actual allocation
+  char* begin_;  ///< Cache line aligned beginning of the arena
+  const size_t capacity_;  ///< Arena size in bytes
+  size_t used_;  ///< Bytes already handed out
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_ARENA_H_
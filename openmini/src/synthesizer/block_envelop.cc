@@ -0,0 +1,228 @@
+/// @filename block_envelop.cc
+/// @brief Envelop generator rendering whole blocks at once - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/block_envelop.h"
+
+// std::fill_n, std::min
+#include <algorithm>
+// std::pow
+#include <cmath>
+// std::numeric_limits
+#include <limits>
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Part of their range exponential ramps go down to (-60dB)
+static const float kExponentialFloor(1e-3f);
+
+BlockEnvelop::BlockEnvelop()
+    : state_() {
+  state_.remainder = 1.0f;
+  state_.segment = EnvelopSegment::kIdle;
+  state_.curve = EnvelopCurve::kLinear;
+}
+
+void BlockEnvelop::SetParameters(const unsigned int attack,
+                                 const unsigned int decay,
+                                 const unsigned int release,
+                                 const float sustain_level) {
+  OPENMINI_ASSERT(sustain_level <= 1.0f);
+  OPENMINI_ASSERT(sustain_level >= 0.0f);
+
+  state_.durations[EnvelopSegment::kAttack] = attack;
+  state_.durations[EnvelopSegment::kDecay] = decay;
+  state_.durations[EnvelopSegment::kRelease] = release;
+  state_.sustain_level = sustain_level;
+  UpdateRatio(EnvelopSegment::kAttack);
+  UpdateRatio(EnvelopSegment::kDecay);
+  UpdateRatio(EnvelopSegment::kRelease);
+}
+
+void BlockEnvelop::SetCurve(const EnvelopCurve::Type curve) {
+  OPENMINI_ASSERT(curve < EnvelopCurve::kCount);
+  state_.curve = curve;
+}
+
+void BlockEnvelop::TriggerOn(void) {
+  Enter(EnvelopSegment::kAttack);
+}
+
+void BlockEnvelop::TriggerOff(void) {
+  Enter(EnvelopSegment::kRelease);
+}
+
+void BlockEnvelop::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  // Each iteration either fills the whole remaining buffer,
+  // or ends the current segment
+  unsigned int processed(0);
+  while (processed < length) {
+    float* const remaining(&output[processed]);
+    const unsigned int remaining_length(length - processed);
+    switch (state_.segment) {
+      case EnvelopSegment::kAttack:
+        processed += Ramp(remaining, remaining_length, 1.0f);
+        break;
+      case EnvelopSegment::kDecay:
+        processed += Ramp(remaining, remaining_length, state_.sustain_level);
+        break;
+      case EnvelopSegment::kRelease:
+        processed += Ramp(remaining, remaining_length, 0.0f);
+        break;
+      case EnvelopSegment::kSustain:
+        state_.value = state_.sustain_level;
+        std::fill_n(remaining, remaining_length, state_.value);
+        processed = length;
+        break;
+      default:
+        OPENMINI_ASSERT(state_.segment == EnvelopSegment::kIdle);
+        state_.value = 0.0f;
+        std::fill_n(remaining, remaining_length, state_.value);
+        processed = length;
+        break;
+    }
+  }
+}
+
+Sample BlockEnvelop::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+bool BlockEnvelop::IsIdle(void) const {
+  return state_.segment == EnvelopSegment::kIdle;
+}
+
+unsigned int BlockEnvelop::ActiveLength(void) const {
+  if (EnvelopSegment::kIdle == state_.segment) {
+    return 0;
+  }
+  if (EnvelopSegment::kRelease == state_.segment) {
+    // Durations may have been shortened in the meantime
+    const unsigned int duration(state_.durations[EnvelopSegment::kRelease]);
+    return duration - std::min(state_.cursor, duration);
+  }
+  return std::numeric_limits<unsigned int>::max();
+}
+
+void BlockEnvelop::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  *state = state_;
+}
+
+void BlockEnvelop::Restore(const State& state) {
+  state_ = state;
+}
+
+unsigned int BlockEnvelop::Ramp(float* const output,
+                                const unsigned int length,
+                                const float target) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  const unsigned int duration(state_.durations[state_.segment]);
+  // Durations may have been shortened in the meantime
+  const unsigned int count(
+    std::min(length, duration - std::min(state_.cursor, duration)));
+  if (count > 0) {
+    unsigned int i(0);
+    if (state_.curve == EnvelopCurve::kLinear) {
+      // Sample n of the ramp (starting at 1) is origin + n * slope
+      const float slope((target - state_.origin)
+                        / static_cast<float>(duration));
+      const float first(static_cast<float>(state_.cursor + 1));
+#if (_USE_SSE)
+      const __m128 origin(_mm_set1_ps(state_.origin));
+      const __m128 slopes(_mm_set1_ps(slope));
+      const __m128 step(_mm_set1_ps(4.0f));
+      __m128 indexes(_mm_add_ps(_mm_set1_ps(first),
+                                _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)));
+      for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(&output[i],
+                      _mm_add_ps(origin, _mm_mul_ps(slopes, indexes)));
+        indexes = _mm_add_ps(indexes, step);
+      }
+#endif  // (_USE_SSE)
+      for (; i < count; ++i) {
+        output[i] = state_.origin + slope * (first + static_cast<float>(i));
+      }
+    } else {
+      // Sample n of the ramp is target + (origin - target) * ratio^n:
+      // only the remaining part of the range is updated by the recurrence
+      const float range(state_.origin - target);
+      const float ratio(state_.ratios[state_.segment]);
+#if (_USE_SSE)
+      const float ratio_2(ratio * ratio);
+      const __m128 targets(_mm_set1_ps(target));
+      const __m128 ranges(_mm_set1_ps(range));
+      const __m128 step(_mm_set1_ps(ratio_2 * ratio_2));
+      __m128 remainders(_mm_mul_ps(
+        _mm_set1_ps(state_.remainder),
+        _mm_setr_ps(ratio, ratio_2, ratio_2 * ratio, ratio_2 * ratio_2)));
+      for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(&output[i],
+                      _mm_add_ps(targets, _mm_mul_ps(ranges, remainders)));
+        state_.remainder = _mm_cvtss_f32(
+          _mm_shuffle_ps(remainders, remainders, _MM_SHUFFLE(3, 3, 3, 3)));
+        remainders = _mm_mul_ps(remainders, step);
+      }
+#endif  // (_USE_SSE)
+      for (; i < count; ++i) {
+        state_.remainder *= ratio;
+        output[i] = target + range * state_.remainder;
+      }
+    }
+    state_.cursor += count;
+    state_.value = output[count - 1];
+  }
+  if (state_.cursor >= duration) {
+    // Rounding errors are not carried over to the next segment
+    if (count > 0) {
+      output[count - 1] = target;
+    }
+    state_.value = target;
+    Enter(static_cast<EnvelopSegment::Type>(state_.segment + 1));
+  }
+  return count;
+}
+
+void BlockEnvelop::Enter(const EnvelopSegment::Type segment) {
+  OPENMINI_ASSERT(segment < EnvelopSegment::kCount);
+  state_.segment = segment;
+  state_.origin = state_.value;
+  state_.remainder = 1.0f;
+  state_.cursor = 0;
+}
+
+void BlockEnvelop::UpdateRatio(const EnvelopSegment::Type segment) {
+  const unsigned int duration(state_.durations[segment]);
+  state_.ratios[segment] = (duration > 0)
+    ? std::pow(kExponentialFloor, 1.0f / static_cast<float>(duration))
+    : 0.0f;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
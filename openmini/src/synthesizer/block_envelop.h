@@ -0,0 +1,174 @@
+/// @filename block_envelop.h
+/// @brief Envelop generator rendering whole blocks at once
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_BLOCK_ENVELOP_H_
+#define OPENMINI_SRC_SYNTHESIZER_BLOCK_ENVELOP_H_
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Envelop segments, in their chronological order
+namespace EnvelopSegment {
+enum Type {
+  kAttack = 0,
+  kDecay,
+  kSustain,
+  kRelease,
+  kIdle,
+  kCount
+};
+}  // namespace EnvelopSegment
+
+/// @brief Envelop ramps shapes
+namespace EnvelopCurve {
+enum Type {
+  kLinear = 0,
+  kExponential,
+  kCount
+};
+}  // namespace EnvelopCurve
+
+/// @brief Attack - decay - sustain - release envelop generator,
+/// rendering whole blocks at once
+///
+/// Each ramp is computed in closed form from the count of samples elapsed
+/// since its beginning: a whole block is filled with the remaining part of
+/// the current segment in one pass, segments transitions being handled
+/// only once per block instead of on each sample.
+///
+/// With linear ramps, it behaves as SoundTailor Adsd.
+/// Exponential ramps go down to a fixed ratio of their range
+/// (-60dB) before snapping to their target.
+class BlockEnvelop {
+ public:
+  /// @brief Whole envelop state, trivially copyable
+  struct State {
+    float value;  ///< Last output value
+    float origin;  ///< Current segment start value
+    float remainder;  ///< Exponential ramps remaining part of their range
+    unsigned int cursor;  ///< Samples elapsed since the segment beginning
+    /// @brief Segments durations, in samples (only the ramps ones are used)
+    unsigned int durations[EnvelopSegment::kCount];
+    /// @brief Exponential ramps ratio from one sample to the next one
+    float ratios[EnvelopSegment::kCount];
+    float sustain_level;  ///< Level when sustaining
+    EnvelopSegment::Type segment;  ///< Current segment
+    EnvelopCurve::Type curve;  ///< Ramps shape
+  };
+
+  /// @brief Default constructor
+  ///
+  /// The envelop is idle, all times being null
+  BlockEnvelop();
+
+  /// @brief Set all envelop parameters at once
+  ///
+  /// Times are not normalized here - the unit is "samples"
+  ///
+  /// @param[in]  attack          Attack time
+  /// @param[in]  decay           Decay time
+  /// @param[in]  release         Release time
+  /// @param[in]  sustain_level   Level when sustaining, within [0.0f ; 1.0f]
+  void SetParameters(const unsigned int attack,
+                     const unsigned int decay,
+                     const unsigned int release,
+                     const float sustain_level);
+
+  /// @brief Set the ramps shape
+  ///
+  /// @param[in]  curve   Shape of all ramps
+  void SetCurve(const EnvelopCurve::Type curve);
+
+  /// @brief Event for triggering the beginning of the envelop
+  ///
+  /// The attack starts from the current value:
+  /// repeated calls to this function will lead to accumulated envelops.
+  void TriggerOn(void);
+
+  /// @brief Event for triggering the end of the envelop
+  ///
+  /// The release starts from the current value
+  void TriggerOff(void);
+
+  /// @brief Process function for one buffer
+  ///
+  /// @param[out] output    Envelop values
+  /// @param[in]  length    Buffer length
+  void Process(float* const output, const unsigned int length);
+
+  /// @brief Process function for one Sample
+  ///
+  /// @return the envelop values
+  Sample operator()(void);
+
+  /// @brief Check if the envelop is idle, i.e. fully released:
+  /// the output is then only zeros until the next trigger
+  bool IsIdle(void) const;
+
+  /// @brief Samples left before the envelop is idle,
+  /// if it is not triggered in between
+  ///
+  /// @return zero if already idle, the max unsigned int value
+  /// if not released yet
+  unsigned int ActiveLength(void) const;
+
+  /// @brief Capture the whole envelop state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+ private:
+  // No copy nor assignment operator for this class
+  BlockEnvelop(const BlockEnvelop& right);
+  BlockEnvelop& operator=(const BlockEnvelop& right);
+
+  /// @brief Fill the given buffer with the current ramp remaining part
+  ///
+  /// @param[out] output    Buffer to fill
+  /// @param[in]  length    Buffer length
+  /// @param[in]  target    Value reached at the end of the ramp
+  ///
+  /// @return the count of samples actually written, the ramp ending
+  /// if less than length
+  unsigned int Ramp(float* const output,
+                    const unsigned int length,
+                    const float target);
+
+  /// @brief Start the given segment from the current value
+  void Enter(const EnvelopSegment::Type segment);
+
+  /// @brief Update the given segment exponential ratio from its duration
+  void UpdateRatio(const EnvelopSegment::Type segment);
+
+  State state_;  ///< Everything, laid out for the processing kernel
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_BLOCK_ENVELOP_H_
@@ -0,0 +1,82 @@
+/// @filename denormals.cc
+/// @brief Denormals flushing and detection - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/denormals.h"
+
+// uint32_t
+#include <cstdint>
+// std::memcpy
+#include <cstring>
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+#if (_USE_SSE)
+/// @brief MXCSR "flush to zero" bit
+static const unsigned int kFlushToZeroMode(0x8000);
+/// @brief MXCSR "denormals are zero" bit
+static const unsigned int kDenormalsAreZeroMode(0x0040);
+#endif  // (_USE_SSE)
+
+/// @brief Float exponent bits
+static const uint32_t kExponentMask(0x7F800000);
+/// @brief Float mantissa bits
+static const uint32_t kMantissaMask(0x007FFFFF);
+
+FlushDenormals::FlushDenormals()
+    : previous_mode_(0) {
+#if (_USE_SSE)
+  previous_mode_ = _mm_getcsr();
+  _mm_setcsr(previous_mode_ | kFlushToZeroMode | kDenormalsAreZeroMode);
+#endif  // (_USE_SSE)
+}
+
+FlushDenormals::~FlushDenormals() {
+#if (_USE_SSE)
+  _mm_setcsr(previous_mode_);
+#endif  // (_USE_SSE)
+}
+
+bool IsDenormal(const float value) {
+  // Classified from the bit pattern: floating point classification
+  // is not reliable with "fast math" optimizations
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return ((bits & kExponentMask) == 0) && ((bits & kMantissaMask) != 0);
+}
+
+unsigned int CountDenormals(const float* const values,
+                            const unsigned int length) {
+  OPENMINI_ASSERT(values != nullptr);
+  unsigned int count(0);
+  for (unsigned int i(0); i < length; ++i) {
+    if (IsDenormal(values[i])) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
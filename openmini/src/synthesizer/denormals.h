@@ -0,0 +1,64 @@
+/// @filename denormals.h
+/// @brief Denormals flushing and detection
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_DENORMALS_H_
+#define OPENMINI_SRC_SYNTHESIZER_DENORMALS_H_
+
+#include "openmini/src/common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Flush denormals to zero for the lifetime of the object
+///
+/// Decaying recursive states (filters memory, envelops tails) eventually
+/// reach the denormal range, where each operation may be 10 - 100 times
+/// slower on x86: both "flush to zero" (FTZ) and "denormals are zero" (DAZ)
+/// modes are set on construction, the caller ones being restored
+/// on destruction.
+///
+/// Without SSE support it does nothing.
+class FlushDenormals {
+ public:
+  FlushDenormals();
+  ~FlushDenormals();
+
+ private:
+  // No copy nor assignment operator for this class
+  FlushDenormals(const FlushDenormals& right);
+  FlushDenormals& operator=(const FlushDenormals& right);
+
+  unsigned int previous_mode_;  ///< Caller floating point control register
+};
+
+/// @brief Check if the given value is denormal (subnormal)
+bool IsDenormal(const float value);
+
+/// @brief Count denormal values in the given buffer
+///
+/// @param[in]  values    Values to check
+/// @param[in]  length    Buffer length
+unsigned int CountDenormals(const float* const values,
+                            const unsigned int length);
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_DENORMALS_H_
@@ -0,0 +1,388 @@
+/// @filename dual_ladder.cc
+/// @brief Dual-lane ladder filter - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/dual_ladder.h"
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Highest allowed normalized frequency
+static const float kLadderMaxFrequency(0.5f);
+/// @brief Highest normalized frequency actually applied, below Nyquist
+static const float kLadderMaxAppliedFrequency(0.49f);
+/// @brief Highest allowed resonance, the self-oscillating one
+static const float kLadderMaxResonance(4.0f);
+/// @brief Saturation input bound, beyond which its output is flat
+static const float kSaturationBound(3.0f);
+
+#if (_USE_SSE)
+
+/// @brief Rational tanh approximation, exactly +-1 on bounds
+static inline __m128 Saturate(const __m128 input) {
+  const __m128 bound(_mm_set1_ps(kSaturationBound));
+  const __m128 x(_mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), bound),
+                            _mm_min_ps(bound, input)));
+  const __m128 x2(_mm_mul_ps(x, x));
+  const __m128 numerator(_mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(27.0f), x2)));
+  const __m128 denominator(_mm_add_ps(_mm_set1_ps(27.0f),
+                                      _mm_mul_ps(_mm_set1_ps(9.0f), x2)));
+  return _mm_div_ps(numerator, denominator);
+}
+
+/// @brief Ladder coefficients, by lane
+struct Coefficients {
+  __m128 gain;  ///< One pole gain G = g / (1 + g)
+  __m128 feedback;  ///< Compensated resonance feedback
+  __m128 normalization;  ///< Feedback loop solving factor 1 / (1 + k.G^4)
+};
+
+/// @brief Compute all lanes coefficients from their frequencies
+static inline Coefficients ComputeCoefficients(const __m128 frequencies,
+                                               const float resonance,
+                                               const unsigned int ratio) {
+  // Prewarping, through a [5/4] Pade approximation of tan(x)
+  const __m128 x(_mm_mul_ps(
+    _mm_set1_ps(static_cast<float>(Pi) / static_cast<float>(ratio)),
+    _mm_min_ps(_mm_set1_ps(kLadderMaxAppliedFrequency), frequencies)));
+  const __m128 x2(_mm_mul_ps(x, x));
+  const __m128 x4(_mm_mul_ps(x2, x2));
+  const __m128 numerator(_mm_mul_ps(x, _mm_add_ps(
+    _mm_sub_ps(_mm_set1_ps(945.0f), _mm_mul_ps(_mm_set1_ps(105.0f), x2)),
+    x4)));
+  const __m128 denominator(_mm_add_ps(
+    _mm_sub_ps(_mm_set1_ps(945.0f), _mm_mul_ps(_mm_set1_ps(420.0f), x2)),
+    _mm_mul_ps(_mm_set1_ps(15.0f), x4)));
+  const __m128 g(_mm_div_ps(numerator, denominator));
+  Coefficients coefficients;
+  coefficients.gain = _mm_div_ps(g, _mm_add_ps(_mm_set1_ps(1.0f), g));
+  // Otherwise the ladder would ring around Nyquist at its highest frequency
+  coefficients.feedback = _mm_mul_ps(
+    _mm_set1_ps(resonance),
+    _mm_sub_ps(_mm_set1_ps(1.0f),
+               _mm_mul_ps(_mm_set1_ps(1.0f / kLadderMaxFrequency),
+                          frequencies)));
+  const __m128 gain2(_mm_mul_ps(coefficients.gain, coefficients.gain));
+  coefficients.normalization = _mm_div_ps(
+    _mm_set1_ps(1.0f),
+    _mm_add_ps(_mm_set1_ps(1.0f),
+               _mm_mul_ps(coefficients.feedback, _mm_mul_ps(gain2, gain2))));
+  return coefficients;
+}
+
+#endif  // (_USE_SSE)
+
+/// @brief Rational tanh approximation, exactly +-1 on bounds
+static inline float Saturate(const float input) {
+  const float x(Math::Max(-kSaturationBound,
+                          Math::Min(kSaturationBound, input)));
+  const float x2(x * x);
+  return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+}
+
+/// @brief Ladder coefficients, by lane, for lanes computed one by one
+struct LanesCoefficients {
+  float gain[LadderLane::kCount];  ///< One pole gain G = g / (1 + g)
+  float feedback[LadderLane::kCount];  ///< Compensated resonance feedback
+  float normalization[LadderLane::kCount];  ///< Feedback loop solving
+                                            ///< factor 1 / (1 + k.G^4)
+};
+
+/// @brief Compute the given lane coefficients from its frequency
+static inline void ComputeCoefficients(const unsigned int lane,
+                                       const float frequency,
+                                       const float resonance,
+                                       const unsigned int ratio,
+                                       LanesCoefficients* coefficients) {
+  // Prewarping, through a [5/4] Pade approximation of tan(x)
+  const float x(static_cast<float>(Pi)
+                * Math::Min(kLadderMaxAppliedFrequency, frequency)
+                / static_cast<float>(ratio));
+  const float x2(x * x);
+  const float x4(x2 * x2);
+  const float g(x * (945.0f - 105.0f * x2 + x4)
+                / (945.0f - 420.0f * x2 + 15.0f * x4));
+  const float gain(g / (1.0f + g));
+  // Otherwise the ladder would ring around Nyquist at its highest frequency
+  const float feedback(resonance * (1.0f - frequency / kLadderMaxFrequency));
+  coefficients->gain[lane] = gain;
+  coefficients->feedback[lane] = feedback;
+  coefficients->normalization[lane]
+    = 1.0f / (1.0f + feedback * gain * gain * gain * gain);
+}
+
+DualLadder::DualLadder(const unsigned int oversampling)
+    : state_() {
+  SetFrequency(LadderLane::kDry, kLadderMaxFrequency);
+  SetFrequency(LadderLane::kWet, kLadderMaxFrequency);
+  SetOversampling(oversampling);
+}
+
+void DualLadder::SetFrequency(const LadderLane::Type lane,
+                              const float frequency) {
+  OPENMINI_ASSERT(lane < LadderLane::kCount);
+  OPENMINI_ASSERT(frequency >= 0.0f);
+  OPENMINI_ASSERT(frequency <= kLadderMaxFrequency);
+
+  state_.frequencies[lane] = frequency;
+}
+
+void DualLadder::SetResonance(const float resonance) {
+  OPENMINI_ASSERT(resonance >= 0.0f);
+  OPENMINI_ASSERT(resonance <= kLadderMaxResonance);
+
+  state_.resonance = resonance;
+}
+
+void DualLadder::SetOversampling(const unsigned int oversampling) {
+  OPENMINI_ASSERT((oversampling == 1)
+                  || (oversampling == 2)
+                  || (oversampling == kLadderMaxOversampling));
+
+  state_.oversampling = oversampling;
+}
+
+void DualLadder::Process(const float* const input,
+                         const float* const wet_frequencies,
+                         const float dry_gain,
+                         const float wet_gain,
+                         float* const output,
+                         const unsigned int length) {
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+
+#if (_USE_SSE)
+  // Both lanes are run together, one per SIMD lane, if both are used:
+  // otherwise the only used one is run alone
+  if ((dry_gain != 0.0f) && (wet_gain != 0.0f)) {
+    ProcessPacked(input, wet_frequencies, dry_gain, wet_gain, output, length);
+    return;
+  }
+#endif  // (_USE_SSE)
+  ProcessLanes(input, wet_frequencies, dry_gain, wet_gain, output, length);
+}
+
+#if (_USE_SSE)
+void DualLadder::ProcessPacked(const float* const input,
+                               const float* const wet_frequencies,
+                               const float dry_gain,
+                               const float wet_gain,
+                               float* const output,
+                               const unsigned int length) {
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+
+  const unsigned int ratio(state_.oversampling);
+  // Decimation is a plain average of all oversampled outputs
+  const float decimation(1.0f / static_cast<float>(ratio));
+
+  // Coefficients are only recomputed when the wet frequency changes
+  float wet_frequency(state_.frequencies[LadderLane::kWet]);
+  __m128 frequencies(_mm_load_ps(&state_.frequencies[0]));
+  Coefficients coefficients(ComputeCoefficients(frequencies,
+                                                state_.resonance,
+                                                ratio));
+  const __m128 gains(_mm_setr_ps(decimation * dry_gain,
+                                 decimation * wet_gain,
+                                 0.0f,
+                                 0.0f));
+  __m128 stage0(_mm_load_ps(&state_.stages[0][0]));
+  __m128 stage1(_mm_load_ps(&state_.stages[1][0]));
+  __m128 stage2(_mm_load_ps(&state_.stages[2][0]));
+  __m128 stage3(_mm_load_ps(&state_.stages[3][0]));
+  for (unsigned int i(0); i < length; ++i) {
+    if ((wet_frequencies != nullptr) && (wet_frequencies[i] != wet_frequency)) {
+      OPENMINI_ASSERT(wet_frequencies[i] >= 0.0f);
+      OPENMINI_ASSERT(wet_frequencies[i] <= kLadderMaxFrequency);
+      wet_frequency = wet_frequencies[i];
+      frequencies = _mm_setr_ps(state_.frequencies[LadderLane::kDry],
+                                wet_frequency,
+                                0.0f,
+                                0.0f);
+      coefficients = ComputeCoefficients(frequencies,
+                                         state_.resonance,
+                                         ratio);
+    }
+    const __m128 gain(coefficients.gain);
+    const __m128 complement(_mm_sub_ps(_mm_set1_ps(1.0f), gain));
+    const __m128 gain2(_mm_mul_ps(gain, gain));
+    const __m128 gain4(_mm_mul_ps(gain2, gain2));
+    const __m128 current(_mm_set1_ps(input[i]));
+    __m128 accumulated(_mm_setzero_ps());
+    for (unsigned int step(0); step < ratio; ++step) {
+      // Ladder output estimation, its feedback loop being solved
+      __m128 sum(_mm_mul_ps(complement, stage0));
+      sum = _mm_add_ps(_mm_mul_ps(sum, gain),
+                       _mm_mul_ps(complement, stage1));
+      sum = _mm_add_ps(_mm_mul_ps(sum, gain),
+                       _mm_mul_ps(complement, stage2));
+      sum = _mm_add_ps(_mm_mul_ps(sum, gain),
+                       _mm_mul_ps(complement, stage3));
+      const __m128 estimated(_mm_mul_ps(
+        coefficients.normalization,
+        _mm_add_ps(_mm_mul_ps(gain4, current), sum)));
+      __m128 stage_output(Saturate(_mm_sub_ps(
+        current,
+        _mm_mul_ps(coefficients.feedback, estimated))));
+      // Trapezoidal integrators
+      __m128 delta(_mm_mul_ps(gain, _mm_sub_ps(stage_output, stage0)));
+      stage_output = _mm_add_ps(delta, stage0);
+      stage0 = _mm_add_ps(stage_output, delta);
+      delta = _mm_mul_ps(gain, _mm_sub_ps(stage_output, stage1));
+      stage_output = _mm_add_ps(delta, stage1);
+      stage1 = _mm_add_ps(stage_output, delta);
+      delta = _mm_mul_ps(gain, _mm_sub_ps(stage_output, stage2));
+      stage_output = _mm_add_ps(delta, stage2);
+      stage2 = _mm_add_ps(stage_output, delta);
+      delta = _mm_mul_ps(gain, _mm_sub_ps(stage_output, stage3));
+      stage_output = _mm_add_ps(delta, stage3);
+      stage3 = _mm_add_ps(stage_output, delta);
+      accumulated = _mm_add_ps(accumulated, stage_output);
+    }
+    // Dry and wet lanes mix
+    const __m128 weighted(_mm_mul_ps(gains, accumulated));
+    output[i] = _mm_cvtss_f32(
+      _mm_add_ss(weighted, _mm_shuffle_ps(weighted, weighted,
+                                          _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  _mm_store_ps(&state_.stages[0][0], stage0);
+  _mm_store_ps(&state_.stages[1][0], stage1);
+  _mm_store_ps(&state_.stages[2][0], stage2);
+  _mm_store_ps(&state_.stages[3][0], stage3);
+
+
+  state_.frequencies[LadderLane::kWet] = wet_frequency;
+}
+#endif  // (_USE_SSE)
+
+void DualLadder::ProcessLanes(const float* const input,
+                              const float* const wet_frequencies,
+                              const float dry_gain,
+                              const float wet_gain,
+                              float* const output,
+                              const unsigned int length) {
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+
+  const unsigned int ratio(state_.oversampling);
+  // Decimation is a plain average of all oversampled outputs
+  const float decimation(1.0f / static_cast<float>(ratio));
+
+  // Coefficients are only recomputed when the wet frequency changes
+  float wet_frequency(state_.frequencies[LadderLane::kWet]);
+  LanesCoefficients coefficients;
+  for (unsigned int lane(0); lane < LadderLane::kCount; ++lane) {
+    ComputeCoefficients(lane,
+                        state_.frequencies[lane],
+                        state_.resonance,
+                        ratio,
+                        &coefficients);
+  }
+  const float gains[LadderLane::kCount] = {decimation * dry_gain,
+                                           decimation * wet_gain};
+  // Lanes are computed one after the other here:
+  // a lane whose output is multiplied by zero is skipped
+  const bool active[LadderLane::kCount] = {
+    (dry_gain != 0.0f) || (wet_gain == 0.0f),
+    wet_gain != 0.0f
+  };
+  for (unsigned int i(0); i < length; ++i) {
+    if ((wet_frequencies != nullptr) && (wet_frequencies[i] != wet_frequency)) {
+      OPENMINI_ASSERT(wet_frequencies[i] >= 0.0f);
+      OPENMINI_ASSERT(wet_frequencies[i] <= kLadderMaxFrequency);
+      wet_frequency = wet_frequencies[i];
+      ComputeCoefficients(LadderLane::kWet,
+                          wet_frequency,
+                          state_.resonance,
+                          ratio,
+                          &coefficients);
+    }
+    float mixed(0.0f);
+    for (unsigned int lane(0); lane < LadderLane::kCount; ++lane) {
+      if (!active[lane]) {
+        continue;
+      }
+      const float gain(coefficients.gain[lane]);
+      const float complement(1.0f - gain);
+      const float gain4(gain * gain * gain * gain);
+      float* const stages[kLadderStagesCount] = {&state_.stages[0][lane],
+                                                 &state_.stages[1][lane],
+                                                 &state_.stages[2][lane],
+                                                 &state_.stages[3][lane]};
+      float accumulated(0.0f);
+      for (unsigned int step(0); step < ratio; ++step) {
+        // Ladder output estimation, its feedback loop being solved
+        float sum(0.0f);
+        for (unsigned int stage(0); stage < kLadderStagesCount; ++stage) {
+          sum = sum * gain + complement * *stages[stage];
+        }
+        const float estimated(coefficients.normalization[lane]
+                              * (gain4 * input[i] + sum));
+        float stage_output(Saturate(input[i]
+                                    - coefficients.feedback[lane] * estimated));
+        // Trapezoidal integrators
+        for (unsigned int stage(0); stage < kLadderStagesCount; ++stage) {
+          const float delta(gain * (stage_output - *stages[stage]));
+          stage_output = delta + *stages[stage];
+          *stages[stage] = stage_output + delta;
+        }
+        accumulated += stage_output;
+      }
+      mixed += gains[lane] * accumulated;
+    }
+    output[i] = mixed;
+  }
+  // The skipped lane takes over the computed one state, so that switching
+  // over to it does not click
+  if (active[LadderLane::kDry] != active[LadderLane::kWet]) {
+    const unsigned int computed(active[LadderLane::kDry] ? LadderLane::kDry
+                                                         : LadderLane::kWet);
+    const unsigned int skipped(LadderLane::kCount - 1 - computed);
+    for (unsigned int stage(0); stage < kLadderStagesCount; ++stage) {
+      state_.stages[stage][skipped] = state_.stages[stage][computed];
+    }
+  }
+
+  state_.frequencies[LadderLane::kWet] = wet_frequency;
+}
+
+Sample DualLadder::operator()(SampleRead input,
+                              const float dry_gain,
+                              const float wet_gain) {
+  alignas(16) float samples[SampleSize];
+  VectorMath::Store(&samples[0], input);
+  Process(&samples[0], nullptr, dry_gain, wet_gain, &samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void DualLadder::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  *state = state_;
+}
+
+void DualLadder::Restore(const State& state) {
+  state_ = state;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
@@ -0,0 +1,168 @@
+/// @filename dual_ladder.h
+/// @brief Dual-lane ladder filter: dry and wet filters run together
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_DUAL_LADDER_H_
+#define OPENMINI_SRC_SYNTHESIZER_DUAL_LADDER_H_
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Ladder poles count
+static const unsigned int kLadderStagesCount(4);
+/// @brief Ladder lanes count: dry and wet ones, padded to a SIMD register
+static const unsigned int kLadderLanesCount(4);
+/// @brief Highest allowed oversampling ratio
+static const unsigned int kLadderMaxOversampling(4);
+
+// (Using the "enum in its own namespace" trick)
+/// @brief Ladder lanes actually used
+namespace LadderLane {
+enum Type {
+  kDry = 0,
+  kWet,
+  kCount
+};
+}  // namespace LadderLane
+
+/// @brief Dual-lane zero-delay feedback ladder filter
+///
+/// Two ladders sharing the same input and resonance, each one with its own
+/// frequency, are run together - one per SIMD lane - and directly output
+/// their mix: the dry/wet pair costs about as much as one single filter.
+/// A lane whose output gain is zero is skipped, the other one being then
+/// computed alone (as both lanes are without SIMD); the skipped lane takes
+/// over the computed one state, so that switching over to it does not click.
+///
+/// Each ladder is a cascade of 4 trapezoidal one pole filters, its feedback
+/// loop being solved without any delay, then saturated.
+/// It is oversampled 1x, 2x or 4x.
+/// Parameters ranges are SoundTailor Moog filters ones:
+/// normalized frequency within [0.0f ; 0.5f], resonance within [0.0f ; 4.0f],
+/// self-oscillation happening around the highest resonance.
+/// The feedback fades out as the frequency gets close to Nyquist,
+/// the highest frequency being an almost passthrough one.
+class DualLadder {
+ public:
+  /// @brief Whole filter state, trivially copyable
+  struct State {
+    /// @brief Integrators memory, by stage then lane
+    alignas(16) float stages[kLadderStagesCount][kLadderLanesCount];
+    alignas(16) float frequencies[kLadderLanesCount];  ///< Normalized
+                                                       ///< frequencies
+    float resonance;  ///< Resonance, before its compensation
+    unsigned int oversampling;  ///< Oversampling ratio
+  };
+
+  /// @brief Default constructor
+  ///
+  /// @param[in]  oversampling    Oversampling ratio: 1, 2 or 4
+  explicit DualLadder(const unsigned int oversampling = 2);
+
+  /// @brief Set the given lane frequency
+  ///
+  /// @param[in]  lane        Lane to set the frequency of
+  /// @param[in]  frequency   Normalized frequency
+  void SetFrequency(const LadderLane::Type lane, const float frequency);
+
+  /// @brief Set both lanes resonance
+  ///
+  /// @param[in]  resonance   Resonance to set the filters to
+  void SetResonance(const float resonance);
+
+  /// @brief Set the oversampling ratio
+  ///
+  /// @param[in]  oversampling    Oversampling ratio: 1, 2 or 4
+  void SetOversampling(const unsigned int oversampling);
+
+  /// @brief Process function for one buffer
+  ///
+  /// The wet lane frequency may be modulated on each sample,
+  /// it is then left to the last given one.
+  ///
+  /// @param[in]  input             Input of both lanes
+  /// @param[in]  wet_frequencies   Wet lane normalized frequency
+  ///                               for each sample, may be nullptr
+  /// @param[in]  dry_gain          Dry lane output gain
+  /// @param[in]  wet_gain          Wet lane output gain
+  /// @param[out] output            Mix of both lanes output
+  /// @param[in]  length            Buffers length
+  void Process(const float* const input,
+               const float* const wet_frequencies,
+               const float dry_gain,
+               const float wet_gain,
+               float* const output,
+               const unsigned int length);
+
+  /// @brief Process function for one sample, without any modulation
+  ///
+  /// @param[in]  input       Input of both lanes
+  /// @param[in]  dry_gain    Dry lane output gain
+  /// @param[in]  wet_gain    Wet lane output gain
+  ///
+  /// @return the mix of both lanes output
+  Sample operator()(SampleRead input,
+                    const float dry_gain,
+                    const float wet_gain);
+
+  /// @brief Capture the whole filter state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+ private:
+  // No copy nor assignment operator for this class
+  DualLadder(const DualLadder& right);
+  DualLadder& operator=(const DualLadder& right);
+
+#if (_USE_SSE)
+  /// @brief Process both lanes together, one per SIMD lane, @see Process()
+  void ProcessPacked(const float* const input,
+                     const float* const wet_frequencies,
+                     const float dry_gain,
+                     const float wet_gain,
+                     float* const output,
+                     const unsigned int length);
+#endif  // (_USE_SSE)
+
+  /// @brief Process lanes one after the other, skipping a lane whose
+  /// output gain is zero, @see Process()
+  void ProcessLanes(const float* const input,
+                    const float* const wet_frequencies,
+                    const float dry_gain,
+                    const float wet_gain,
+                    float* const output,
+                    const unsigned int length);
+
+  State state_;  ///< Everything, laid out for the processing kernel
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_DUAL_LADDER_H_
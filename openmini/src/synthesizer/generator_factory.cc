@@ -20,6 +20,8 @@
 
 #include "openmini/src/synthesizer/generator_factory.h"
 
+// std::max
+#include <algorithm>
 #include <new>
 
 #include "soundtailor/src/generators/generator_base.h"
@@ -29,21 +31,59 @@
 namespace openmini {
 namespace generators {
 
+GeneratorType::Type GetGeneratorType(const OscillatorEngine::Type engine,
+                                     const Waveform::Type waveform) {
+  OPENMINI_ASSERT(waveform < Waveform::kCount);
+  const bool triangle(Waveform::kTriangle == waveform);
+  switch (engine) {
+    case(OscillatorEngine::kDPW): {
+      return triangle ? GeneratorType::kTriangleDPW
+                      : GeneratorType::kSawtoothDPW;
+    }
+    case(OscillatorEngine::kPolyBlep): {
+      return triangle ? GeneratorType::kTrianglePolyBlep
+                      : GeneratorType::kSawtoothPolyBlep;
+    }
+    case(OscillatorEngine::kWavetable): {
+      return triangle ? GeneratorType::kTriangleWavetable
+                      : GeneratorType::kSawtoothWavetable;
+    }
+    default: {
+      // Should never happen
+      OPENMINI_ASSERT(false);
+    }
+  }
+  // Should never happen
+  OPENMINI_ASSERT(false);
+  return GeneratorType::kCount;
+}
+
+soundtailor::generators::Generator_Base* CreateGenerator(
+  const Waveform::Type waveform,
+  const float phase) {
+  void* ptr(Allocate(GeneratorSlotSize()));
+  OPENMINI_ASSERT(ptr != nullptr);
+  return CreateGenerator(ptr, waveform, phase);
+}
+
+void DestroyGenerator(soundtailor::generators::Generator_Base* generator) {
+  DestroyGeneratorInPlace(generator);
+  Deallocate(generator);
+}
+
 soundtailor::generators::Generator_Base* CreateGenerator(
+  void* slot,
   const Waveform::Type waveform,
   const float phase) {
+  OPENMINI_ASSERT(slot != nullptr);
   OPENMINI_ASSERT(phase <= 1.0f);
   OPENMINI_ASSERT(phase >= -1.0f);
   switch (waveform) {
     case(Waveform::kTriangle): {
-      void* ptr(Allocate(sizeof(soundtailor::generators::TriangleDPW)));
-      OPENMINI_ASSERT(ptr != nullptr);
-      return new (ptr) soundtailor::generators::TriangleDPW(phase);
+      return CreateGenerator(slot, GeneratorType::kTriangleDPW, phase);
     }
     case(Waveform::kSawtooth): {
-      void* ptr(Allocate(sizeof(soundtailor::generators::SawtoothDPW)));
-      OPENMINI_ASSERT(ptr != nullptr);
-      return new (ptr) soundtailor::generators::SawtoothDPW(phase);
+      return CreateGenerator(slot, GeneratorType::kSawtoothDPW, phase);
     }
     default: {
       // Should never happen
@@ -55,14 +95,117 @@ soundtailor::generators::Generator_Base* CreateGenerator(
   return nullptr;
 }
 
-void DestroyGenerator(soundtailor::generators::Generator_Base* generator) {
+soundtailor::generators::Generator_Base* CreateGenerator(
+  void* slot,
+  const GeneratorType::Type type,
+  const float phase) {
+  OPENMINI_ASSERT(slot != nullptr);
+  OPENMINI_ASSERT(phase <= 1.0f);
+  OPENMINI_ASSERT(phase >= -1.0f);
+  switch (type) {
+    case(GeneratorType::kTriangleDPW): {
+      return new (slot) soundtailor::generators::TriangleDPW(phase);
+    }
+    case(GeneratorType::kSawtoothDPW): {
+      return new (slot) soundtailor::generators::SawtoothDPW(phase);
+    }
+    case(GeneratorType::kTrianglePolyBlep): {
+      return new (slot) TrianglePolyBlep(phase);
+    }
+    case(GeneratorType::kSawtoothPolyBlep): {
+      return new (slot) SawtoothPolyBlep(phase);
+    }
+    case(GeneratorType::kPulsePolyBlep): {
+      return new (slot) PulsePolyBlep(phase);
+    }
+    case(GeneratorType::kTriangleWavetable): {
+      return new (slot) WavetableOscillator(Waveform::kTriangle, phase);
+    }
+    case(GeneratorType::kSawtoothWavetable): {
+      return new (slot) WavetableOscillator(Waveform::kSawtooth, phase);
+    }
+    default: {
+      // Should never happen
+      OPENMINI_ASSERT(false);
+    }
+  }
+  // Should never happen
+  OPENMINI_ASSERT(false);
+  return nullptr;
+}
+
+void DestroyGeneratorInPlace(
+  soundtailor::generators::Generator_Base* generator) {
   OPENMINI_ASSERT(generator != nullptr);
 
   // Beware, this is not safe! (explicit call to base destructor
   // -> possible leaks in the child!)
   // We should use smart pointers anyway
   generator->~Generator_Base();
-  Deallocate(generator);
+}
+
+/// @brief Check if the given generator type is a polyBLEP one
+static bool IsPolyBlep(const GeneratorType::Type type) {
+  return (GeneratorType::kTrianglePolyBlep == type)
+         || (GeneratorType::kSawtoothPolyBlep == type)
+         || (GeneratorType::kPulsePolyBlep == type);
+}
+
+/// @brief Check if the given generator type is a wavetable one
+static bool IsWavetable(const GeneratorType::Type type) {
+  return (GeneratorType::kTriangleWavetable == type)
+         || (GeneratorType::kSawtoothWavetable == type);
+}
+
+void SnapshotGenerator(
+  const soundtailor::generators::Generator_Base& generator,
+  const GeneratorType::Type type,
+  const float phase,
+  const float frequency,
+  GeneratorState* state) {
+  OPENMINI_ASSERT(type < GeneratorType::kCount);
+  OPENMINI_ASSERT(state != nullptr);
+
+  // Unused fields are zeroed, so that states may be compared bytewise
+  *state = GeneratorState();
+  state->type = type;
+  state->phase = phase;
+  state->frequency = frequency;
+  if (IsPolyBlep(type)) {
+    static_cast<const PolyBlep_Base&>(generator).Snapshot(&state->polyblep);
+  } else if (IsWavetable(type)) {
+    static_cast<const WavetableOscillator&>(generator).Snapshot(
+      &state->wavetable);
+  }
+}
+
+soundtailor::generators::Generator_Base* RestoreGenerator(
+  void* slot,
+  const GeneratorState& state) {
+  OPENMINI_ASSERT(slot != nullptr);
+
+  soundtailor::generators::Generator_Base* generator(
+    CreateGenerator(slot, state.type, state.phase));
+  OPENMINI_ASSERT(generator != nullptr);
+  if (IsPolyBlep(state.type)) {
+    static_cast<PolyBlep_Base*>(generator)->Restore(state.polyblep);
+  } else if (IsWavetable(state.type)) {
+    static_cast<WavetableOscillator*>(generator)->Restore(state.wavetable);
+  } else {
+    generator->SetFrequency(state.frequency);
+    generator->ProcessParameters();
+  }
+  return generator;
+}
+
+size_t GeneratorSlotSize(void) {
+  // Biggest of all generators sizes
+  return std::max({sizeof(soundtailor::generators::TriangleDPW),
+                   sizeof(soundtailor::generators::SawtoothDPW),
+                   sizeof(TrianglePolyBlep),
+                   sizeof(SawtoothPolyBlep),
+                   sizeof(PulsePolyBlep),
+                   sizeof(WavetableOscillator)});
 }
 
 }  // namespace generators
@@ -22,6 +22,8 @@
 #define OPENMINI_SRC_SYNTHESIZER_GENERATOR_FACTORY_H_
 
 #include "openmini/src/common.h"
+#include "openmini/src/synthesizer/polyblep.h"
+#include "openmini/src/synthesizer/wavetable_oscillator.h"
 
 // SoundTailor forward declarations
 namespace soundtailor {
@@ -34,6 +36,43 @@ namespace openmini {
   // TODO(gm): is this namespace actually useful?
 namespace generators {
 
+// (Using the "enum in its own namespace" trick)
+/// @brief All available generators, whatever their waveform
+namespace GeneratorType {
+enum Type {
+  kTriangleDPW = 0,
+  kSawtoothDPW,
+  kTrianglePolyBlep,
+  kSawtoothPolyBlep,
+  kPulsePolyBlep,
+  kTriangleWavetable,
+  kSawtoothWavetable,
+  kCount
+};
+}  // namespace GeneratorType
+
+/// @brief Logical state of any generator, trivially copyable
+///
+/// Only values are held, never an object image: generators are restored
+/// by creating a new one of the captured type (@see RestoreGenerator()).
+/// SoundTailor generators being opaque, only their phase and frequency
+/// are held - they resume from that phase, as on a waveform change.
+/// Other generators are restored exactly.
+struct GeneratorState {
+  GeneratorType::Type type;  ///< Generator type
+  float phase;  ///< SoundTailor generators phase, within [-1.0f ; 1.0f]
+  float frequency;  ///< SoundTailor generators normalized frequency
+  PolyBlep_Base::State polyblep;  ///< PolyBLEP generators state
+  WavetableOscillator::State wavetable;  ///< Wavetable generators state
+};
+
+/// @brief Retrieve the generator type of the given engine and waveform
+///
+/// @param[in]  engine      Generators family
+/// @param[in]  waveform    Waveform of the generator
+GeneratorType::Type GetGeneratorType(const OscillatorEngine::Type engine,
+                                     const Waveform::Type waveform);
+
 /// @brief Create a generator based on the input enum value
 ///
 /// The user is responsible for the destruction of the created object
@@ -48,6 +87,72 @@ soundtailor::generators::Generator_Base* CreateGenerator(
 
 void DestroyGenerator(soundtailor::generators::Generator_Base* generator);
 
+/// @brief Create a generator into the given memory slot
+///
+/// The slot must be at least GeneratorSlotSize() bytes long, and aligned
+/// at least on the Sample size; it may be reused for any other waveform
+/// once the generator is destroyed by DestroyGeneratorInPlace().
+///
+/// @param[in]  slot        Memory to create the generator into
+/// @param[in]  waveform    Waveform of the signal generator to be created
+/// @param[in]  phase   Phase to initialize the new generator to
+///
+/// @return a pointer to the created generator
+soundtailor::generators::Generator_Base* CreateGenerator(
+  void* slot,
+  const Waveform::Type waveform,
+  const float phase = 0.0f);
+
+/// @brief Create the given generator type into the given memory slot
+///
+/// Same as above, but allowing any generator type - e.g. polyBLEP ones.
+/// Wavetable ones may build their tables, @see WavetableOscillator
+///
+/// @param[in]  slot        Memory to create the generator into
+/// @param[in]  type        Generator to be created
+/// @param[in]  phase   Phase to initialize the new generator to
+///
+/// @return a pointer to the created generator
+soundtailor::generators::Generator_Base* CreateGenerator(
+  void* slot,
+  const GeneratorType::Type type,
+  const float phase = 0.0f);
+
+/// @brief Destroy a generator created into a memory slot,
+/// without freeing the slot itself
+void DestroyGeneratorInPlace(
+  soundtailor::generators::Generator_Base* generator);
+
+/// @brief Capture the given generator logical state
+///
+/// @param[in]  generator   Generator to capture
+/// @param[in]  type        Generator actual type
+/// @param[in]  phase       Phase to resume SoundTailor generators from
+/// @param[in]  frequency   SoundTailor generators normalized frequency
+/// @param[out] state       State to write into
+void SnapshotGenerator(
+  const soundtailor::generators::Generator_Base& generator,
+  const GeneratorType::Type type,
+  const float phase,
+  const float frequency,
+  GeneratorState* state);
+
+/// @brief Create the captured generator into the given memory slot
+///
+/// Same as CreateGenerator(), the new generator starting from
+/// the given state.
+///
+/// @param[in]  slot        Memory to create the generator into
+/// @param[in]  state       State to restore
+///
+/// @return a pointer to the created generator
+soundtailor::generators::Generator_Base* RestoreGenerator(
+  void* slot,
+  const GeneratorState& state);
+
+/// @brief Memory slot size required by the biggest generator
+size_t GeneratorSlotSize(void);
+
 }  // namespace generators
 }  // namespace openmini
 
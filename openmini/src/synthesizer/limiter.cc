@@ -21,6 +21,7 @@
 #include "openmini/src/common.h"
 #include "openmini/src/maths.h"
 #include "openmini/src/synthesizer/limiter.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
 
 namespace openmini {
 namespace synthesizer {
@@ -35,9 +36,24 @@ Limiter::~Limiter() {
   // Nothing to do here for now
 }
 
+float Limiter::Threshold(void) const {
+  return VectorMath::GetLast(threshold_pos_);
+}
+
 Sample Limiter::operator()(SampleRead input) {
   return VectorMath::Min(VectorMath::Max(input, threshold_neg_), threshold_pos_);
 }
 
+void Limiter::Process(const float* const input,
+                      float* const output,
+                      const unsigned int length) {
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(IsMultipleOf(length, SampleSize));
+  for (unsigned int i(0); i < length; i += SampleSize) {
+    VectorMath::Store(&output[i], (*this)(VectorMath::Fill(&input[i])));
+  }
+}
+
 }  // namespace synthesizer
 }  // namespace openmini
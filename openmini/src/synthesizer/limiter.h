@@ -40,6 +40,18 @@ class Limiter {
   /// @param[in]  input   Input sample
   Sample operator()(SampleRead input);
 
+  /// @brief Process function for one buffer
+  ///
+  /// @param[in]  input     Input buffer
+  /// @param[out] output    Clipped output, may be the input buffer
+  /// @param[in]  length    Buffers length, a multiple of SampleSize
+  void Process(const float* const input,
+               float* const output,
+               const unsigned int length);
+
+  /// @brief Max absolute output amplitude
+  float Threshold(void) const;
+
  private:
   // No assignment operator for this class
   Limiter& operator=(const Limiter& right);
@@ -18,32 +18,91 @@
 /// You should have received a copy of the GNU General Public License
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
+// std::fill_n
+#include <algorithm>
+#include <new>
+
 #include "openmini/src/common.h"
 #include "openmini/src/maths.h"
 #include "openmini/src/synthesizer/mixer.h"
+#include "openmini/src/samplingrate.h"
 #include "openmini/src/synthesizer/synthesizer_common.h"
-#include "openmini/src/synthesizer/vco.h"
 
 namespace openmini {
 namespace synthesizer {
 
-Mixer::Mixer()
-    : active_(false) {
-  // Nothing to do here for now
+Mixer::Mixer(Arena* arena)
+    : bank_(new (arena->Allocate<OscillatorBank>()) OscillatorBank()),
+      vcos_(arena->Allocate<Vco>(kVCOsCount)),
+      noise_(new (arena->Allocate<NoiseGenerator>()) NoiseGenerator()),
+      frequency_(0.0f),
+      // Wavetables are only acquired once required
+      tables_(nullptr),
+      engine_(OscillatorEngine::kDPW),
+      active_(false) {
+  static_assert(kVCOsCount <= static_cast<int>(kOscillatorBankLanesCount),
+                "One oscillator bank lane per VCO");
+  OPENMINI_ASSERT(bank_ != nullptr);
+  OPENMINI_ASSERT(vcos_ != nullptr);
+  OPENMINI_ASSERT(noise_ != nullptr);
+  // Remaining lanes are left muted
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    bank_->SetVolume(vco_id, 1.0f);
+    new (&vcos_[vco_id]) Vco(arena);
+    volumes_[vco_id] = 1.0f;
+    waveforms_[vco_id] = Waveform::kTriangle;
+  }
 }
 
 Mixer::~Mixer() {
-  // Nothing to do here for now
+  OPENMINI_ASSERT(bank_ != nullptr);
+  OPENMINI_ASSERT(vcos_ != nullptr);
+  OPENMINI_ASSERT(noise_ != nullptr);
+  // Memory itself belongs to the arena
+  noise_->~NoiseGenerator();
+  for (int vco_id(kVCOsCount - 1); vco_id >= 0; --vco_id) {
+    vcos_[vco_id].~Vco();
+  }
+  bank_->~OscillatorBank();
+  if (tables_ != nullptr) {
+    Wavetables::Release(tables_);
+  }
 }
 
-Sample Mixer::operator()(void) {
-  Sample output(VectorMath::Fill(0.0f));
-  if (active_) {
-    for (auto& vco : vcos_) {
-      output = VectorMath::Add(output, vco());
+void Mixer::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(length <= kBlockSize);
+  OPENMINI_ASSERT(bank_ != nullptr);
+  OPENMINI_ASSERT(noise_ != nullptr);
+  if (!active_) {
+    std::fill_n(output, length, 0.0f);
+    return;
+  }
+  alignas(16) float voice[kBlockSize];
+  if (OscillatorEngine::kDPW == engine_) {
+    bank_->Process(output, length);
+  } else {
+    // Muted VCOs do not run their generator
+    vcos_[0].Process(output, length);
+    for (int vco_id(1); vco_id < kVCOsCount; ++vco_id) {
+      vcos_[vco_id].Process(&voice[0], length);
+      for (unsigned int i(0); i < length; ++i) {
+        output[i] += voice[i];
+      }
+    }
+  }
+  if (!noise_->IsMuted()) {
+    noise_->Process(&voice[0], length);
+    for (unsigned int i(0); i < length; ++i) {
+      output[i] += voice[i];
     }
   }
-  return output;
+}
+
+Sample Mixer::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
 }
 
 void Mixer::NoteOn(const unsigned int note) {
@@ -51,9 +110,15 @@ void Mixer::NoteOn(const unsigned int note) {
   OPENMINI_ASSERT(note <= openmini::kMaxKeyNote);
 
   const float frequency(NoteToFrequency(note));
-  for (auto& vco : vcos_) {
-    vco.SetFrequency(frequency);
+  const float normalized_frequency(frequency
+                                   / SamplingRate::Instance().Get());
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    bank_->SetFrequency(vco_id, normalized_frequency);
+    if (engine_ != OscillatorEngine::kDPW) {
+      vcos_[vco_id].SetFrequency(frequency);
+    }
   }
+  frequency_ = frequency;
   active_ = true;
 }
 
@@ -63,6 +128,10 @@ void Mixer::NoteOff(const unsigned int note) {
   // Nothing to do here for now
 }
 
+void Mixer::Stop(void) {
+  active_ = false;
+}
+
 void Mixer::SetVolume(const int vco_id, const float value) {
   // TODO(gm): actual parameters management
   OPENMINI_ASSERT(vco_id >= 0);
@@ -70,7 +139,11 @@ void Mixer::SetVolume(const int vco_id, const float value) {
 
   // TODO(gm): actual oscillators volume management
   const float actual_value(value / static_cast<float>(kVCOsCount));
-  vcos_[vco_id].SetVolume(actual_value);
+  bank_->SetVolume(vco_id, actual_value);
+  if (engine_ != OscillatorEngine::kDPW) {
+    vcos_[vco_id].SetVolume(actual_value);
+  }
+  volumes_[vco_id] = actual_value;
 }
 
 void Mixer::SetWaveform(const int vco_id, const Waveform::Type value) {
@@ -78,7 +151,107 @@ void Mixer::SetWaveform(const int vco_id, const Waveform::Type value) {
   OPENMINI_ASSERT(vco_id >= 0);
   OPENMINI_ASSERT(vco_id < kVCOsCount);
 
-  vcos_[vco_id].SetWaveform(value);
+  bank_->SetWaveform(vco_id, value);
+  if (engine_ != OscillatorEngine::kDPW) {
+    vcos_[vco_id].SetWaveform(value);
+  }
+  waveforms_[vco_id] = value;
+}
+
+void Mixer::SetEngine(const OscillatorEngine::Type value) {
+  OPENMINI_ASSERT(value < OscillatorEngine::kCount);
+
+  if (OscillatorEngine::kWavetable == value) {
+    HoldTables();
+  }
+  // The bank being the DPW engine, VCOs are left as they are;
+  // otherwise they catch up with parameters they were not given meanwhile
+  if (value != OscillatorEngine::kDPW) {
+    for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+      vcos_[vco_id].SetEngine(value);
+      vcos_[vco_id].SetWaveform(waveforms_[vco_id]);
+      vcos_[vco_id].SetVolume(volumes_[vco_id]);
+      if (frequency_ > 0.0f) {
+        vcos_[vco_id].SetFrequency(frequency_);
+      }
+    }
+  }
+  engine_ = value;
+}
+
+void Mixer::SetSamplingRate(const float sampling_rate) {
+  if ((nullptr == tables_) || (sampling_rate != tables_->SamplingRate())) {
+    const Wavetables* tables(Wavetables::Acquire(sampling_rate));
+    OPENMINI_ASSERT(tables != nullptr);
+    // VCOs do not use the previous tables anymore once released
+    for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+      vcos_[vco_id].SetTables(tables);
+    }
+    if (tables_ != nullptr) {
+      Wavetables::Release(tables_);
+    }
+    tables_ = tables;
+  }
+}
+
+void Mixer::HoldTables(void) {
+  if (nullptr == tables_) {
+    SetSamplingRate(SamplingRate::Instance().Get());
+  }
+}
+
+void Mixer::SetNoiseVolume(const float value) {
+  // Same scale as the VCOs
+  noise_->SetVolume(value / static_cast<float>(kVCOsCount));
+}
+
+void Mixer::SetNoiseColor(const NoiseColor::Type value) {
+  noise_->SetColor(value);
+}
+
+void Mixer::SetNoiseSeed(const uint32_t seed) {
+  noise_->SetSeed(seed);
+}
+
+void Mixer::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  bank_->Snapshot(&state->bank);
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    vcos_[vco_id].Snapshot(&state->vcos[vco_id]);
+  }
+  noise_->Snapshot(&state->noise);
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    state->volumes[vco_id] = volumes_[vco_id];
+    state->waveforms[vco_id] = waveforms_[vco_id];
+  }
+  state->frequency = frequency_;
+  state->engine = engine_;
+  state->active = active_;
+}
+
+void Mixer::Restore(const State& state) {
+  if (OscillatorEngine::kWavetable == state.engine) {
+    HoldTables();
+  }
+  bank_->Restore(state.bank);
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    vcos_[vco_id].Restore(state.vcos[vco_id]);
+  }
+  noise_->Restore(state.noise);
+  for (int vco_id(0); vco_id < kVCOsCount; ++vco_id) {
+    volumes_[vco_id] = state.volumes[vco_id];
+    waveforms_[vco_id] = state.waveforms[vco_id];
+  }
+  frequency_ = state.frequency;
+  engine_ = state.engine;
+  active_ = state.active;
+}
+
+size_t Mixer::ArenaSize(void) {
+  return Arena::AlignedSize(sizeof(OscillatorBank))
+         + Arena::AlignedSize(kVCOsCount * sizeof(Vco))
+         + kVCOsCount * Vco::ArenaSize()
+         + Arena::AlignedSize(sizeof(NoiseGenerator));
 }
 
 }  // namespace synthesizer
@@ -21,10 +21,15 @@
 #ifndef OPENMINI_SRC_SYNTHESIZER_MIXER_H_
 #define OPENMINI_SRC_SYNTHESIZER_MIXER_H_
 
-#include <array>
+// uint32_t
+#include <cstdint>
 
 #include "openmini/src/common.h"
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/noise_generator.h"
+#include "openmini/src/synthesizer/oscillator_bank.h"
 #include "openmini/src/synthesizer/vco.h"
+#include "openmini/src/synthesizer/wavetables.h"
 
 namespace openmini {
 namespace synthesizer {
@@ -38,18 +43,48 @@ static const int kVCOsCount(3);
 /// It routes their different parameters, and sum their signal
 /// output into one mono signal.
 ///
+/// With the DPW engine (the default one) all VCOs are run together by
+/// one oscillator bank, one per lane; other engines run one Vco each,
+/// with the engine generator. The bank is always kept up to date with
+/// parameters, VCOs only while running: they catch up when selected.
+///
+/// The wavetables of the current sampling rate are held by the mixer,
+/// which gives them to its VCOs: they are only acquired when setting the
+/// sampling rate, so that selecting the wavetable engine or restoring a
+/// state never builds them within the audio thread.
 /// The number of managed VCOs is fixed at compile-time.
+///
+/// A noise source is mixed along with them, only computed when audible.
 class Mixer {
  public:
+  /// @brief Whole mixer state, trivially copyable
+  struct State {
+    OscillatorBank::State bank;  ///< All VCOs state, DPW engine
+    Vco::State vcos[kVCOsCount];  ///< All VCOs state, other engines
+    NoiseGenerator::State noise;  ///< Noise source state
+    float volumes[kVCOsCount];  ///< VCOs volumes
+    Waveform::Type waveforms[kVCOsCount];  ///< VCOs waveforms
+    float frequency;  ///< Last note frequency, in Hz
+    OscillatorEngine::Type engine;  ///< Selected oscillators engine
+    bool active;  ///< True once a note was triggered
+  };
+
   /// @brief Default constructor
-  Mixer();
+  ///
+  /// The VCOs bank, VCOs and the noise source are placed into the given arena
+  ///
+  /// @param[in]  arena   Arena to take internal memory from
+  explicit Mixer(Arena* arena);
   ~Mixer();
 
   /// @brief Process function for one buffer
   ///
-  /// Note that the buffer size is fixed: @see kBlockSize
-  ///
-  /// @param[out]    output    Output buffer to write into
+  /// @param[out]   output      Output buffer, aligned on the Sample size
+  /// @param[in]    length      Buffer length, a multiple of the Sample size
+  ///                           up to kBlockSize
+  void Process(float* const output, const unsigned int length);
+
+  /// @brief Process function for one Sample, @see Process()
   Sample operator()(void);
 
   /// @brief Trigger the given note ID on
@@ -66,6 +101,11 @@ class Mixer {
   /// @param[in]    note      Note to stop
   void NoteOff(const unsigned int note);
 
+  /// @brief Stop all VCOs until the next note
+  ///
+  /// The output is then only zeros
+  void Stop(void);
+
   /// @brief Set the VCO whose ID is given to the given volume
   ///
   /// This is normalized! Volume within [0.0f ; 1.0f]
@@ -80,8 +120,73 @@ class Mixer {
   /// @param[in]    value          Waveform type to set the VCO to
   void SetWaveform(const int vco_id, const Waveform::Type value);
 
+  /// @brief Set all VCOs to the given engine
+  ///
+  /// The wavetable engine requires the tables of the current sampling rate:
+  /// if the sampling rate was never set (@see SetSamplingRate()),
+  /// they are acquired here, which is not real-time safe.
+  ///
+  /// @param[in]    value          Oscillators engine to use
+  void SetEngine(const OscillatorEngine::Type value);
+
+  /// @brief Hold the wavetables of the given sampling rate
+  ///
+  /// This may build them, and releases the previous ones:
+  /// it should not happen in the audio thread.
+  ///
+  /// @param[in]    sampling_rate  Sampling rate, in Hz
+  void SetSamplingRate(const float sampling_rate);
+
+  /// @brief Set the noise source to the given volume
+  ///
+  /// This is normalized! Volume within [0.0f ; 1.0f]
+  ///
+  /// @param[in]    value          Volume to set the noise source to
+  void SetNoiseVolume(const float value);
+
+  /// @brief Set the noise source to the given color
+  ///
+  /// @param[in]    value          Color to set the noise source to
+  void SetNoiseColor(const NoiseColor::Type value);
+
+  /// @brief Restart the noise source from the given seed
+  ///
+  /// @param[in]    seed           Seed, the same one giving the same noise
+  void SetNoiseSeed(const uint32_t seed);
+
+  /// @brief Capture the whole mixer state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// Same as SetEngine() regarding the wavetable engine.
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+  /// @brief Arena room required by one instance
+  static size_t ArenaSize(void);
+
  private:
-  std::array<Vco, kVCOsCount> vcos_;  ///< List of VCOs
+  // No copy nor assignment operator for this class
+  Mixer(const Mixer& right);
+  Mixer& operator=(const Mixer& right);
+
+  /// @brief Acquire the wavetables of the current sampling rate,
+  /// if none are held yet, and give them to all VCOs
+  void HoldTables(void);
+
+  OscillatorBank* const bank_;  ///< All VCOs, within the arena
+  Vco* const vcos_;  ///< All VCOs for other engines, within the arena
+  NoiseGenerator* const noise_;  ///< Noise source, within the arena
+  float volumes_[kVCOsCount];  ///< VCOs volumes
+  Waveform::Type waveforms_[kVCOsCount];  ///< VCOs waveforms
+  float frequency_;  ///< Last note frequency, in Hz
+  const Wavetables* tables_;  ///< Wavetables of the current sampling rate,
+                              ///< only acquired once required
+  OscillatorEngine::Type engine_;  ///< Selected oscillators engine
   bool active_;
 };
 
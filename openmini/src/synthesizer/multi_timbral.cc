@@ -0,0 +1,180 @@
+/// @filename multi_timbral.cc
+/// @brief One independent synthesizer per MIDI channel - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/multi_timbral.h"
+
+// std::copy_n, std::fill_n, std::max, std::min
+#include <algorithm>
+
+namespace openmini {
+namespace synthesizer {
+
+MultiTimbral::MultiTimbral(const bool use_pool)
+    : parts_(),
+      pool_(use_pool ? WorkerPool::Acquire() : nullptr),
+      slots_(),
+      scratch_(nullptr),
+      max_block_size_(0),
+      silent_output_(true) {
+  slots_.fill(-1);
+  SetMaxBlockSize(kDefaultBlockSize);
+}
+
+MultiTimbral::~MultiTimbral() {
+  UnregisterParts();
+  if (pool_ != nullptr) {
+    WorkerPool::Release();
+  }
+  Deallocate(scratch_);
+}
+
+void MultiTimbral::ProcessAudio(float* const* outputs,
+                                const unsigned int length) {
+  OPENMINI_ASSERT(outputs != nullptr);
+  OPENMINI_ASSERT(length > 0);
+
+  silent_output_ = true;
+  unsigned int processed(0);
+  while (processed < length) {
+    const unsigned int chunk_length(std::min(length - processed,
+                                             max_block_size_));
+    ProcessChunk(outputs, nullptr, processed, chunk_length);
+    processed += chunk_length;
+  }
+}
+
+void MultiTimbral::ProcessAudio(float* const output,
+                                const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(length > 0);
+
+  std::fill_n(output, length, 0.0f);
+  silent_output_ = true;
+  unsigned int processed(0);
+  while (processed < length) {
+    const unsigned int chunk_length(std::min(length - processed,
+                                             max_block_size_));
+    ProcessChunk(nullptr, &output[processed], processed, chunk_length);
+    processed += chunk_length;
+  }
+}
+
+void MultiTimbral::NoteOn(const unsigned int channel,
+                          const unsigned int note) {
+  Part(channel).NoteOn(note);
+}
+
+void MultiTimbral::NoteOff(const unsigned int channel,
+                           const unsigned int note) {
+  Part(channel).NoteOff(note);
+}
+
+Synthesizer& MultiTimbral::Part(const unsigned int channel) {
+  OPENMINI_ASSERT(channel < kMidiChannelsCount);
+  return parts_[channel];
+}
+
+void MultiTimbral::SetOutputSamplingFrequency(const float freq) {
+  for (auto& part : parts_) {
+    part.SetOutputSamplingFrequency(freq);
+  }
+}
+
+void MultiTimbral::SetMaxBlockSize(const unsigned int length) {
+  OPENMINI_ASSERT(length > 0);
+
+  UnregisterParts();
+  Deallocate(scratch_);
+  scratch_ = Allocate<float>(length);
+  OPENMINI_ASSERT(scratch_ != nullptr);
+  max_block_size_ = length;
+  for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+    parts_[channel].SetMaxBlockSize(length);
+    if (pool_ != nullptr) {
+      slots_[channel] = pool_->Register(&parts_[channel], length);
+    }
+  }
+}
+
+bool MultiTimbral::IsOutputSilent(void) const {
+  return silent_output_;
+}
+
+unsigned int MultiTimbral::TailLength(void) const {
+  unsigned int tail(0);
+  for (const auto& part : parts_) {
+    tail = std::max(tail, part.TailLength());
+  }
+  return tail;
+}
+
+unsigned int MultiTimbral::PooledPartsCount(void) const {
+  unsigned int count(0);
+  for (const int slot_id : slots_) {
+    if (slot_id >= 0) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+void MultiTimbral::ProcessChunk(float* const* outputs,
+                                float* const sum,
+                                const unsigned int offset,
+                                const unsigned int length) {
+  // Workers start on pooled parts while the others are rendered here
+  for (const int slot_id : slots_) {
+    if (slot_id >= 0) {
+      pool_->Submit(slot_id, length);
+    }
+  }
+  for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+    const float* rendered(scratch_);
+    if (slots_[channel] >= 0) {
+      rendered = pool_->Collect(slots_[channel]);
+      OPENMINI_ASSERT(rendered != nullptr);
+    } else {
+      parts_[channel].ProcessAudio(scratch_, length);
+    }
+    if ((outputs != nullptr) && (outputs[channel] != nullptr)) {
+      std::copy_n(rendered, length, &outputs[channel][offset]);
+    }
+    // Silent parts do not contribute to the sum
+    const bool silent(parts_[channel].IsOutputSilent());
+    silent_output_ = silent_output_ && silent;
+    if ((sum != nullptr) && !silent) {
+      for (unsigned int i(0); i < length; ++i) {
+        sum[i] += rendered[i];
+      }
+    }
+  }
+}
+
+void MultiTimbral::UnregisterParts(void) {
+  for (auto& slot_id : slots_) {
+    if (slot_id >= 0) {
+      pool_->Unregister(slot_id);
+      slot_id = -1;
+    }
+  }
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
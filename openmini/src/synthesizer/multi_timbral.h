@@ -0,0 +1,137 @@
+/// @filename multi_timbral.h
+/// @brief One independent synthesizer per MIDI channel
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_MULTI_TIMBRAL_H_
+#define OPENMINI_SRC_SYNTHESIZER_MULTI_TIMBRAL_H_
+
+#include <array>
+
+#include "openmini/src/synthesizer/synthesizer.h"
+#include "openmini/src/synthesizer/worker_pool.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief MIDI channels count, hence multi-timbral parts count
+static const unsigned int kMidiChannelsCount(16);
+
+/// @brief Multi-timbral synthesizer: one part per MIDI channel
+///
+/// Each part is a whole Synthesizer with its own parameters;
+/// all parts are rendered in parallel through the process-wide worker pool,
+/// and collected within the same ProcessAudio() call: no latency is added.
+/// Parts not fitting into the pool are rendered on the calling thread.
+///
+/// Channels are numbered from 0 to kMidiChannelsCount - 1.
+class MultiTimbral {
+ public:
+  /// @brief Default constructor
+  ///
+  /// @param[in]  use_pool    Render parts in parallel through the pool
+  explicit MultiTimbral(const bool use_pool = true);
+  ~MultiTimbral();
+
+  /// @brief Process function for one buffer, one output per part
+  ///
+  /// @param[out]   outputs     Output buffers to write into, one per part:
+  ///                           nullptr ones are rendered but not written
+  /// @param[in]    length      Output buffers length
+  void ProcessAudio(float* const* outputs, const unsigned int length);
+
+  /// @brief Process function for one buffer, all parts summed together
+  ///
+  /// @param[out]   output      Output buffer to write into
+  /// @param[in]    length      Output buffer length
+  void ProcessAudio(float* const output, const unsigned int length);
+
+  /// @brief Trigger the given note ID on the given channel part
+  ///
+  /// @param[in]    channel   Part channel
+  /// @param[in]    note      Note to trig
+  void NoteOn(const unsigned int channel, const unsigned int note);
+
+  /// @brief Stop the given note ID on the given channel part
+  ///
+  /// @param[in]    channel   Part channel
+  /// @param[in]    note      Note to stop
+  void NoteOff(const unsigned int channel, const unsigned int note);
+
+  /// @brief Retrieve the given channel part, e.g. to change its parameters
+  ///
+  /// It must not be used concurrently with ProcessAudio().
+  ///
+  /// @param[in]    channel   Part channel
+  Synthesizer& Part(const unsigned int channel);
+
+  /// @brief Set the output sampling frequency of all parts
+  ///
+  /// @param[in]  freq    Output sampling frequency
+  void SetOutputSamplingFrequency(const float freq);
+
+  /// @brief Set the maximum expected block size
+  ///
+  /// Parts are (re)registered into the pool here, it should be called before
+  /// audio processing starts (e.g. not from within the audio thread).
+  /// Longer blocks are still allowed but will be processed by chunks.
+  ///
+  /// @param[in]  length    Maximum expected ProcessAudio() buffer length
+  void SetMaxBlockSize(const unsigned int length);
+
+  /// @brief Check if all parts output was only zeros during the last
+  /// ProcessAudio() call
+  bool IsOutputSilent(void) const;
+
+  /// @brief Longest tail of all parts, @see Synthesizer::TailLength()
+  unsigned int TailLength(void) const;
+
+  /// @brief Count of parts actually rendered through the pool
+  unsigned int PooledPartsCount(void) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  MultiTimbral(const MultiTimbral& right);
+  MultiTimbral& operator=(const MultiTimbral& right);
+
+  /// @brief Render all parts for one chunk of at most the max block size
+  ///
+  /// @param[out]   outputs     Per-part outputs (may be nullptr)
+  /// @param[out]   sum         Summed output (may be nullptr)
+  /// @param[in]    offset      Offset to write at into outputs
+  /// @param[in]    length      Chunk length
+  void ProcessChunk(float* const* outputs,
+                    float* const sum,
+                    const unsigned int offset,
+                    const unsigned int length);
+
+  /// @brief Free all pool slots
+  void UnregisterParts(void);
+
+  std::array<Synthesizer, kMidiChannelsCount> parts_;  ///< One per channel
+  WorkerPool* pool_;  ///< Process-wide pool, nullptr if not used
+  std::array<int, kMidiChannelsCount> slots_;  ///< Parts slots, -1 if none
+  float* scratch_;  ///< Rendering buffer for parts not pooled
+  unsigned int max_block_size_;  ///< Longest chunk processed at once
+  bool silent_output_;  ///< True if all parts last output was only zeros
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_MULTI_TIMBRAL_H_
@@ -0,0 +1,200 @@
+/// @filename noise_generator.cc
+/// @brief Noise source, white or pink - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/noise_generator.h"
+
+// std::memcpy
+#include <cstring>
+
+#if (_USE_SSE)
+#include <emmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Pink filter bank poles (Paul Kellet's "economy" pinking filter,
+/// the last lane being its direct path)
+alignas(16) static const float kPinkPoles[kNoiseLanesCount] = {
+  0.99765f, 0.963f, 0.57f, 0.0f
+};
+/// @brief Pink filter bank input gains
+alignas(16) static const float kPinkGains[kNoiseLanesCount] = {
+  0.099046f, 0.2965164f, 1.0526913f, 0.1848f
+};
+/// @brief Pink filter bank output gain, keeping it within [-1.0f ; 1.0f]
+/// in practice
+static const float kPinkGain(0.11f);
+/// @brief Exponent bits of 2.0f, for the integer to float conversion
+static const uint32_t kTwoExponent(0x40000000);
+
+/// @brief One xorshift generator step
+static inline uint32_t XorShift(uint32_t value) {
+  value ^= value << 13;
+  value ^= value >> 17;
+  value ^= value << 5;
+  return value;
+}
+
+/// @brief Convert the given random integer into a float
+/// uniformly distributed within [-1.0f ; 1.0f[
+///
+/// Its highest bits are used as the mantissa of a float within [2.0f ; 4.0f[
+static inline float ToUniform(const uint32_t value) {
+  const uint32_t bits((value >> 9) | kTwoExponent);
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result - 3.0f;
+}
+
+/// @brief Scramble the given seed into one lane initial state (never zero)
+static inline uint32_t SeedLane(const uint32_t seed, const unsigned int lane) {
+  uint32_t value(seed + 0x9E3779B9u * (lane + 1));
+  value = (value ^ (value >> 16)) * 0x85EBCA6Bu;
+  value = (value ^ (value >> 13)) * 0xC2B2AE35u;
+  value ^= value >> 16;
+  return (value != 0) ? value : 1;
+}
+
+NoiseGenerator::NoiseGenerator()
+    : state_() {
+  state_.color = NoiseColor::kWhite;
+  SetSeed(kDefaultNoiseSeed);
+}
+
+void NoiseGenerator::SetSeed(const uint32_t seed) {
+  for (unsigned int lane(0); lane < kNoiseLanesCount; ++lane) {
+    state_.generators[lane] = SeedLane(seed, lane);
+    state_.filters[lane] = 0.0f;
+  }
+  state_.lane = 0;
+}
+
+void NoiseGenerator::SetVolume(const float volume) {
+  OPENMINI_ASSERT(volume <= 1.0f);
+  OPENMINI_ASSERT(volume >= 0.0f);
+  state_.volume = volume;
+}
+
+void NoiseGenerator::SetColor(const NoiseColor::Type color) {
+  OPENMINI_ASSERT(color < NoiseColor::kCount);
+  state_.color = color;
+}
+
+bool NoiseGenerator::IsMuted(void) const {
+  return state_.volume == 0.0f;
+}
+
+void NoiseGenerator::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  DrawWhite(output, length);
+  if (state_.color == NoiseColor::kPink) {
+    FilterPink(output, length);
+  } else {
+    for (unsigned int i(0); i < length; ++i) {
+      output[i] *= state_.volume;
+    }
+  }
+}
+
+Sample NoiseGenerator::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void NoiseGenerator::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  *state = state_;
+}
+
+void NoiseGenerator::Restore(const State& state) {
+  state_ = state;
+}
+
+void NoiseGenerator::DrawWhite(float* const output,
+                               const unsigned int length) {
+  unsigned int i(0);
+  // One lane at a time until the next draw is from the first one
+  for (; (i < length) && (state_.lane != 0); ++i) {
+    uint32_t& generator(state_.generators[state_.lane]);
+    generator = XorShift(generator);
+    output[i] = ToUniform(generator);
+    state_.lane = (state_.lane + 1) % kNoiseLanesCount;
+  }
+#if (_USE_SSE)
+  if (i + kNoiseLanesCount <= length) {
+    const __m128i exponent(_mm_set1_epi32(static_cast<int>(kTwoExponent)));
+    const __m128 three(_mm_set1_ps(3.0f));
+    __m128i generators(_mm_load_si128(
+      reinterpret_cast<const __m128i*>(&state_.generators[0])));
+    for (; i + kNoiseLanesCount <= length; i += kNoiseLanesCount) {
+      generators = _mm_xor_si128(generators, _mm_slli_epi32(generators, 13));
+      generators = _mm_xor_si128(generators, _mm_srli_epi32(generators, 17));
+      generators = _mm_xor_si128(generators, _mm_slli_epi32(generators, 5));
+      const __m128i bits(_mm_or_si128(_mm_srli_epi32(generators, 9),
+                                      exponent));
+      _mm_storeu_ps(&output[i], _mm_sub_ps(_mm_castsi128_ps(bits), three));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i*>(&state_.generators[0]),
+                    generators);
+  }
+#endif  // (_USE_SSE)
+  for (; i < length; ++i) {
+    uint32_t& generator(state_.generators[state_.lane]);
+    generator = XorShift(generator);
+    output[i] = ToUniform(generator);
+    state_.lane = (state_.lane + 1) % kNoiseLanesCount;
+  }
+}
+
+void NoiseGenerator::FilterPink(float* const buffer,
+                                const unsigned int length) {
+  const float gain(kPinkGain * state_.volume);
+#if (_USE_SSE)
+  const __m128 poles(_mm_load_ps(&kPinkPoles[0]));
+  const __m128 gains(_mm_load_ps(&kPinkGains[0]));
+  __m128 filters(_mm_load_ps(&state_.filters[0]));
+  for (unsigned int i(0); i < length; ++i) {
+    filters = _mm_add_ps(_mm_mul_ps(filters, poles),
+                         _mm_mul_ps(gains, _mm_set1_ps(buffer[i])));
+    // All lanes mix
+    const __m128 halves(_mm_add_ps(filters, _mm_movehl_ps(filters, filters)));
+    buffer[i] = gain * _mm_cvtss_f32(
+      _mm_add_ss(halves, _mm_shuffle_ps(halves, halves,
+                                        _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  _mm_store_ps(&state_.filters[0], filters);
+#else  // (_USE_SSE)
+  for (unsigned int i(0); i < length; ++i) {
+    float mixed(0.0f);
+    for (unsigned int lane(0); lane < kNoiseLanesCount; ++lane) {
+      state_.filters[lane] = state_.filters[lane] * kPinkPoles[lane]
+                             + kPinkGains[lane] * buffer[i];
+      mixed += state_.filters[lane];
+    }
+    buffer[i] = gain * mixed;
+  }
+#endif  // (_USE_SSE)
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
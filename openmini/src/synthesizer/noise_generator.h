@@ -0,0 +1,126 @@
+/// @filename noise_generator.h
+/// @brief Noise source, white or pink, one xorshift generator per SIMD lane
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_NOISE_GENERATOR_H_
+#define OPENMINI_SRC_SYNTHESIZER_NOISE_GENERATOR_H_
+
+// uint32_t
+#include <cstdint>
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Noise generator lanes count, one SIMD register wide
+static const unsigned int kNoiseLanesCount(4);
+
+/// @brief Seed used by default, so that renders are reproducible
+static const uint32_t kDefaultNoiseSeed(0x0DDB1A5E);
+
+/// @brief Noise source, white or pink
+///
+/// White noise is uniformly distributed within [-1.0f ; 1.0f[, drawn from
+/// one xorshift generator per SIMD lane: one step yields as many samples as
+/// there are lanes. Successive samples are drawn from successive lanes,
+/// so that the output does not depend on the buffers lengths.
+///
+/// Pink noise is obtained by filtering it through a bank of first-order
+/// lowpass filters, one per lane, whose outputs are summed.
+///
+/// The output only depends on the seed: it is reproducible.
+class NoiseGenerator {
+ public:
+  /// @brief Whole generator state, trivially copyable
+  struct State {
+    /// @brief Xorshift generators states, never zero
+    alignas(16) uint32_t generators[kNoiseLanesCount];
+    /// @brief Pink filter bank memory
+    alignas(16) float filters[kNoiseLanesCount];
+    unsigned int lane;  ///< Next lane to draw a sample from
+    float volume;  ///< Output volume
+    NoiseColor::Type color;  ///< Output color
+  };
+
+  /// @brief Default constructor
+  ///
+  /// The generator is white, muted, seeded with kDefaultNoiseSeed
+  NoiseGenerator();
+
+  /// @brief Restart the generator from the given seed
+  ///
+  /// @param[in]  seed    Any value, the same seed giving the same output
+  void SetSeed(const uint32_t seed);
+
+  /// @brief Set the output volume
+  ///
+  /// This is normalized! Volume within [0.0f ; 1.0f]
+  ///
+  /// @param[in]  volume    Volume to set the generator to
+  void SetVolume(const float volume);
+
+  /// @brief Set the output color
+  ///
+  /// @param[in]  color     Noise color to set the generator to
+  void SetColor(const NoiseColor::Type color);
+
+  /// @brief Check if the output volume is null
+  bool IsMuted(void) const;
+
+  /// @brief Process function for one buffer
+  ///
+  /// @param[out] output    Generated noise
+  /// @param[in]  length    Buffer length
+  void Process(float* const output, const unsigned int length);
+
+  /// @brief Process function for one Sample
+  ///
+  /// @return the generated noise
+  Sample operator()(void);
+
+  /// @brief Capture the whole generator state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+ private:
+  // No copy nor assignment operator for this class
+  NoiseGenerator(const NoiseGenerator& right);
+  NoiseGenerator& operator=(const NoiseGenerator& right);
+
+  /// @brief Fill the given buffer with raw white noise
+  void DrawWhite(float* const output, const unsigned int length);
+
+  /// @brief Filter the given buffer in place into pink noise
+  void FilterPink(float* const buffer, const unsigned int length);
+
+  State state_;  ///< Everything, laid out for the processing kernel
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_NOISE_GENERATOR_H_
@@ -0,0 +1,207 @@
+/// @filename offline_renderer.cc
+/// @brief Checkpointed offline rendering - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/offline_renderer.h"
+
+// std::copy_n, std::lower_bound, std::min, std::stable_sort
+#include <algorithm>
+// std::memcmp
+#include <cstring>
+
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Check if the given buffer is totally silent
+static bool IsSilent(const float* const buffer, const unsigned int length) {
+  for (unsigned int i(0); i < length; ++i) {
+    if (buffer[i] != 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+OfflineRenderer::OfflineRenderer(const float sampling_rate,
+                                 const float checkpoint_period,
+                                 const bool splice_on_silence)
+    : synth_(),
+      // Zero-initialized: states are compared bytewise
+      initial_(Synthesizer::State()),
+      events_(),
+      checkpoints_(),
+      output_(),
+      scratch_(),
+      interval_(Round(sampling_rate * checkpoint_period)),
+      splice_on_silence_(splice_on_silence) {
+  OPENMINI_ASSERT(sampling_rate > 0.0f);
+  OPENMINI_ASSERT(interval_ > 0);
+  synth_.SetOutputSamplingFrequency(sampling_rate);
+  synth_.Snapshot(&initial_);
+  scratch_.resize(interval_);
+}
+
+OfflineRenderer::~OfflineRenderer() {
+  // Nothing to do here for now
+}
+
+void OfflineRenderer::Render(const std::vector<OfflineEvent>& events,
+                             const unsigned int length) {
+  OPENMINI_ASSERT(length > 0);
+
+  SetEvents(events);
+  output_.assign(length, 0.0f);
+  checkpoints_.assign((length + interval_ - 1) / interval_,
+                      Synthesizer::State());
+  synth_.Restore(initial_);
+  for (unsigned int period(0); period < checkpoints_.size(); ++period) {
+    synth_.Snapshot(&checkpoints_[period]);
+    RenderPeriod(period, &output_[period * interval_]);
+  }
+}
+
+unsigned int OfflineRenderer::Rerender(const std::vector<OfflineEvent>& events,
+                                       const unsigned int begin,
+                                       const unsigned int end) {
+  OPENMINI_ASSERT(!checkpoints_.empty());
+  OPENMINI_ASSERT(begin <= end);
+
+  SetEvents(events);
+  const unsigned int first(std::min(begin / interval_,
+                                    CheckpointsCount() - 1));
+  synth_.Restore(checkpoints_[first]);
+  unsigned int rendered(0);
+  // True if both renders were silent during the previous period
+  bool silent(false);
+  for (unsigned int period(first); period < checkpoints_.size(); ++period) {
+    const unsigned int period_begin(period * interval_);
+    if (period > first) {
+      Synthesizer::State state = Synthesizer::State();
+      synth_.Snapshot(&state);
+      // Convergence is only looked for past the changed region
+      if (period_begin >= end) {
+        // Bytes not actually used by the state (e.g. padding) may only make
+        // identical states look different, which merely means rendering more
+        if (std::memcmp(&state, &checkpoints_[period], sizeof(state)) == 0) {
+          break;
+        }
+        if (splice_on_silence_
+            && silent
+            && (std::memcmp(&state.parameters,
+                            &checkpoints_[period].parameters,
+                            sizeof(state.parameters)) == 0)) {
+          break;
+        }
+      }
+      // All re-rendered periods checkpoints are refreshed,
+      // so that later re-renders start from the current timeline
+      checkpoints_[period] = state;
+    }
+    const unsigned int period_length(
+      std::min(interval_,
+               static_cast<unsigned int>(output_.size()) - period_begin));
+    const bool previous_silent(IsSilent(&output_[period_begin],
+                                        period_length));
+    silent = RenderPeriod(period, &scratch_[0]) && previous_silent;
+    std::copy_n(&scratch_[0], period_length, &output_[period_begin]);
+    rendered += period_length;
+  }
+  return rendered;
+}
+
+const std::vector<float>& OfflineRenderer::Output(void) const {
+  return output_;
+}
+
+unsigned int OfflineRenderer::CheckpointsCount(void) const {
+  return static_cast<unsigned int>(checkpoints_.size());
+}
+
+unsigned int OfflineRenderer::CheckpointInterval(void) const {
+  return interval_;
+}
+
+void OfflineRenderer::SetEvents(const std::vector<OfflineEvent>& events) {
+  events_ = events;
+  // Events at the same position keep their relative order
+  std::stable_sort(events_.begin(),
+                   events_.end(),
+                   [](const OfflineEvent& left, const OfflineEvent& right) {
+                     return left.position < right.position;
+                   });
+}
+
+bool OfflineRenderer::RenderPeriod(const unsigned int period,
+                                   float* const output) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  const unsigned int begin(period * interval_);
+  const unsigned int end(std::min(begin + interval_,
+                                  static_cast<unsigned int>(output_.size())));
+  OPENMINI_ASSERT(begin < end);
+  std::vector<OfflineEvent>::const_iterator event(
+    std::lower_bound(events_.begin(),
+                     events_.end(),
+                     begin,
+                     [](const OfflineEvent& left, const unsigned int right) {
+                       return left.position < right;
+                     }));
+  // Rendering is split at each event position: a period is always split
+  // the same way, hence re-rendered exactly the same
+  unsigned int position(begin);
+  while (position < end) {
+    while ((event != events_.end()) && (event->position == position)) {
+      Apply(*event);
+      ++event;
+    }
+    const unsigned int next(
+      ((event != events_.end()) && (event->position < end))
+      ? event->position
+      : end);
+    synth_.ProcessAudio(&output[position - begin], next - position);
+    position = next;
+  }
+  return IsSilent(output, end - begin);
+}
+
+void OfflineRenderer::Apply(const OfflineEvent& event) {
+  switch (event.type) {
+    case(OfflineEvent::kNoteOn): {
+      synth_.NoteOn(event.id);
+      break;
+    }
+    case(OfflineEvent::kNoteOff): {
+      synth_.NoteOff(event.id);
+      break;
+    }
+    case(OfflineEvent::kParameter): {
+      synth_.SetValue(event.id, event.value);
+      break;
+    }
+    default: {
+      // Should never happen
+      OPENMINI_ASSERT(false);
+    }
+  }
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
@@ -0,0 +1,135 @@
+/// @filename offline_renderer.h
+/// @brief Checkpointed offline rendering
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_OFFLINE_RENDERER_H_
+#define OPENMINI_SRC_SYNTHESIZER_OFFLINE_RENDERER_H_
+
+#include <vector>
+
+#include "openmini/src/synthesizer/synthesizer.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief One timed event of an offline render
+struct OfflineEvent {
+  /// @brief Event types
+  enum Type {
+    kNoteOn = 0,
+    kNoteOff,
+    kParameter
+  };
+
+  unsigned int position;  ///< Position within the render, in samples
+  Type type;  ///< Event type
+  int id;  ///< Note for note events, parameter ID for parameter ones
+  float value;  ///< Normalized parameter value (parameter events only)
+};
+
+/// @brief Offline renderer: renders a whole timeline of events
+/// while recording periodic synthesizer state checkpoints
+///
+/// When events change within a region, only the part from the last
+/// checkpoint before the change up to the point where the synthesizer
+/// converges back is re-rendered, and spliced into the previous output.
+/// Converging back means either:
+/// - reaching a checkpoint with the very same state as the previous render
+/// - (optionally) reaching a checkpoint both renders went silent before,
+/// with the same parameters: from there the previous render is kept,
+/// which only differs from a full re-render by the internal state of a
+/// silent synthesizer (oscillators phases, filters memory...).
+class OfflineRenderer {
+ public:
+  /// @brief Default constructor
+  ///
+  /// @param[in]  sampling_rate       Render sampling rate
+  /// @param[in]  checkpoint_period   Time in between checkpoints, in seconds
+  /// @param[in]  splice_on_silence   Allow converging on silence
+  OfflineRenderer(const float sampling_rate,
+                  const float checkpoint_period,
+                  const bool splice_on_silence = true);
+  ~OfflineRenderer();
+
+  /// @brief Render the whole timeline from scratch
+  ///
+  /// @param[in]  events    Timeline events, in any order
+  /// @param[in]  length    Render length, in samples
+  void Render(const std::vector<OfflineEvent>& events,
+              const unsigned int length);
+
+  /// @brief Re-render after a change within a region of the timeline
+  ///
+  /// The new events must be the same as the previous ones
+  /// outside of the given region.
+  ///
+  /// @param[in]  events    New timeline events, in any order
+  /// @param[in]  begin     Beginning of the changed region, in samples
+  /// @param[in]  end       End of the changed region, in samples
+  ///
+  /// @return the count of samples actually re-rendered
+  unsigned int Rerender(const std::vector<OfflineEvent>& events,
+                        const unsigned int begin,
+                        const unsigned int end);
+
+  /// @brief Rendered output
+  const std::vector<float>& Output(void) const;
+
+  /// @brief Checkpoints count, one at the beginning of each period
+  unsigned int CheckpointsCount(void) const;
+
+  /// @brief Time in between checkpoints, in samples
+  unsigned int CheckpointInterval(void) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  OfflineRenderer(const OfflineRenderer& right);
+  OfflineRenderer& operator=(const OfflineRenderer& right);
+
+  /// @brief Sort and store the given events
+  void SetEvents(const std::vector<OfflineEvent>& events);
+
+  /// @brief Render one checkpoint period, applying events on the way
+  ///
+  /// The synthesizer must be in the state of this period checkpoint.
+  ///
+  /// @param[in]  period    Period index
+  /// @param[out] output    Buffer to write into, one period long
+  ///
+  /// @return true if the rendered period is totally silent
+  bool RenderPeriod(const unsigned int period, float* const output);
+
+  /// @brief Apply one event to the synthesizer
+  void Apply(const OfflineEvent& event);
+
+  Synthesizer synth_;  ///< The one synthesizer rendering everything
+  Synthesizer::State initial_;  ///< Synthesizer state before any rendering
+  std::vector<OfflineEvent> events_;  ///< Timeline events, sorted
+  std::vector<Synthesizer::State> checkpoints_;  ///< State at the beginning
+                                                 ///< of each period
+  std::vector<float> output_;  ///< Whole rendered output
+  std::vector<float> scratch_;  ///< Re-rendering buffer, one period long
+  const unsigned int interval_;  ///< Time in between checkpoints, in samples
+  const bool splice_on_silence_;  ///< Allow converging on silence
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_OFFLINE_RENDERER_H_
@@ -0,0 +1,181 @@
+/// @filename oscillator_bank.cc
+/// @brief All VCOs generators run together - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/oscillator_bank.h"
+
+// std::fabs
+#include <cmath>
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Highest allowed normalized frequency (excluded)
+static const float kBankMaxFrequency(0.5f);
+/// @brief Selection mask value for triangle lanes
+static const uint32_t kTriangleMask(0xFFFFFFFF);
+
+/// @brief Given waveform DPW polynomial, before its differentiation
+static inline float Polynomial(const Waveform::Type waveform,
+                               const float phase) {
+  if (waveform == Waveform::kTriangle) {
+    return phase - phase * std::fabs(phase);
+  }
+  return phase * phase;
+}
+
+OscillatorBank::OscillatorBank()
+    : state_() {
+  for (unsigned int lane(0); lane < kOscillatorBankLanesCount; ++lane) {
+    state_.triangles[lane] = kTriangleMask;
+    state_.waveforms[lane] = Waveform::kTriangle;
+  }
+}
+
+void OscillatorBank::SetFrequency(const unsigned int lane,
+                                  const float frequency) {
+  OPENMINI_ASSERT(lane < kOscillatorBankLanesCount);
+  OPENMINI_ASSERT(frequency >= 0.0f);
+  OPENMINI_ASSERT(frequency < kBankMaxFrequency);
+
+  state_.increments[lane] = 2.0f * frequency;
+  UpdateScale(lane);
+}
+
+void OscillatorBank::SetVolume(const unsigned int lane, const float volume) {
+  OPENMINI_ASSERT(lane < kOscillatorBankLanesCount);
+  OPENMINI_ASSERT(volume <= 1.0f);
+  OPENMINI_ASSERT(volume >= 0.0f);
+
+  state_.volumes[lane] = volume;
+  UpdateScale(lane);
+}
+
+void OscillatorBank::SetWaveform(const unsigned int lane,
+                                 const Waveform::Type value) {
+  OPENMINI_ASSERT(lane < kOscillatorBankLanesCount);
+  OPENMINI_ASSERT(value < Waveform::kCount);
+
+  if (value != state_.waveforms[lane]) {
+    state_.waveforms[lane] = value;
+    state_.triangles[lane] = (value == Waveform::kTriangle) ? kTriangleMask : 0;
+    // The differentiator would otherwise output a spike
+    state_.differentiators[lane] = Polynomial(value, state_.phases[lane]);
+    UpdateScale(lane);
+  }
+}
+
+void OscillatorBank::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+#if (_USE_SSE)
+  const __m128 one(_mm_set1_ps(1.0f));
+  const __m128 two(_mm_set1_ps(2.0f));
+  const __m128 sign(_mm_set1_ps(-0.0f));
+  const __m128 scales(_mm_load_ps(&state_.scales[0]));
+  const __m128 triangles(_mm_load_ps(
+    reinterpret_cast<const float*>(&state_.triangles[0])));
+  // Silent lanes phases are frozen
+  const __m128 increments(_mm_and_ps(
+    _mm_cmpneq_ps(scales, _mm_setzero_ps()),
+    _mm_load_ps(&state_.increments[0])));
+  __m128 phases(_mm_load_ps(&state_.phases[0]));
+  __m128 differentiators(_mm_load_ps(&state_.differentiators[0]));
+  for (unsigned int i(0); i < length; ++i) {
+    phases = _mm_add_ps(phases, increments);
+    phases = _mm_sub_ps(phases, _mm_and_ps(_mm_cmpgt_ps(phases, one), two));
+    const __m128 sawtooth(_mm_mul_ps(phases, phases));
+    const __m128 triangle(_mm_sub_ps(
+      phases,
+      _mm_mul_ps(phases, _mm_andnot_ps(sign, phases))));
+    const __m128 polynomials(_mm_or_ps(_mm_and_ps(triangles, triangle),
+                                       _mm_andnot_ps(triangles, sawtooth)));
+    const __m128 lanes(_mm_mul_ps(scales,
+                                  _mm_sub_ps(polynomials, differentiators)));
+    differentiators = polynomials;
+    // All lanes mix
+    const __m128 halves(_mm_add_ps(lanes, _mm_movehl_ps(lanes, lanes)));
+    output[i] = _mm_cvtss_f32(
+      _mm_add_ss(halves, _mm_shuffle_ps(halves, halves,
+                                        _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  _mm_store_ps(&state_.phases[0], phases);
+  _mm_store_ps(&state_.differentiators[0], differentiators);
+#else  // (_USE_SSE)
+  float increments[kOscillatorBankLanesCount];
+  for (unsigned int lane(0); lane < kOscillatorBankLanesCount; ++lane) {
+    // Silent lanes phases are frozen
+    increments[lane] = (state_.scales[lane] != 0.0f)
+                       ? state_.increments[lane]
+                       : 0.0f;
+  }
+  for (unsigned int i(0); i < length; ++i) {
+    float mixed(0.0f);
+    for (unsigned int lane(0); lane < kOscillatorBankLanesCount; ++lane) {
+      float phase(state_.phases[lane] + increments[lane]);
+      if (phase > 1.0f) {
+        phase -= 2.0f;
+      }
+      const float polynomial(Polynomial(state_.waveforms[lane], phase));
+      mixed += state_.scales[lane]
+               * (polynomial - state_.differentiators[lane]);
+      state_.phases[lane] = phase;
+      state_.differentiators[lane] = polynomial;
+    }
+    output[i] = mixed;
+  }
+#endif  // (_USE_SSE)
+}
+
+Sample OscillatorBank::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void OscillatorBank::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  *state = state_;
+}
+
+void OscillatorBank::Restore(const State& state) {
+  state_ = state;
+}
+
+void OscillatorBank::UpdateScale(const unsigned int lane) {
+  OPENMINI_ASSERT(lane < kOscillatorBankLanesCount);
+
+  const float increment(state_.increments[lane]);
+  if (increment == 0.0f) {
+    state_.scales[lane] = 0.0f;
+  } else {
+    // Differentiation normalization, depending on the polynomial derivative
+    const float normalization(
+      (state_.waveforms[lane] == Waveform::kTriangle) ? increment
+                                                      : 2.0f * increment);
+    state_.scales[lane] = state_.volumes[lane] / normalization;
+  }
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
@@ -0,0 +1,127 @@
+/// @filename oscillator_bank.h
+/// @brief All VCOs generators run together, one per SIMD lane
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_OSCILLATOR_BANK_H_
+#define OPENMINI_SRC_SYNTHESIZER_OSCILLATOR_BANK_H_
+
+// uint32_t
+#include <cstdint>
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Oscillator bank lanes count, one SIMD register wide
+static const unsigned int kOscillatorBankLanesCount(4);
+
+/// @brief Bank of DPW oscillators, one per SIMD lane
+///
+/// All oscillators phase accumulators and differentiators are run together
+/// and directly output their mix: the generators virtual calls and
+/// per-oscillator volume multiplications are replaced by one single pass
+/// over the whole buffer.
+///
+/// Each lane is a differentiated parabolic waveform (DPW) oscillator,
+/// its waveform being selected by masking - the same phase accumulator
+/// being used by all of them, changing waveforms keeps the phase.
+/// A muted lane is frozen: it resumes where it stopped once unmuted.
+/// Unused lanes are muted.
+class OscillatorBank {
+ public:
+  /// @brief Whole bank state, trivially copyable
+  struct State {
+    alignas(16) float phases[kOscillatorBankLanesCount];  ///< Phases,
+                                                          ///< within [-1 ; 1]
+    /// @brief Differentiators memory: last polynomial values
+    alignas(16) float differentiators[kOscillatorBankLanesCount];
+    /// @brief Phase increments, twice the normalized frequencies
+    alignas(16) float increments[kOscillatorBankLanesCount];
+    /// @brief Output scales: volume and differentiation normalization
+    alignas(16) float scales[kOscillatorBankLanesCount];
+    /// @brief Waveform selection masks, all bits set for triangle lanes
+    alignas(16) uint32_t triangles[kOscillatorBankLanesCount];
+    float volumes[kOscillatorBankLanesCount];  ///< Lanes volumes
+    Waveform::Type waveforms[kOscillatorBankLanesCount];  ///< Lanes waveforms
+  };
+
+  /// @brief Default constructor
+  ///
+  /// All lanes are triangles, muted, with a null frequency
+  OscillatorBank();
+
+  /// @brief Set the given lane frequency
+  ///
+  /// @param[in]  lane        Lane to set the frequency of
+  /// @param[in]  frequency   Normalized frequency, within [0.0f ; 0.5f[
+  void SetFrequency(const unsigned int lane, const float frequency);
+
+  /// @brief Set the given lane volume
+  ///
+  /// This is normalized! Volume within [0.0f ; 1.0f]
+  ///
+  /// @param[in]  lane      Lane to set the volume of
+  /// @param[in]  volume    Volume to set the lane to
+  void SetVolume(const unsigned int lane, const float volume);
+
+  /// @brief Set the given lane waveform
+  ///
+  /// @param[in]  lane      Lane to set the waveform of
+  /// @param[in]  value     Waveform type to set the lane to
+  void SetWaveform(const unsigned int lane, const Waveform::Type value);
+
+  /// @brief Process function for one buffer
+  ///
+  /// @param[out] output    Mix of all lanes output
+  /// @param[in]  length    Buffer length
+  void Process(float* const output, const unsigned int length);
+
+  /// @brief Process function for one Sample
+  ///
+  /// @return the mix of all lanes output
+  Sample operator()(void);
+
+  /// @brief Capture the whole bank state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+ private:
+  // No copy nor assignment operator for this class
+  OscillatorBank(const OscillatorBank& right);
+  OscillatorBank& operator=(const OscillatorBank& right);
+
+  /// @brief Update the given lane output scale from its parameters
+  void UpdateScale(const unsigned int lane);
+
+  State state_;  ///< Everything, laid out for the processing kernel
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_OSCILLATOR_BANK_H_
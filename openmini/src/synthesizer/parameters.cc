@@ -0,0 +1,179 @@
+/// @filename parameters.cc
+/// @brief Parameters definitions
+/// @author gm
+/// @copyright gm 2013
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/parameters.h"
+
+// TODO(gm): This should be required as a dependency,
+// it is now for easier handling of filter domain - get rid of it
+#include "soundtailor/src/filters/moog.h"
+
+#include "openmini/src/synthesizer/parameters_manager.h"
+
+namespace openmini {
+namespace synthesizer {
+namespace Parameters {
+
+// Implementation detail: ordered from the most probable to the least
+const std::array<ParameterMeta, Parameters::kCount> kParametersMeta = {{
+  ParameterMeta(0.0f,
+                1.0f,
+                1.0f,
+                1,
+                0,
+                "Osc1 Volume",
+                "Volume for oscillator 1"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                0,
+                "Osc2 Volume",
+                "Volume for oscillator 2"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                0,
+                "Osc3 Volume",
+                "Volume for oscillator 3"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                Waveform::kCount,
+                "Osc1 Waveform",
+                "Waveform for oscillator 1"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                Waveform::kCount,
+                "Osc2 Waveform",
+                "Waveform for oscillator 2"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                Waveform::kCount,
+                "Osc3 Waveform",
+                "Waveform for oscillator 3"),
+  ParameterMeta(soundtailor::filters::Moog::Meta().freq_min,
+                soundtailor::filters::Moog::Meta().freq_max,
+                1.0f,  // "almost" passthrough
+                1,
+                0,
+                "Filter Freq",
+                "Cutoff Frequency for the filter"),
+  ParameterMeta(soundtailor::filters::Moog::Meta().res_min,
+                soundtailor::filters::Moog::Meta().res_max,
+                0.7f,
+                1,
+                0,
+                "Filter Resonance",
+                "Resonance for the filter"),
+  ParameterMeta(static_cast<float>(kMinTime),
+                static_cast<float>(kMaxTime),
+                0.5f,
+                1,
+                kMaxTime - kMinTime,
+                "Attack Time",
+                "Envelop generator attack time"),
+  ParameterMeta(static_cast<float>(kMinTime),
+                static_cast<float>(kMaxTime),
+                0.5f,
+                1,
+                kMaxTime - kMinTime,
+                "Decay Time",
+                "Envelop generator decay time"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.5f,
+                1,
+                0,
+                "Sustain Level",
+                "Envelop generator sustain level"),
+  ParameterMeta(static_cast<float>(kMinTime),
+                static_cast<float>(kMaxTime),
+                0.5f,
+                1,
+                kMaxTime - kMinTime,
+                "Contour Attack Time",
+                "Filter contour attack time"),
+  ParameterMeta(static_cast<float>(kMinTime),
+                static_cast<float>(kMaxTime),
+                0.5f,
+                1,
+                kMaxTime - kMinTime,
+                "Contour Decay Time",
+                "Filter contour decay time"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.5f,
+                1,
+                0,
+                "Contour Sustain Level",
+                "Filter contour sustain level"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.5f,
+                1,
+                0,
+                "Contour Amount",
+                "Filter contour dry/wet tuning"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                0,
+                "Noise Volume",
+                "Volume for the noise source"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                NoiseColor::kCount,
+                "Noise Color",
+                "Color of the noise source (white or pink)"),
+  ParameterMeta(0.0f,
+                1.0f,
+                0.0f,
+                1,
+                OscillatorEngine::kCount,
+                "Osc Engine",
+                "Oscillators engine (DPW, polyBLEP or wavetable)")
+}};
+
+/// @brief Compute all parameters stored default values
+static std::array<float, Parameters::kCount> ComputeDefaults(void) {
+  std::array<float, Parameters::kCount> defaults;
+  for (unsigned int i(0); i < defaults.size(); ++i) {
+    defaults[i] = NormalizedToStored(kParametersMeta[i].default_value(),
+                                     kParametersMeta[i]);
+  }
+  return defaults;
+}
+
+// Defined after the metadata, hence initialized after it
+const std::array<float, Parameters::kCount> kParametersDefaults(
+  ComputeDefaults());
+
+}  // namespace Parameters
+}  // namespace synthesizer
+}  // namespace openmini
@@ -26,10 +26,6 @@
 #include "openmini/src/common.h"
 #include "openmini/src/synthesizer/parameter_meta.h"
 
-// TODO(gm): This should be required as a dependency,
-// it is now for easier handling of filter domain - get rid of it
-#include "soundtailor/src/filters/moog.h"
-
 namespace openmini {
 namespace synthesizer {
 
@@ -52,118 +48,22 @@ enum Type {
   kContourDecay,
   kContourSustain,
   kContourAmount,
+  kNoiseVolume,
+  kNoiseColor,
+  kOscillatorEngine,
   kCount
 };
 
 /// @brief Parameters metadata
-// Implementation detail: ordered from the most probable to the least
-const std::array<ParameterMeta, Parameters::kCount> kParametersMeta = {{
-  ParameterMeta(0.0f,
-                1.0f,
-                1.0f,
-                1,
-                0,
-                "Osc1 Volume",
-                "Volume for oscillator 1"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.0f,
-                1,
-                0,
-                "Osc2 Volume",
-                "Volume for oscillator 2"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.0f,
-                1,
-                0,
-                "Osc3 Volume",
-                "Volume for oscillator 3"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.0f,
-                1,
-                Waveform::kCount,
-                "Osc1 Waveform",
-                "Waveform for oscillator 1"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.0f,
-                1,
-                Waveform::kCount,
-                "Osc2 Waveform",
-                "Waveform for oscillator 2"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.0f,
-                1,
-                Waveform::kCount,
-                "Osc3 Waveform",
-                "Waveform for oscillator 3"),
-  ParameterMeta(soundtailor::filters::Moog::Meta().freq_min,
-                soundtailor::filters::Moog::Meta().freq_max,
-                1.0f,  // "almost" passthrough
-                1,
-                0,
-                "Filter Freq",
-                "Cutoff Frequency for the filter"),
-  ParameterMeta(soundtailor::filters::Moog::Meta().res_min,
-                soundtailor::filters::Moog::Meta().res_max,
-                0.7f,
-                1,
-                0,
-                "Filter Resonance",
-                "Resonance for the filter"),
-  ParameterMeta(static_cast<float>(kMinTime),
-                static_cast<float>(kMaxTime),
-                0.5f,
-                1,
-                kMaxTime - kMinTime,
-                "Attack Time",
-                "Envelop generator attack time"),
-  ParameterMeta(static_cast<float>(kMinTime),
-                static_cast<float>(kMaxTime),
-                0.5f,
-                1,
-                kMaxTime - kMinTime,
-                "Decay Time",
-                "Envelop generator decay time"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.5f,
-                1,
-                0,
-                "Sustain Level",
-                "Envelop generator sustain level"),
-  ParameterMeta(static_cast<float>(kMinTime),
-                static_cast<float>(kMaxTime),
-                0.5f,
-                1,
-                kMaxTime - kMinTime,
-                "Contour Attack Time",
-                "Filter contour attack time"),
-  ParameterMeta(static_cast<float>(kMinTime),
-                static_cast<float>(kMaxTime),
-                0.5f,
-                1,
-                kMaxTime - kMinTime,
-                "Contour Decay Time",
-                "Filter contour decay time"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.5f,
-                1,
-                0,
-                "Contour Sustain Level",
-                "Filter contour sustain level"),
-  ParameterMeta(0.0f,
-                1.0f,
-                0.5f,
-                1,
-                0,
-                "Contour Amount",
-                "Filter contour dry/wet tuning")
-}};
+///
+/// Defined once for the whole process: parameters names and descriptions
+/// are not built again for each instance
+extern const std::array<ParameterMeta, Parameters::kCount> kParametersMeta;
+
+/// @brief Parameters default values, precomputed from their metadata
+///
+/// Values are the stored (unnormalized) ones, ready to be copied in
+extern const std::array<float, Parameters::kCount> kParametersDefaults;
 
 }  // namespace Parameters
 }  // namespace synthesizer
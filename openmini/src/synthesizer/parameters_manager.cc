@@ -62,14 +62,39 @@ int UnnormalizedToInt(const float unnormalized) {
   return FloorAndConvert<int>(unnormalized);
 }
 
+/// @brief All parameters bits set
+static const unsigned int kAllParameters(
+  static_cast<unsigned int>((1ull << Parameters::kCount) - 1));
+
+/// @brief Lowest bit set in the given (non-null) bitmask
+static int LowestBit(const unsigned int bitmask) {
+  OPENMINI_ASSERT(bitmask != 0);
+  int bit(0);
+  while (0 == ((bitmask >> bit) & 1u)) {
+    bit += 1;
+  }
+  return bit;
+}
+
 ParametersManager::ParametersManager(
   const std::array<ParameterMeta, Parameters::kCount>& params)
-    : updated_parameters_(),
+    : updated_parameters_(0),
       values_(),
       metadatas_(params) {
+  static_assert(Parameters::kCount <= 8 * sizeof(unsigned int),
+                "Too many parameters for the updates bitmask");
   AssignDefault();
 }
 
+ParametersManager::ParametersManager(
+  const std::array<ParameterMeta, Parameters::kCount>& params,
+  const std::array<float, Parameters::kCount>& defaults)
+    : updated_parameters_(kAllParameters),
+      values_(defaults),
+      metadatas_(params) {
+  // Nothing to do here for now
+}
+
 ParametersManager::~ParametersManager() {
   // Nothing to do here for now
 }
@@ -81,7 +106,7 @@ void ParametersManager::SetValue(const int parameter_id, const float value) {
   const ParameterMeta& metadata(GetMetadata(parameter_id));
   // The parameter is normalized, we have to pass through normalization
   values_[parameter_id] = NormalizedToStored(value, metadata);
-  updated_parameters_.insert(parameter_id);
+  updated_parameters_ |= 1u << parameter_id;
 }
 
 float ParametersManager::GetValue(const int parameter_id) const {
@@ -104,12 +129,16 @@ unsigned int ParametersManager::ParametersCount(void) const {
   return static_cast<unsigned int>(values_.size());
 }
 
+size_t ParametersManager::ParametersMemoryUsage(void) const {
+  return sizeof(ParametersManager);
+}
+
 bool ParametersManager::ParametersChanged(void) {
-  return !(updated_parameters_.empty());
+  return updated_parameters_ != 0;
 }
 
 void ParametersManager::ParametersProcessed(void) {
-  updated_parameters_.clear();
+  updated_parameters_ = 0;
 }
 
 void ParametersManager::AssignDefault(void) {
@@ -119,9 +148,18 @@ void ParametersManager::AssignDefault(void) {
 }
 
 void ParametersManager::ForceParametersProcess(void) {
-  for (unsigned int i(0); i < Parameters::kCount; ++i) {
-    updated_parameters_.insert(i);
-  }
+  updated_parameters_ = kAllParameters;
+}
+
+void ParametersManager::SnapshotParameters(ParametersState* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  state->values = values_;
+  state->updated = updated_parameters_;
+}
+
+void ParametersManager::RestoreParameters(const ParametersState& state) {
+  values_ = state.values;
+  updated_parameters_ = state.updated;
 }
 
 float ParametersManager::GetRawValue(const int parameter_id) const {
@@ -133,13 +171,14 @@ float ParametersManager::GetRawValue(const int parameter_id) const {
 
 ParametersManager::UpdatedParametersIterator::UpdatedParametersIterator(
   const ParametersManager& manager)
-    : manager_(manager),
-      iterator_(manager.updated_parameters_.begin()) {
+    : remaining_(manager.updated_parameters_),
+      current_((remaining_ != 0) ? LowestBit(remaining_) : -1) {
 }
 
 bool ParametersManager::UpdatedParametersIterator::Next() {
-  ++iterator_;
-  if (iterator_ != manager_.updated_parameters_.end()) {
+  remaining_ &= ~(1u << current_);
+  if (remaining_ != 0) {
+    current_ = LowestBit(remaining_);
     return true;
   } else {
     return false;
@@ -147,7 +186,7 @@ bool ParametersManager::UpdatedParametersIterator::Next() {
 }
 
 int ParametersManager::UpdatedParametersIterator::GetID(void) const {
-  return *iterator_;
+  return current_;
 }
 
 }  // namespace synthesizer
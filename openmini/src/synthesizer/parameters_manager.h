@@ -24,7 +24,6 @@
 #define OPENMINI_SRC_SYNTHESIZER_PARAMETERS_MANAGER_H_
 
 #include <array>
-#include <set>
 
 #include "openmini/src/synthesizer/parameters.h"
 #include "openmini/src/synthesizer/parameter_meta.h"
@@ -89,11 +88,25 @@ int UnnormalizedToInt(const float unnormalized);
 /// }
 class ParametersManager {
  public:
+  /// @brief Whole parameters state, trivially copyable
+  struct ParametersState {
+    std::array<float, Parameters::kCount> values;  ///< Stored values
+    unsigned int updated;  ///< Parameters not processed yet, one bit each
+  };
+
   /// @brief Default constructor:
   /// initialization done with static parameter descriptors data,
   /// parameter values memory static too
   ParametersManager(
     const std::array<ParameterMeta, Parameters::kCount>& params);
+  /// @brief Constructor with precomputed default values,
+  /// which are simply copied in
+  ///
+  /// @param[in]  params      Parameters descriptors
+  /// @param[in]  defaults    Parameters default stored (unnormalized) values
+  ParametersManager(
+    const std::array<ParameterMeta, Parameters::kCount>& params,
+    const std::array<float, Parameters::kCount>& defaults);
   /// @brief Default destructor
   virtual ~ParametersManager();
 
@@ -134,6 +147,11 @@ class ParametersManager {
   /// @brief Return managed parameters count
   virtual unsigned int ParametersCount(void) const;
 
+  /// @brief Memory used by this manager, in bytes
+  ///
+  /// Shared parameters metadata are not taken into account.
+  size_t ParametersMemoryUsage(void) const;
+
   /// @brief An iterator class to browse through all "updated" parameters
   ///
   /// "Updated" here means parameters whose value have been changed
@@ -163,8 +181,8 @@ class ParametersManager {
     UpdatedParametersIterator& operator=(
       const UpdatedParametersIterator& right);
 
-    const ParametersManager& manager_;
-    std::set<int>::const_iterator iterator_;
+    unsigned int remaining_;  ///< Updated parameters not browsed yet
+    int current_;  ///< Current parameter ID
   };
 
  protected:
@@ -187,6 +205,18 @@ class ParametersManager {
   /// @brief Force all parameters to be re-processed at next iteration
   void ForceParametersProcess(void);
 
+  /// @brief Capture all parameters values and pending changes
+  ///
+  /// @param[out] state   State to write into
+  void SnapshotParameters(ParametersState* state) const;
+
+  /// @brief Restore previously captured parameters
+  ///
+  /// Pending changes are restored as well: they are not notified again
+  ///
+  /// @param[in]  state   State to restore
+  void RestoreParameters(const ParametersState& state);
+
   /// @brief Get raw parameter value (unnormalized)
   ///
   /// For internal use only, the user should always get normalized values
@@ -201,8 +231,8 @@ class ParametersManager {
   // No assignment operator for this class
   ParametersManager& operator=(const ParametersManager& right);
 
-  std::set<int> updated_parameters_;  ///< Parameters updated since last call
-                                      ///< to ProcessParameters()
+  unsigned int updated_parameters_;  ///< Parameters updated since last call
+                                     ///< to ProcessParameters(), one bit each
   std::array<float, Parameters::kCount> values_;  ///< Parameters value data
   const std::array<ParameterMeta,
                    Parameters::kCount>& metadatas_;  ///< Parameters metadata
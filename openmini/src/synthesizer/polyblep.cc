@@ -0,0 +1,236 @@
+/// @filename polyblep.cc
+/// @brief Block-based polyBLEP generators - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/polyblep.h"
+
+namespace openmini {
+namespace generators {
+
+/// @brief Highest allowed normalized frequency
+static const float kPolyBlepMaxFrequency(0.5f);
+/// @brief Triangle integrator leak, relative to the phase increment:
+/// the integrator loses that much of its value over one period
+static const float kTriangleLeak(0.01f);
+
+/// @brief PolyBLEP residual of a unit rising step happening at phase 0
+///
+/// @param[in]  position    Current phase, within [0.0f ; 1.0f[
+/// @param[in]  step        Phase increment
+static inline float Residual(const float position, const float step) {
+  if (position < step) {
+    const float x(position / step);
+    return x + x - x * x - 1.0f;
+  } else if (position > 1.0f - step) {
+    const float x((position - 1.0f) / step);
+    return x * x + x + x + 1.0f;
+  }
+  return 0.0f;
+}
+
+/// @brief PolyBLEP square, rising at phase 0, falling at the given width
+static inline float Square(const float position,
+                           const float step,
+                           const float width) {
+  const float naive((position < width) ? 1.0f : -1.0f);
+  const float falling_position((position < width) ? position - width + 1.0f
+                                                  : position - width);
+  return naive
+         + Residual(position, step)
+         - Residual(falling_position, step);
+}
+
+/// @brief Naive triangle value, starting at -1.0f on phase 0
+///
+/// The integrated square being half a phase increment late,
+/// so is the returned value
+static inline float Triangle(const float position, const float step) {
+  float late_position(position - 0.5f * step);
+  if (late_position < 0.0f) {
+    late_position += 1.0f;
+  }
+  return (late_position < 0.5f) ? 4.0f * late_position - 1.0f
+                                : 3.0f - 4.0f * late_position;
+}
+
+PolyBlep_Base::PolyBlep_Base(const float phase)
+    : Generator_Base(phase),
+      position_(0.0f),
+      step_(0.0f) {
+  PolyBlep_Base::SetPhase(phase);
+}
+
+PolyBlep_Base::~PolyBlep_Base() {
+  // Nothing to do here for now
+}
+
+void PolyBlep_Base::SetPhase(const float phase) {
+  OPENMINI_ASSERT(phase <= 1.0f);
+  OPENMINI_ASSERT(phase >= -1.0f);
+
+  position_ = 0.5f * (phase + 1.0f);
+  if (position_ >= 1.0f) {
+    position_ -= 1.0f;
+  }
+}
+
+void PolyBlep_Base::SetFrequency(const float frequency) {
+  OPENMINI_ASSERT(frequency >= 0.0f);
+  OPENMINI_ASSERT(frequency <= kPolyBlepMaxFrequency);
+
+  step_ = frequency;
+}
+
+void PolyBlep_Base::ProcessParameters(void) {
+  // Nothing to do here: parameters are applied as soon as they are set
+}
+
+Sample PolyBlep_Base::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void PolyBlep_Base::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  state->position = position_;
+  state->step = step_;
+  state->width = 0.0f;
+  state->integrator = 0.0f;
+}
+
+void PolyBlep_Base::Restore(const State& state) {
+  position_ = state.position;
+  step_ = state.step;
+}
+
+SawtoothPolyBlep::SawtoothPolyBlep(const float phase)
+    : PolyBlep_Base(phase) {
+  // Nothing to do here for now
+}
+
+void SawtoothPolyBlep::Process(float* const output,
+                               const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  float position(position_);
+  const float step(step_);
+  for (unsigned int i(0); i < length; ++i) {
+    // Falling step: the residual is subtracted
+    output[i] = 2.0f * position - 1.0f - Residual(position, step);
+    position += step;
+    if (position >= 1.0f) {
+      position -= 1.0f;
+    }
+  }
+  position_ = position;
+}
+
+PulsePolyBlep::PulsePolyBlep(const float phase)
+    : PolyBlep_Base(phase),
+      width_(0.5f) {
+  // Nothing to do here for now
+}
+
+void PulsePolyBlep::SetPulseWidth(const float width) {
+  OPENMINI_ASSERT(width > 0.0f);
+  OPENMINI_ASSERT(width < 1.0f);
+
+  width_ = width;
+}
+
+void PulsePolyBlep::Snapshot(State* state) const {
+  PolyBlep_Base::Snapshot(state);
+  state->width = width_;
+}
+
+void PulsePolyBlep::Restore(const State& state) {
+  PolyBlep_Base::Restore(state);
+  width_ = state.width;
+}
+
+void PulsePolyBlep::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  float position(position_);
+  const float step(step_);
+  const float width(width_);
+  for (unsigned int i(0); i < length; ++i) {
+    output[i] = Square(position, step, width);
+    position += step;
+    if (position >= 1.0f) {
+      position -= 1.0f;
+    }
+  }
+  position_ = position;
+}
+
+TrianglePolyBlep::TrianglePolyBlep(const float phase)
+    : PolyBlep_Base(phase),
+      integrator_(Triangle(position_, step_)) {
+  // Nothing to do here for now
+}
+
+void TrianglePolyBlep::SetPhase(const float phase) {
+  PolyBlep_Base::SetPhase(phase);
+  integrator_ = Triangle(position_, step_);
+}
+
+void TrianglePolyBlep::SetFrequency(const float frequency) {
+  const float previous_step(step_);
+  PolyBlep_Base::SetFrequency(frequency);
+  // Otherwise the lateness change would be seen as an offset
+  integrator_ += Triangle(position_, step_)
+                 - Triangle(position_, previous_step);
+}
+
+void TrianglePolyBlep::Snapshot(State* state) const {
+  PolyBlep_Base::Snapshot(state);
+  state->integrator = integrator_;
+}
+
+void TrianglePolyBlep::Restore(const State& state) {
+  PolyBlep_Base::Restore(state);
+  integrator_ = state.integrator;
+}
+
+void TrianglePolyBlep::Process(float* const output,
+                               const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  float position(position_);
+  float integrator(integrator_);
+  const float step(step_);
+  // A square going from -1 to 1 rises by 2 over half a period
+  const float gain(4.0f * step);
+  const float decay(1.0f - kTriangleLeak * step);
+  for (unsigned int i(0); i < length; ++i) {
+    integrator = decay * integrator + gain * Square(position, step, 0.5f);
+    output[i] = integrator;
+    position += step;
+    if (position >= 1.0f) {
+      position -= 1.0f;
+    }
+  }
+  position_ = position;
+  integrator_ = integrator;
+}
+
+}  // namespace generators
+}  // namespace openmini
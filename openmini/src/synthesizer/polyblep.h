@@ -0,0 +1,138 @@
+/// @filename polyblep.h
+/// @brief Block-based polyBLEP generators
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_POLYBLEP_H_
+#define OPENMINI_SRC_SYNTHESIZER_POLYBLEP_H_
+
+#include "soundtailor/src/generators/generator_base.h"
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+
+namespace openmini {
+namespace generators {
+
+/// @brief Base class for all polyBLEP generators
+///
+/// Naive waveforms are computed from a phase accumulator, then their
+/// discontinuities are smoothed out by a 2 samples polynomial band-limited
+/// step (polyBLEP) residual.
+/// Their cost is about the naive waveforms one, and they are rendered
+/// by whole blocks: there is only one virtual call per block.
+///
+/// As for SoundTailor generators, the phase is within [-1.0f ; 1.0f] and
+/// the normalized frequency within [0.0f ; 0.5f].
+class PolyBlep_Base : public soundtailor::generators::Generator_Base {
+ public:
+  /// @brief Whole generator state, trivially copyable
+  ///
+  /// Fields unused by the actual generator are left null
+  struct State {
+    float position;  ///< Phase, within [0.0f ; 1.0f[
+    float step;  ///< Phase increment, the normalized frequency
+    float width;  ///< Pulse width, pulse generator only
+    float integrator;  ///< Integrated square, triangle generator only
+  };
+
+  /// @brief Default constructor
+  ///
+  /// @param[in]  phase   Phase to initialize the generator to
+  explicit PolyBlep_Base(const float phase = 0.0f);
+  virtual ~PolyBlep_Base();
+
+  virtual void SetPhase(const float phase);
+  virtual void SetFrequency(const float frequency);
+  virtual void ProcessParameters(void);
+
+  /// @brief Process function for one Sample, @see Process()
+  virtual Sample operator()(void);
+
+  /// @brief Process function for one buffer
+  ///
+  /// @param[out] output    Output buffer to write into
+  /// @param[in]  length    Buffer length
+  virtual void Process(float* const output, const unsigned int length) = 0;
+
+  /// @brief Capture the whole generator state
+  ///
+  /// @param[out] state   State to write into
+  virtual void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// The state must come from a generator of the same type
+  ///
+  /// @param[in]  state   State to restore
+  virtual void Restore(const State& state);
+
+ protected:
+  float position_;  ///< Phase, within [0.0f ; 1.0f[
+  float step_;  ///< Phase increment, the normalized frequency
+};
+
+/// @brief PolyBLEP sawtooth generator
+class SawtoothPolyBlep : public PolyBlep_Base {
+ public:
+  explicit SawtoothPolyBlep(const float phase = 0.0f);
+  virtual void Process(float* const output, const unsigned int length);
+};
+
+/// @brief PolyBLEP pulse generator
+///
+/// The pulse width is the ratio of the period spent on the high state
+class PulsePolyBlep : public PolyBlep_Base {
+ public:
+  explicit PulsePolyBlep(const float phase = 0.0f);
+
+  /// @brief Set the pulse width
+  ///
+  /// @param[in]  width   Pulse width, within ]0.0f ; 1.0f[
+  void SetPulseWidth(const float width);
+
+  virtual void Process(float* const output, const unsigned int length);
+  virtual void Snapshot(State* state) const;
+  virtual void Restore(const State& state);
+
+ private:
+  float width_;  ///< Pulse width
+};
+
+/// @brief PolyBLEP triangle generator: integrated polyBLEP square
+///
+/// The integrator is slightly leaky so that it cannot drift,
+/// it is set to the naive triangle value on each phase change
+class TrianglePolyBlep : public PolyBlep_Base {
+ public:
+  explicit TrianglePolyBlep(const float phase = 0.0f);
+
+  virtual void SetPhase(const float phase);
+  virtual void SetFrequency(const float frequency);
+  virtual void Process(float* const output, const unsigned int length);
+  virtual void Snapshot(State* state) const;
+  virtual void Restore(const State& state);
+
+ private:
+  float integrator_;  ///< Integrated square, the actual output
+};
+
+}  // namespace generators
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_POLYBLEP_H_
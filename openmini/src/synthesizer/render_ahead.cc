@@ -0,0 +1,322 @@
+/// @filename render_ahead.cc
+/// @brief Render synthesizer output ahead of time - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/render_ahead.h"
+
+// std::fill_n, std::min
+#include <algorithm>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include "openmini/src/samplingrate.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Try to give the calling thread a real-time priority
+///
+/// Best effort only: this usually requires specific privileges,
+/// the thread keeps its default priority on failure.
+static void SetRealTimePriority(void) {
+#if defined(__linux__)
+  sched_param parameters;
+  parameters.sched_priority = sched_get_priority_max(SCHED_FIFO) / 2;
+  pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters);
+#endif
+}
+
+RenderAhead::RenderAhead(Synthesizer* synth, const unsigned int lookahead)
+    : synth_(synth),
+      lookahead_(GetNextMultiple(lookahead, kBlockSize)),
+      // Twice the lookahead: the worker never renders into samples
+      // still being copied by the host (@see ProcessAudio())
+      audio_(GetNextPowerOfTwo(2 * lookahead_)),
+      snapshots_(audio_.size() / kBlockSize),
+      silent_blocks_(snapshots_.size(), true),
+      positions_(0),
+      events_(kRenderEventsCapacity),
+      parameters_(),
+      parameters_changed_(0),
+      tail_length_(0),
+      worker_(),
+      idle_period_(0),
+      running_(false),
+      underruns_(0),
+      silent_output_(true) {
+  OPENMINI_ASSERT(synth != nullptr);
+  OPENMINI_ASSERT(lookahead > 0);
+  // Parameters changes are flagged as bits of a single atomic
+  static_assert(Parameters::kCount <= 8 * sizeof(unsigned int),
+                "Too many parameters for the changes bitmask");
+  for (int parameter_id(0); parameter_id < Parameters::kCount;
+       ++parameter_id) {
+    parameters_[parameter_id].store(synth_->GetValue(parameter_id),
+                                    std::memory_order_relaxed);
+  }
+  tail_length_.store(synth_->TailLength(), std::memory_order_relaxed);
+}
+
+RenderAhead::~RenderAhead() {
+  Stop();
+}
+
+void RenderAhead::Start(void) {
+  OPENMINI_ASSERT(!IsRunning());
+
+  // Sleeping half a block once the lookahead is filled
+  idle_period_ = std::chrono::microseconds(static_cast<long long>(  // NOLINT
+    0.5e6 * kBlockSize / SamplingRate::Instance().Get()));
+  ApplyEvents();
+  while (Render() > 0) {
+    // Filling the whole lookahead
+  }
+  running_.store(true, std::memory_order_release);
+  worker_ = std::thread(&RenderAhead::Run, this);
+}
+
+void RenderAhead::Stop(void) {
+  if (!IsRunning()) {
+    return;
+  }
+  running_.store(false, std::memory_order_release);
+  worker_.join();
+  // The synthesizer is brought back to the last sample played
+  const uint64_t positions(positions_.load(std::memory_order_acquire));
+  const uint32_t read(ReadPosition(positions));
+  if (read != WritePosition(positions)) {
+    const uint32_t block_start(GetPrevMultiple(read, kBlockSize));
+    synth_->Restore(SnapshotAt(block_start));
+    float dropped[kBlockSize];
+    if (read != block_start) {
+      synth_->ProcessAudio(&dropped[0], read - block_start);
+    }
+  }
+  // Events not taken into account by the worker yet are not lost
+  ApplyEvents();
+  // Dropping all rendered samples
+  positions_.store(Pack(0, 0), std::memory_order_release);
+}
+
+bool RenderAhead::IsRunning(void) const {
+  return running_.load(std::memory_order_acquire);
+}
+
+void RenderAhead::ProcessAudio(float* const output,
+                               const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  // Claiming samples before copying them: from then on the worker
+  // can not rewind over them
+  uint64_t positions(positions_.load(std::memory_order_acquire));
+  uint32_t read(0);
+  unsigned int count(0);
+  do {
+    read = ReadPosition(positions);
+    count = std::min(length, WritePosition(positions) - read);
+  } while (!positions_.compare_exchange_weak(positions,
+                                             Pack(read + count,
+                                                  WritePosition(positions)),
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire));
+  const unsigned int capacity(static_cast<unsigned int>(audio_.size()));
+  const unsigned int offset(read & (capacity - 1));
+  const unsigned int right_count(std::min(count, capacity - offset));
+  std::copy_n(&audio_[offset], right_count, output);
+  std::copy_n(&audio_[0], count - right_count, &output[right_count]);
+  if (count < length) {
+    underruns_.fetch_add(1, std::memory_order_relaxed);
+    std::fill_n(&output[count], length - count, 0.0f);
+  }
+  // Flags were written along with the blocks, before they were published
+  const uint32_t block_start(GetPrevMultiple(read, kBlockSize));
+  silent_output_ = true;
+  for (uint32_t offset(0);
+       offset < read - block_start + count;
+       offset += kBlockSize) {
+    silent_output_ = silent_output_ && SilentBlockAt(block_start + offset);
+  }
+}
+
+bool RenderAhead::IsOutputSilent(void) const {
+  return silent_output_;
+}
+
+bool RenderAhead::NoteOn(const unsigned int note) {
+  const RenderEvent event = {RenderEvent::kNoteOn, note};
+  return events_.Push(&event, 1) == 1;
+}
+
+bool RenderAhead::NoteOff(const unsigned int note) {
+  const RenderEvent event = {RenderEvent::kNoteOff, note};
+  return events_.Push(&event, 1) == 1;
+}
+
+void RenderAhead::SetValue(const int parameter_id, const float value) {
+  OPENMINI_ASSERT(parameter_id >= 0);
+  OPENMINI_ASSERT(parameter_id < Parameters::kCount);
+
+  parameters_[parameter_id].store(value, std::memory_order_relaxed);
+  // Release: the value is visible before the flag
+  parameters_changed_.fetch_or(1u << parameter_id, std::memory_order_release);
+}
+
+float RenderAhead::GetValue(const int parameter_id) const {
+  OPENMINI_ASSERT(parameter_id >= 0);
+  OPENMINI_ASSERT(parameter_id < Parameters::kCount);
+
+  return parameters_[parameter_id].load(std::memory_order_relaxed);
+}
+
+unsigned int RenderAhead::TailLength(void) const {
+  return tail_length_.load(std::memory_order_relaxed);
+}
+
+unsigned int RenderAhead::Available(void) const {
+  const uint64_t positions(positions_.load(std::memory_order_acquire));
+  return WritePosition(positions) - ReadPosition(positions);
+}
+
+unsigned int RenderAhead::Latency(void) const {
+  return kBlockSize;
+}
+
+unsigned int RenderAhead::UnderrunsCount(void) const {
+  return underruns_.load(std::memory_order_relaxed);
+}
+
+void RenderAhead::Run(void) {
+  SetRealTimePriority();
+  while (running_.load(std::memory_order_acquire)) {
+    if (HasEvents()) {
+      Rewind();
+      ApplyEvents();
+    }
+    if (0 == Render()) {
+      std::this_thread::sleep_for(idle_period_);
+    }
+  }
+}
+
+bool RenderAhead::HasEvents(void) const {
+  return (parameters_changed_.load(std::memory_order_relaxed) != 0)
+         || (events_.ReadAvailable() > 0);
+}
+
+void RenderAhead::ApplyEvents(void) {
+  // Parameters first: notes have to be played with the latest ones
+  const unsigned int changed(
+    parameters_changed_.exchange(0, std::memory_order_acquire));
+  if (changed != 0) {
+    for (int parameter_id(0); parameter_id < Parameters::kCount;
+         ++parameter_id) {
+      if ((changed >> parameter_id) & 1u) {
+        synth_->SetValue(
+          parameter_id,
+          parameters_[parameter_id].load(std::memory_order_relaxed));
+      }
+    }
+  }
+  RenderEvent event;
+  while (events_.Pop(&event, 1) > 0) {
+    switch (event.type) {
+      case(RenderEvent::kNoteOn): {
+        synth_->NoteOn(event.note);
+        break;
+      }
+      case(RenderEvent::kNoteOff): {
+        synth_->NoteOff(event.note);
+        break;
+      }
+      default: {
+        // Should never happen
+        OPENMINI_ASSERT(false);
+      }
+    }
+  }
+  // Parameters may also have been restored by a rewind
+  tail_length_.store(synth_->TailLength(), std::memory_order_relaxed);
+}
+
+void RenderAhead::Rewind(void) {
+  uint64_t positions(positions_.load(std::memory_order_acquire));
+  uint32_t rewind_to(0);
+  do {
+    // The write position is always a block boundary, hence never
+    // before the first one following the read position
+    rewind_to = GetNextMultiple(ReadPosition(positions), kBlockSize);
+  } while (!positions_.compare_exchange_weak(
+             positions,
+             Pack(ReadPosition(positions), rewind_to),
+             std::memory_order_acq_rel,
+             std::memory_order_acquire));
+  // Nothing to drop if nothing was rendered after the rewind point
+  if (rewind_to != WritePosition(positions)) {
+    synth_->Restore(SnapshotAt(rewind_to));
+  }
+}
+
+unsigned int RenderAhead::Render(void) {
+  uint64_t positions(positions_.load(std::memory_order_acquire));
+  const uint32_t write(WritePosition(positions));
+  if (write - ReadPosition(positions) + kBlockSize > lookahead_) {
+    return 0;
+  }
+  // Blocks never cross the ring end
+  synth_->Snapshot(&SnapshotAt(write));
+  const unsigned int capacity(static_cast<unsigned int>(audio_.size()));
+  synth_->ProcessAudio(&audio_[write & (capacity - 1)], kBlockSize);
+  SilentBlockAt(write) = synth_->IsOutputSilent();
+  // Only the read position may have changed meanwhile
+  while (!positions_.compare_exchange_weak(
+           positions,
+           Pack(ReadPosition(positions), write + kBlockSize),
+           std::memory_order_acq_rel,
+           std::memory_order_acquire)) {
+  }
+  return kBlockSize;
+}
+
+uint64_t RenderAhead::Pack(const uint32_t read, const uint32_t write) {
+  return (static_cast<uint64_t>(read) << 32) | write;
+}
+
+uint32_t RenderAhead::ReadPosition(const uint64_t positions) {
+  return static_cast<uint32_t>(positions >> 32);
+}
+
+uint32_t RenderAhead::WritePosition(const uint64_t positions) {
+  return static_cast<uint32_t>(positions);
+}
+
+Synthesizer::State& RenderAhead::SnapshotAt(const uint32_t position) {
+  OPENMINI_ASSERT(IsMultipleOf(position, kBlockSize));
+  return snapshots_[(position / kBlockSize) % snapshots_.size()];
+}
+
+char& RenderAhead::SilentBlockAt(const uint32_t position) {
+  return silent_blocks_[(position / kBlockSize) % silent_blocks_.size()];
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
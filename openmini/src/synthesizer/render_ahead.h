@@ -0,0 +1,232 @@
+/// @filename render_ahead.h
+/// @brief Render synthesizer output ahead of time on a worker thread
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_RENDER_AHEAD_H_
+#define OPENMINI_SRC_SYNTHESIZER_RENDER_AHEAD_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+// uint32_t, uint64_t
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/spsc_ringbuffer.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Note event forwarded from the host to the rendering thread
+struct RenderEvent {
+  /// @brief Event types
+  enum Type {
+    kNoteOn = 0,
+    kNoteOff
+  };
+  Type type;  ///< Event type
+  unsigned int note;  ///< Note to trig
+};
+
+/// @brief Note events count which may be pending at once
+static const unsigned int kRenderEventsCapacity(1024);
+
+/// @brief Renders a synthesizer on a dedicated worker thread,
+/// up to a fixed lookahead ahead of the host
+///
+/// Once started, the worker thread is the only one to touch the synthesizer:
+/// notes are forwarded to it through a lock-free queue, parameters through
+/// atomic values and flags, rendered audio comes back through a ring.
+/// Notes are expected from a single thread (the audio one)
+/// while parameters may be changed from any thread.
+/// The host audio callback (ProcessAudio) then only is a copy, and momentary
+/// starvation of the host callback is absorbed by the lookahead.
+///
+/// The synthesizer state is captured before rendering each block.
+/// On any event the worker invalidates the samples not played yet:
+/// it restores the state of the first block the host did not start reading,
+/// applies the events and renders again from there.
+/// Events are hence delayed by at most one block (@see Latency()),
+/// not by the lookahead.
+///
+/// The ring read and write positions are packed into a single atomic:
+/// the host claims samples and the worker rewinds with the same
+/// compare-and-swap, so that a claimed sample is never rendered again.
+///
+/// RenderAhead render_ahead(&synth, lookahead);
+/// render_ahead.Start();
+/// (audio thread)
+/// render_ahead.NoteOn(note);
+/// render_ahead.ProcessAudio(output, length);
+/// (when done)
+/// render_ahead.Stop();
+class RenderAhead {
+ public:
+  /// @brief Default constructor
+  ///
+  /// The synthesizer has to be prepared (sampling rate, max block size)
+  /// before being used here.
+  ///
+  /// @param[in]  synth       Synthesizer to render
+  /// @param[in]  lookahead   Amount of samples rendered ahead
+  RenderAhead(Synthesizer* synth, const unsigned int lookahead);
+  ~RenderAhead();
+
+  /// @brief Render the whole lookahead on the calling thread,
+  /// then start the worker thread
+  void Start(void);
+
+  /// @brief Stop the worker thread, then apply pending events
+  ///
+  /// Rendered samples not yet retrieved are dropped, the synthesizer
+  /// is brought back to the state following the last retrieved sample.
+  void Stop(void);
+
+  /// @brief Check if the worker thread is running
+  bool IsRunning(void) const;
+
+  /// @brief (Audio thread) Retrieve already rendered samples
+  ///
+  /// If not enough samples are available the output is zero-padded
+  /// and an underrun is counted.
+  ///
+  /// @param[out]   output      Output buffer to write into
+  /// @param[in]    length      Output buffer length
+  void ProcessAudio(float* const output, const unsigned int length);
+
+  /// @brief (Audio thread) Check if the last ProcessAudio() output
+  /// was only zeros, @see Synthesizer::IsOutputSilent()
+  ///
+  /// Samples are flagged per rendered block.
+  bool IsOutputSilent(void) const;
+
+  /// @brief (Audio thread) Forward a note on
+  ///
+  /// @return false if the event could not be queued
+  bool NoteOn(const unsigned int note);
+
+  /// @brief (Audio thread) Forward a note off
+  ///
+  /// @return false if the event could not be queued
+  bool NoteOff(const unsigned int note);
+
+  /// @brief (Any thread) Forward a parameter change
+  ///
+  /// Only the last value set before the worker processes it is applied.
+  ///
+  /// @param[in]   parameter_id     ID of the parameter to be changed
+  /// @param[in]   value            Normalized value to set the parameter to
+  void SetValue(const int parameter_id, const float value);
+
+  /// @brief (Any thread) Retrieve the last value set for a parameter
+  ///
+  /// The synthesizer itself belongs to the worker thread while running:
+  /// this is the value to report to the host.
+  ///
+  /// @param[in]   parameter_id     ID of the parameter to be retrieved
+  float GetValue(const int parameter_id) const;
+
+  /// @brief (Any thread) Synthesizer tail length, @see
+  /// Synthesizer::TailLength()
+  ///
+  /// The synthesizer itself belongs to the worker thread while running:
+  /// this is the tail as of the last events it applied.
+  unsigned int TailLength(void) const;
+
+  /// @brief (Audio thread) Count of rendered samples ready to be retrieved
+  unsigned int Available(void) const;
+
+  /// @brief Max delay applied to events, in samples
+  ///
+  /// Events are applied on the next block boundary the host did not
+  /// reach yet, once the worker noticed them.
+  unsigned int Latency(void) const;
+
+  /// @brief Count of ProcessAudio() calls which could not be fully served
+  unsigned int UnderrunsCount(void) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  RenderAhead(const RenderAhead& right);
+  RenderAhead& operator=(const RenderAhead& right);
+
+  /// @brief Worker thread loop
+  void Run(void);
+
+  /// @brief Check if any event is waiting to be applied
+  bool HasEvents(void) const;
+
+  /// @brief Apply all pending events to the synthesizer
+  void ApplyEvents(void);
+
+  /// @brief Drop the samples not claimed by the host yet, from the first
+  /// block boundary on, and restore the synthesizer state there
+  void Rewind(void);
+
+  /// @brief Render one block if the lookahead is not filled yet
+  ///
+  /// @return the count of rendered samples
+  unsigned int Render(void);
+
+  /// @brief Pack read and write positions into a single word
+  static uint64_t Pack(const uint32_t read, const uint32_t write);
+
+  /// @brief Retrieve the read position from packed positions
+  static uint32_t ReadPosition(const uint64_t positions);
+
+  /// @brief Retrieve the write position from packed positions
+  static uint32_t WritePosition(const uint64_t positions);
+
+  /// @brief Snapshot slot holding the state at the given block start
+  Synthesizer::State& SnapshotAt(const uint32_t position);
+
+  /// @brief Silence flag of the block holding the given position
+  char& SilentBlockAt(const uint32_t position);
+
+  Synthesizer* synth_;  ///< Rendered synthesizer
+  const unsigned int lookahead_;  ///< Amount of samples rendered ahead,
+                                  ///< rounded up to a whole blocks count
+  std::vector<float> audio_;  ///< Rendered audio ring
+  std::vector<Synthesizer::State> snapshots_;  ///< Synthesizer state
+                                               ///< before each block
+  /// @brief True for each block rendered as only zeros
+  /// (not std::vector<bool>, its elements are not separate objects)
+  std::vector<char> silent_blocks_;
+  std::atomic<uint64_t> positions_;  ///< Absolute read and write positions
+                                     ///< (modulo 2^32) in the audio ring
+  SpscRingBuffer<RenderEvent> events_;  ///< Host to worker note events
+  std::array<std::atomic<float>, Parameters::kCount> parameters_;  ///< Last
+                                                     ///< set parameter values
+  std::atomic<unsigned int> parameters_changed_;  ///< One bit per parameter
+  std::atomic<unsigned int> tail_length_;  ///< Last computed tail length
+  std::thread worker_;  ///< Rendering thread
+  std::chrono::microseconds idle_period_;  ///< Worker sleep duration
+                                           ///< once the lookahead is filled
+  std::atomic<bool> running_;  ///< Rendering thread should keep going
+  std::atomic<unsigned int> underruns_;  ///< Underruns count
+  bool silent_output_;  ///< True if the last output was only zeros
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_RENDER_AHEAD_H_
@@ -0,0 +1,419 @@
+/// @filename render_cache.cc
+/// @brief Content-addressed render cache - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/render_cache.h"
+
+// std::stable_sort
+#include <algorithm>
+// std::remove, std::rename, std::snprintf, std::sscanf
+#include <cstdio>
+// std::memcmp, std::memcpy
+#include <cstring>
+#include <fstream>
+// std::pair
+#include <utility>
+
+#if (defined(__unix__) || defined(__APPLE__))
+  #define _USE_POSIX_STORE 1
+  #include <dirent.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #include <utime.h>
+#else
+  #define _USE_POSIX_STORE 0
+#endif
+
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Renders files extension
+static const char kRenderExtension[] = ".render";
+
+/// @brief Renders files name length: 16 hexadecimal digits and the extension
+static const size_t kRenderNameLength(16 + sizeof(kRenderExtension) - 1);
+
+/// @brief FNV-1a 64 bits offset basis
+static const uint64_t kFnvOffsetBasis(14695981039346656037ULL);
+
+/// @brief FNV-1a 64 bits prime
+static const uint64_t kFnvPrime(1099511628211ULL);
+
+/// @brief Hash the given value, FNV-1a fashion
+///
+/// @param[in]      value   Value to hash
+/// @param[in,out]  hash    Hash to update
+template <typename TypeValue>
+static void Hash(const TypeValue value, uint64_t* const hash) {
+  unsigned char bytes[sizeof(value)];
+  std::memcpy(&bytes[0], &value, sizeof(value));
+  for (const unsigned char byte : bytes) {
+    *hash = (*hash ^ byte) * kFnvPrime;
+  }
+}
+
+/// @brief Quantize a normalized value to 16 bits
+static uint32_t Quantize(const float value) {
+  return static_cast<uint32_t>(Round(value * 65535.0f));
+}
+
+/// @brief Renders files identifier ("OMRC")
+static const uint32_t kRenderMagic(0x43524d4f);
+
+/// @brief Renders files version: to be bumped on any change of their layout
+/// or of the rendering itself, already stored renders then being misses
+static const uint32_t kRenderVersion(1);
+
+/// @brief Renders files header, followed by the render inputs
+/// then by the rendered samples
+struct RenderHeader {
+  uint32_t magic;  ///< Renders files identifier
+  uint32_t version;  ///< Renders files version
+  uint32_t inputs_count;  ///< Render inputs count
+  uint32_t length;  ///< Render length, in samples
+};
+
+/// @brief Size of a render file
+///
+/// @param[in]  inputs_count  Render inputs count
+/// @param[in]  length        Render length, in samples
+static size_t FileSize(const size_t inputs_count, const size_t length) {
+  return sizeof(RenderHeader)
+         + inputs_count * sizeof(uint32_t)
+         + length * sizeof(float);
+}
+
+/// @brief Check a render file against the expected render inputs
+///
+/// @param[in]  data      Render file content
+/// @param[in]  size      Render file size, in bytes
+/// @param[in]  inputs    Expected render inputs
+///
+/// @return the render length in samples, 0 if the file does not match
+static unsigned int CheckFile(const unsigned char* const data,
+                              const size_t size,
+                              const std::vector<uint32_t>& inputs) {
+  RenderHeader header;
+  if (size < sizeof(header)) {
+    return 0;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if ((header.magic != kRenderMagic)
+      || (header.version != kRenderVersion)
+      || (header.inputs_count != inputs.size())
+      || (size != FileSize(header.inputs_count, header.length))
+      || (std::memcmp(&data[sizeof(header)],
+                      &inputs[0],
+                      inputs.size() * sizeof(uint32_t)) != 0)) {
+    return 0;
+  }
+  return header.length;
+}
+
+RenderCache::RenderCache(const std::string& directory, const size_t capacity)
+    : directory_(directory),
+      capacity_(capacity),
+      size_(0),
+      lru_(),
+      entries_(),
+      hits_(0),
+      misses_(0) {
+  OPENMINI_ASSERT(!directory.empty());
+  OPENMINI_ASSERT(capacity > 0);
+#if (_USE_POSIX_STORE)
+  // Already existing directories are fine
+  mkdir(directory_.c_str(), 0755);
+#endif  // (_USE_POSIX_STORE)
+  Scan();
+  Evict(0);
+}
+
+RenderCache::~RenderCache() {
+  // Nothing to do here for now
+}
+
+bool RenderCache::Render(const ParametersManager& patch,
+                         const std::vector<OfflineEvent>& events,
+                         const unsigned int length,
+                         const float sampling_rate,
+                         std::vector<float>* output) {
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(length > 0);
+
+  const std::vector<uint32_t> inputs(DescribeInputs(patch,
+                                                    events,
+                                                    length,
+                                                    sampling_rate));
+  const uint64_t key(ComputeKey(inputs));
+  if (Fetch(key, inputs, output)) {
+    return true;
+  }
+
+  // The patch is applied as parameters events, before everything else
+  std::vector<OfflineEvent> patched_events;
+  for (unsigned int param_id(0);
+       param_id < patch.ParametersCount();
+       ++param_id) {
+    patched_events.push_back({0,
+                              OfflineEvent::kParameter,
+                              static_cast<int>(param_id),
+                              patch.GetValue(param_id)});
+  }
+  patched_events.insert(patched_events.end(), events.begin(), events.end());
+  // One checkpoint only: there will be no re-rendering
+  OfflineRenderer renderer(sampling_rate,
+                           static_cast<float>(length) / sampling_rate);
+  renderer.Render(patched_events, length);
+  *output = renderer.Output();
+  Store(key, inputs, &(*output)[0], length);
+  return false;
+}
+
+bool RenderCache::Fetch(const uint64_t key,
+                        const std::vector<uint32_t>& inputs,
+                        std::vector<float>* output) {
+  OPENMINI_ASSERT(!inputs.empty());
+  OPENMINI_ASSERT(output != nullptr);
+
+  std::unordered_map<uint64_t, Entry>::iterator entry(entries_.find(key));
+  if (entry == entries_.end()) {
+    misses_ += 1;
+    return false;
+  }
+  bool found(false);
+#if (_USE_POSIX_STORE)
+  const std::string path(Path(key));
+  const int file(open(path.c_str(), O_RDONLY));
+  if (file >= 0) {
+    const size_t size(entry->second.size);
+    void* const mapped(mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0));
+    if (mapped != MAP_FAILED) {
+      const unsigned char* const data(static_cast<unsigned char*>(mapped));
+      const unsigned int length(CheckFile(data, size, inputs));
+      if (length > 0) {
+        output->resize(length);
+        std::memcpy(&(*output)[0],
+                    &data[FileSize(inputs.size(), 0)],
+                    length * sizeof(float));
+        // Keeping track of recency across runs
+        utime(path.c_str(), nullptr);
+        found = true;
+      } else {
+        // Stale render, or another one sharing the same key
+        std::remove(path.c_str());
+      }
+      munmap(mapped, size);
+    }
+    close(file);
+  }
+#endif  // (_USE_POSIX_STORE)
+  if (!found) {
+    // Removed behind our back, or not matching
+    size_ -= entry->second.size;
+    lru_.erase(entry->second.lru_position);
+    entries_.erase(entry);
+    misses_ += 1;
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry->second.lru_position);
+  hits_ += 1;
+  return true;
+}
+
+void RenderCache::Store(const uint64_t key,
+                        const std::vector<uint32_t>& inputs,
+                        const float* const data,
+                        const unsigned int length) {
+  OPENMINI_ASSERT(!inputs.empty());
+  OPENMINI_ASSERT(data != nullptr);
+  OPENMINI_ASSERT(length > 0);
+
+  const size_t size(FileSize(inputs.size(), length));
+  if ((size > capacity_) || (entries_.count(key) > 0)) {
+    return;
+  }
+#if (_USE_POSIX_STORE)
+  Evict(size);
+  // Written aside then renamed: a render file is always complete
+  const std::string path(Path(key));
+  const std::string temporary_path(path + ".tmp");
+  {
+    std::ofstream file(temporary_path.c_str(),
+                       std::ios::binary | std::ios::trunc);
+    const RenderHeader header = {
+      kRenderMagic,
+      kRenderVersion,
+      static_cast<uint32_t>(inputs.size()),
+      length
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&inputs[0]),
+               inputs.size() * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(data), length * sizeof(float));
+    if (!file.good()) {
+      std::remove(temporary_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return;
+  }
+  lru_.push_front(key);
+  const Entry entry = {lru_.begin(), size};
+  entries_.insert({key, entry});
+  size_ += size;
+#endif  // (_USE_POSIX_STORE)
+}
+
+void RenderCache::Clear(void) {
+  for (const uint64_t key : lru_) {
+    std::remove(Path(key).c_str());
+  }
+  lru_.clear();
+  entries_.clear();
+  size_ = 0;
+}
+
+unsigned int RenderCache::Hits(void) const {
+  return hits_;
+}
+
+unsigned int RenderCache::Misses(void) const {
+  return misses_;
+}
+
+double RenderCache::HitRate(void) const {
+  const unsigned int total(hits_ + misses_);
+  return (total > 0) ? static_cast<double>(hits_) / total : 0.0;
+}
+
+unsigned int RenderCache::Count(void) const {
+  return static_cast<unsigned int>(entries_.size());
+}
+
+size_t RenderCache::Size(void) const {
+  return size_;
+}
+
+std::vector<uint32_t> RenderCache::DescribeInputs(
+    const ParametersManager& patch,
+    const std::vector<OfflineEvent>& events,
+    const unsigned int length,
+    const float sampling_rate) {
+  std::vector<uint32_t> inputs;
+  for (unsigned int param_id(0);
+       param_id < patch.ParametersCount();
+       ++param_id) {
+    inputs.push_back(Quantize(patch.GetValue(param_id)));
+  }
+  // Same order as rendered: timelines listed differently share their renders
+  std::vector<OfflineEvent> sorted_events(events);
+  std::stable_sort(sorted_events.begin(),
+                   sorted_events.end(),
+                   [](const OfflineEvent& left, const OfflineEvent& right) {
+                     return left.position < right.position;
+                   });
+  for (const OfflineEvent& event : sorted_events) {
+    inputs.push_back(event.position);
+    inputs.push_back(static_cast<uint32_t>(event.type));
+    inputs.push_back(static_cast<uint32_t>(event.id));
+    inputs.push_back((event.type == OfflineEvent::kParameter)
+                     ? Quantize(event.value)
+                     : 0);
+  }
+  inputs.push_back(length);
+  uint32_t sampling_rate_bits(0);
+  static_assert(sizeof(sampling_rate_bits) == sizeof(sampling_rate),
+                "Unexpected float size");
+  std::memcpy(&sampling_rate_bits, &sampling_rate, sizeof(sampling_rate));
+  inputs.push_back(sampling_rate_bits);
+  return inputs;
+}
+
+uint64_t RenderCache::ComputeKey(const std::vector<uint32_t>& inputs) {
+  uint64_t hash(kFnvOffsetBasis);
+  for (const uint32_t input : inputs) {
+    Hash(input, &hash);
+  }
+  return hash;
+}
+
+void RenderCache::Scan(void) {
+#if (_USE_POSIX_STORE)
+  DIR* const directory(opendir(directory_.c_str()));
+  if (nullptr == directory) {
+    return;
+  }
+  // Oldest first, so that the most recently used end up in front
+  std::vector<std::pair<time_t, std::pair<uint64_t, size_t>>> found;
+  while (const dirent* const item = readdir(directory)) {
+    const std::string name(item->d_name);
+    unsigned long long key(0);  // NOLINT
+    if ((name.size() != kRenderNameLength)
+        || (name.compare(16, std::string::npos, kRenderExtension) != 0)
+        || (std::sscanf(name.c_str(), "%16llx", &key) != 1)) {
+      continue;
+    }
+    struct stat status;
+    if (stat((directory_ + "/" + name).c_str(), &status) == 0) {
+      found.push_back({status.st_mtime,
+                       {static_cast<uint64_t>(key),
+                        static_cast<size_t>(status.st_size)}});
+    }
+  }
+  closedir(directory);
+  std::stable_sort(found.begin(), found.end());
+  for (const auto& item : found) {
+    lru_.push_front(item.second.first);
+    const Entry entry = {lru_.begin(), item.second.second};
+    entries_.insert({item.second.first, entry});
+    size_ += item.second.second;
+  }
+#endif  // (_USE_POSIX_STORE)
+}
+
+void RenderCache::Evict(const size_t size) {
+  while ((size_ + size > capacity_) && !lru_.empty()) {
+    const uint64_t key(lru_.back());
+    std::remove(Path(key).c_str());
+    std::unordered_map<uint64_t, Entry>::iterator entry(entries_.find(key));
+    OPENMINI_ASSERT(entry != entries_.end());
+    size_ -= entry->second.size;
+    entries_.erase(entry);
+    lru_.pop_back();
+  }
+}
+
+std::string RenderCache::Path(const uint64_t key) const {
+  char name[kRenderNameLength + 1];
+  std::snprintf(name,
+                sizeof(name),
+                "%016llx%s",
+                static_cast<unsigned long long>(key),  // NOLINT
+                kRenderExtension);
+  return directory_ + "/" + name;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
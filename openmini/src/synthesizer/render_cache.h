@@ -0,0 +1,180 @@
+/// @filename render_cache.h
+/// @brief Content-addressed render cache
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_RENDER_CACHE_H_
+#define OPENMINI_SRC_SYNTHESIZER_RENDER_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "openmini/src/synthesizer/offline_renderer.h"
+#include "openmini/src/synthesizer/parameters_manager.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Content-addressed render cache
+///
+/// Renders are keyed by a hash of the patch (quantized parameters),
+/// the events timeline, the render length and the sampling rate.
+/// They are stored into an on-disk directory, one file per render,
+/// read back through memory mapping: identical renders become file reads.
+/// Each file starts with a header holding the file format and rendering
+/// version, and all the (quantized) render inputs: a file is only used
+/// if they all match, hash collisions and stale renders being misses.
+///
+/// Least recently used renders are evicted once the given size cap
+/// is reached. Renders already within the directory are picked up
+/// on construction, so that the cache persists across runs.
+///
+/// The on-disk store relies on POSIX (mmap, opendir); on other platforms
+/// the cache is disabled: each render is a miss, and nothing is stored.
+///
+/// This class is not thread-safe.
+class RenderCache {
+ public:
+  /// @brief Default constructor
+  ///
+  /// @param[in]  directory   Directory to store renders into,
+  ///                         created if missing
+  /// @param[in]  capacity    Size cap of all stored renders files, in bytes
+  RenderCache(const std::string& directory, const size_t capacity);
+  ~RenderCache();
+
+  /// @brief Render the given timeline with the given patch,
+  /// from the cache if available
+  ///
+  /// @param[in]  patch           Parameters to render with
+  /// @param[in]  events          Timeline events, in any order
+  /// @param[in]  length          Render length, in samples
+  /// @param[in]  sampling_rate   Render sampling rate
+  /// @param[out] output          Rendered output, resized to the length
+  ///
+  /// @return true if the render came from the cache
+  bool Render(const ParametersManager& patch,
+              const std::vector<OfflineEvent>& events,
+              const unsigned int length,
+              const float sampling_rate,
+              std::vector<float>* output);
+
+  /// @brief Retrieve a stored render
+  ///
+  /// @param[in]  key       Render key, @see ComputeKey()
+  /// @param[in]  inputs    Render inputs the key was computed from,
+  ///                       @see DescribeInputs()
+  /// @param[out] output    Stored render
+  ///
+  /// @return true if the render was found with the very same inputs
+  bool Fetch(const uint64_t key,
+             const std::vector<uint32_t>& inputs,
+             std::vector<float>* output);
+
+  /// @brief Store a render, evicting least recently used ones if required
+  ///
+  /// Renders bigger than the whole cache are not stored.
+  ///
+  /// @param[in]  key       Render key, @see ComputeKey()
+  /// @param[in]  inputs    Render inputs the key was computed from,
+  ///                       @see DescribeInputs()
+  /// @param[in]  data      Render to store
+  /// @param[in]  length    Render length, in samples
+  void Store(const uint64_t key,
+             const std::vector<uint32_t>& inputs,
+             const float* const data,
+             const unsigned int length);
+
+  /// @brief Remove all stored renders
+  void Clear(void);
+
+  /// @brief Count of renders found into the cache
+  unsigned int Hits(void) const;
+
+  /// @brief Count of renders not found into the cache
+  unsigned int Misses(void) const;
+
+  /// @brief Ratio of renders found into the cache, within [0.0 ; 1.0]
+  double HitRate(void) const;
+
+  /// @brief Count of stored renders
+  unsigned int Count(void) const;
+
+  /// @brief Size of all stored renders files, in bytes
+  size_t Size(void) const;
+
+  /// @brief Serialize all render inputs, as they are hashed into its key
+  ///
+  /// Parameters are quantized to 16 bits: patches only differing
+  /// below this precision share their renders.
+  /// Events are sorted as rendered: timelines listed differently
+  /// share their renders.
+  ///
+  /// @param[in]  patch           Parameters to render with
+  /// @param[in]  events          Timeline events, in any order
+  /// @param[in]  length          Render length, in samples
+  /// @param[in]  sampling_rate   Render sampling rate
+  static std::vector<uint32_t> DescribeInputs(
+    const ParametersManager& patch,
+    const std::vector<OfflineEvent>& events,
+    const unsigned int length,
+    const float sampling_rate);
+
+  /// @brief Compute a render key (64 bits FNV-1a hash of its inputs)
+  ///
+  /// @param[in]  inputs    Render inputs, @see DescribeInputs()
+  static uint64_t ComputeKey(const std::vector<uint32_t>& inputs);
+
+ private:
+  // No copy nor assignment operator for this class
+  RenderCache(const RenderCache& right);
+  RenderCache& operator=(const RenderCache& right);
+
+  /// @brief Cache entry: position within the LRU list, and size
+  struct Entry {
+    std::list<uint64_t>::iterator lru_position;  ///< Within lru_
+    size_t size;  ///< File size in bytes
+  };
+
+  /// @brief Pick up renders already within the directory
+  void Scan(void);
+
+  /// @brief Remove least recently used renders until the size fits
+  ///
+  /// @param[in]  size    Size to fit within the cap, in bytes
+  void Evict(const size_t size);
+
+  /// @brief File path of the given render
+  std::string Path(const uint64_t key) const;
+
+  const std::string directory_;  ///< Renders directory
+  const size_t capacity_;  ///< Size cap, in bytes
+  size_t size_;  ///< Size of all stored renders, in bytes
+  std::list<uint64_t> lru_;  ///< Stored renders, most recently used first
+  std::unordered_map<uint64_t, Entry> entries_;  ///< Stored renders
+  unsigned int hits_;  ///< Renders found into the cache
+  unsigned int misses_;  ///< Renders not found into the cache
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_RENDER_CACHE_H_
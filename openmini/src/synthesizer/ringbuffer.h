@@ -1,5 +1,5 @@
 /// @filename ringbuffer.h
-/// @brief Implementation of a simple resizable ringbuffer
+/// @brief Implementation of a simple preallocated ringbuffer
 /// @author gm
 /// @copyright gm 2013
 ///
@@ -21,26 +21,55 @@
 #ifndef OPENMINI_SRC_SYNTHESIZER_RINGBUFFER_H_
 #define OPENMINI_SRC_SYNTHESIZER_RINGBUFFER_H_
 
-#include <array>
+// std::fill, std::copy_n, std::min
+#include <algorithm>
 
 #include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
 
 namespace openmini {
 namespace synthesizer {
 
 /// @brief Simple implementation of a circular buffer
 ///
-/// Resizable, FIFO-type container; its general philosophy is that,
+/// Preallocated, FIFO-type container; its general philosophy is that,
 /// if one operation could not be done (pushing too much data, etc.)
 /// it asserts - there are no return values nor exceptions.
 ///
+/// Its capacity is always a power of two, so that wrapping around is a mask;
+/// reading and writing positions are free-running counters,
+/// their difference being the count of elements held within the buffer.
+///
+/// Memory is only allocated on construction or when explicitly growing
+/// the capacity (@see SetCapacity()), never when pushing or popping:
+/// the capacity has to be set beforehand, outside of the audio thread.
+/// It may also be taken from an arena, in which case it is not owned.
+///
 /// It is asymmetrical: you push in one Sample at a time, and you pop out
-/// as many floats as you want.
-class RingBuffer {
+/// as many elements as you want.
+template <typename TypeValue>
+class RingBuffer final {
  public:
   /// @brief Default constructor: the user may provide a buffer length
-  explicit RingBuffer(const unsigned int capacity = 1);
-  virtual ~RingBuffer();
+  ///
+  /// @param[in]  capacity    Minimal amount of elements to be retrieved
+  /// @param[in]  chunk_size  Elements count pushed at once
+  explicit RingBuffer(const unsigned int capacity = 1,
+                      const unsigned int chunk_size = 1);
+
+  /// @brief Constructor taking its memory from the given arena
+  ///
+  /// Later capacity changes only allocate if growing beyond this one.
+  ///
+  /// @param[in]  arena       Arena to take internal memory from
+  /// @param[in]  capacity    Minimal amount of elements to be retrieved
+  /// @param[in]  chunk_size  Elements count pushed at once
+  RingBuffer(Arena* arena,
+             const unsigned int capacity,
+             const unsigned int chunk_size = 1);
+  ~RingBuffer();
 
   /// @brief Pop elements out of the buffer
   ///
@@ -48,85 +77,294 @@ class RingBuffer {
   ///
   /// @param[out]   dest          Buffer to store the elements into
   /// @param[in]    count         Elements count to retrieve
-  virtual void Pop(float* dest, const unsigned int count);
+  void Pop(TypeValue* dest, const unsigned int count);
 
-  /// @brief Push elements into the buffer
+  /// @brief Copy elements out of the buffer without removing them
   ///
-  /// Specialization for custom Sample type
+  /// Output may be zero-padded if more elements are read than those available
   ///
-  /// @param[in]  src   Sample to push
-  virtual void Push(SampleRead value);
+  /// @param[out]   dest          Buffer to store the elements into
+  /// @param[in]    count         Elements count to retrieve
+  void Peek(TypeValue* dest, const unsigned int count) const;
 
   /// @brief Push elements into the buffer
   ///
-  /// Specialization for custom Sample type
+  /// Specialization for custom Sample type: the Sample is directly stored
+  /// into the buffer, hence it has to be aligned - e.g. everything pushed
+  /// before has to be made of whole Samples.
+  ///
+  /// @param[in]  value   Sample to push
+  void Push(SampleRead value);
+
+  /// @brief Push elements into the buffer
   ///
   /// @param[in]  src   Buffer to push
   /// @param[in]  count   Buffer elements count
-  virtual void Push(const float* const src, const unsigned int count);
+  void Push(const TypeValue* const src, const unsigned int count);
 
   /// @brief Explicitly clear buffer content but does not deallocate it
-  virtual void Clear(void);
+  void Clear(void);
+
+  /// @brief Change the buffer capacity so that it is able to store
+  /// and later retrieve at least "capacity" elements,
+  /// by bits of "chunk_size" elements
+  ///
+  /// Previously stored data is dropped.
+  /// This allocates memory if the current one is not big enough:
+  /// not to be called from within the audio thread!
+  ///
+  /// @param[in]  capacity    Minimal amount of elements to be retrieved
+  /// @param[in]  chunk_size  Elements count pushed at once
+  void SetCapacity(const unsigned int capacity,
+                   const unsigned int chunk_size = 1);
 
   /// @brief Check if the buffer is big enough to store and later retrieve
   /// at least "size" elements, by bits of "chunk_size" elements
   ///
-  /// Resize if this is not the case.
-  virtual void Reserve(unsigned int size, unsigned int chunk_size = 1);
+  /// This never resizes the buffer, it only asserts.
+  void Reserve(const unsigned int size,
+               const unsigned int chunk_size = 1) const;
 
   /// @brief Returns true if the buffer is "usable"
   ///
   /// For now, this means that some memory is allocated
-  virtual bool IsGood(void) const;
+  bool IsGood(void) const;
 
   /// @brief How many elements may be pushed into the buffer
-  virtual unsigned int Capacity(void) const;
+  unsigned int Capacity(void) const;
 
   /// @brief How many elements may be popped from the buffer
-  virtual unsigned int Size(void) const;
+  unsigned int Size(void) const;
 
- protected:
-  /// @brief Change the available count of elements
-  /// that can be retrieved from the buffer
-  ///
-  /// Previously stored data will be copied in it as much as possible;
-  /// in case of room left it will be filled with zeroes
-  ///
-  /// @param[in]  size    New capacity of the container
-  virtual void Resize(const unsigned int size);
+  /// @brief Memory held by the buffer elements, in bytes
+  size_t MemoryUsage(void) const;
+
+  /// @brief Returns false if the elements memory belongs to an arena
+  bool OwnsMemory(void) const;
 
-  /// @brief Compute required elements count in order to be able to output
+  /// @brief Compute the capacity required in order to be able to output
   /// at least "size" elements, by bits of "chunk_size" elements
   ///
   /// @param[in]  size   Minimal amout of elements to be retrieved
-  virtual unsigned int ComputeRequiredElements(
-      unsigned int size,
-      unsigned int chunk_size = 1) const;
+  /// @param[in]  chunk_size  Elements count pushed at once
+  static unsigned int ComputeRequiredElements(const unsigned int size,
+                                              const unsigned int chunk_size);
 
-  /// @brief Compute how much elements can be retrieved with the given number
-  /// of elements
+  /// @brief Arena room required to store "size" elements,
+  /// by bits of "chunk_size" elements
   ///
-  /// @param[in]  size   Count of input elements
-  virtual unsigned int ComputeMaxElements(const unsigned int size) const;
-
-  /// @brief Transfer the data from input to output
-  ///
-  /// This method allows to put some extra "post-copy" operations
-  ///
-  /// @param[in]  in_first, in_last    Range of elements to transfer
-  /// @param[in]  out_first   Beginnning of the output range
-  virtual void TransferData(const float* const in_first,
-                            const float* const in_last,
-                            float* const out_first);
+  /// @param[in]  size   Minimal amout of elements to be retrieved
+  /// @param[in]  chunk_size  Elements count pushed at once
+  static size_t ArenaSize(const unsigned int size,
+                          const unsigned int chunk_size = 1);
 
  private:
-  float* data_;  ///< Internal elements buffer
-  unsigned int capacity_;  ///< Internal buffer length
-  unsigned int size_;  ///< Count of elements currently held within the buffer
+  // No copy nor assignment operator for this class
+  RingBuffer(const RingBuffer& right);
+  RingBuffer& operator=(const RingBuffer& right);
+
+  TypeValue* data_;  ///< Internal elements buffer
+  unsigned int storage_capacity_;  ///< Elements count data_ may hold
+  bool owned_;  ///< False if data_ belongs to an arena
+  unsigned int capacity_;  ///< Internal buffer length, a power of two
+  unsigned int mask_;  ///< Mask applied to positions for wrapping around
   unsigned int writing_position_;  ///< Beginning of the writing part
   unsigned int reading_position_;  ///< Beginning of the reading part
 };
 
+template <typename TypeValue>
+RingBuffer<TypeValue>::RingBuffer(const unsigned int capacity,
+                                  const unsigned int chunk_size)
+    : data_(nullptr),
+      storage_capacity_(0),
+      owned_(true),
+      capacity_(0),
+      mask_(0),
+      writing_position_(0),
+      reading_position_(0) {
+  SetCapacity(capacity, chunk_size);
+}
+
+template <typename TypeValue>
+RingBuffer<TypeValue>::RingBuffer(Arena* arena,
+                                  const unsigned int capacity,
+                                  const unsigned int chunk_size)
+    : data_(nullptr),
+      storage_capacity_(ComputeRequiredElements(capacity, chunk_size)),
+      owned_(false),
+      capacity_(0),
+      mask_(0),
+      writing_position_(0),
+      reading_position_(0) {
+  OPENMINI_ASSERT(arena != nullptr);
+  data_ = arena->Allocate<TypeValue>(storage_capacity_);
+  SetCapacity(capacity, chunk_size);
+}
+
+template <typename TypeValue>
+RingBuffer<TypeValue>::~RingBuffer() {
+  if (owned_) {
+    Deallocate(data_);
+  }
+  data_ = nullptr;
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Pop(TypeValue* dest, const unsigned int count) {
+  Peek(dest, count);
+  reading_position_ += std::min(count, Size());
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Peek(TypeValue* dest,
+                                 const unsigned int count) const {
+  OPENMINI_ASSERT(IsGood());
+
+  // Actual elements count to be copied, the remaining being zero-padded
+  const unsigned int copy_count(std::min(count, Size()));
+  const unsigned int reading_index(reading_position_ & mask_);
+  // Length of the "right" part: from reading cursor to the buffer end
+  const unsigned int right_part_size(std::min(capacity_ - reading_index,
+                                              copy_count));
+  // Length of the "left" part: from the buffer beginning
+  // to the last element to be copied
+  const unsigned int left_part_size(copy_count - right_part_size);
+
+  //  Copy the first part
+  std::copy_n(&data_[reading_index], right_part_size, &dest[0]);
+  //  Copy the second part
+  std::copy_n(&data_[0], left_part_size, &dest[right_part_size]);
+
+  // Zero-padding
+  std::fill_n(&dest[copy_count],
+              count - copy_count,
+              static_cast<TypeValue>(0));
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Push(SampleRead value) {
+  OPENMINI_ASSERT(IsGood());
+  OPENMINI_ASSERT(SampleSize <= Capacity() - Size());
+  // Since the capacity is a power of two (hence a multiple of the sample size)
+  // an aligned Sample never crosses the buffer end
+  OPENMINI_ASSERT(IsMultipleOf(writing_position_, SampleSize));
+
+  VectorMath::Store(&data_[writing_position_ & mask_], value);
+  writing_position_ += SampleSize;
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Push(const TypeValue* const src,
+                                 const unsigned int count) {
+  OPENMINI_ASSERT(IsGood());
+  OPENMINI_ASSERT(count <= Capacity() - Size());
+  const unsigned int writing_index(writing_position_ & mask_);
+  // Length of the "right" part: from writing cursor to the buffer end
+  const unsigned int right_part_size(std::min(capacity_ - writing_index,
+                                              count));
+  // Length of the "left" part: from the buffer beginning
+  // to the last element to be pushed
+  const unsigned int left_part_size(count - right_part_size);
+
+  //  Copy the first part
+  std::copy_n(&src[0], right_part_size, &data_[writing_index]);
+  //  Copy the second part
+  std::copy_n(&src[right_part_size], left_part_size, &data_[0]);
+
+  writing_position_ += count;
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Clear(void) {
+  writing_position_ = 0;
+  reading_position_ = 0;
+  if (IsGood()) {
+    std::fill(&data_[0],
+              &data_[Capacity()],
+              static_cast<TypeValue>(0));
+  }
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::SetCapacity(const unsigned int capacity,
+                                        const unsigned int chunk_size) {
+  OPENMINI_ASSERT(capacity > 0);
+  OPENMINI_ASSERT(chunk_size > 0);
+
+  const unsigned int actual_capacity(ComputeRequiredElements(capacity,
+                                                             chunk_size));
+  // Shrinking reuses the current memory
+  if (actual_capacity > storage_capacity_) {
+    if (owned_) {
+      Deallocate(data_);
+    }
+    data_ = Allocate<TypeValue>(actual_capacity);
+    OPENMINI_ASSERT(data_ != nullptr);
+    storage_capacity_ = actual_capacity;
+    owned_ = true;
+  }
+  capacity_ = actual_capacity;
+  mask_ = actual_capacity - 1;
+  Clear();
+}
+
+template <typename TypeValue>
+void RingBuffer<TypeValue>::Reserve(const unsigned int size,
+                                    const unsigned int chunk_size) const {
+  OPENMINI_ASSERT(IsGood());
+  OPENMINI_ASSERT(ComputeRequiredElements(size, chunk_size) <= Capacity());
+  IGNORE(size);
+  IGNORE(chunk_size);
+}
+
+template <typename TypeValue>
+bool RingBuffer<TypeValue>::IsGood(void) const {
+  return data_ != nullptr;
+}
+
+template <typename TypeValue>
+unsigned int RingBuffer<TypeValue>::Capacity(void) const {
+  OPENMINI_ASSERT(IsGood());
+  return capacity_;
+}
+
+template <typename TypeValue>
+unsigned int RingBuffer<TypeValue>::Size(void) const {
+  OPENMINI_ASSERT(IsGood());
+  return writing_position_ - reading_position_;
+}
+
+template <typename TypeValue>
+size_t RingBuffer<TypeValue>::MemoryUsage(void) const {
+  return storage_capacity_ * sizeof(TypeValue);
+}
+
+template <typename TypeValue>
+bool RingBuffer<TypeValue>::OwnsMemory(void) const {
+  return owned_;
+}
+
+template <typename TypeValue>
+unsigned int RingBuffer<TypeValue>::ComputeRequiredElements(
+    const unsigned int size,
+    const unsigned int chunk_size) {
+  // One needs to take into account the chunk size,
+  // which is at least the sample size
+  const unsigned int actual_chunk_size(Math::Max(chunk_size, SampleSize));
+  // The worst use case is that one:
+  // [chunk_size - 1][...data...][chunk_size - 1]
+  //                 ^ cursor1   ^ cursor2
+  // hence the extra padding
+  return GetNextPowerOfTwo(size + 2 * actual_chunk_size - 1);
+}
+
+template <typename TypeValue>
+size_t RingBuffer<TypeValue>::ArenaSize(const unsigned int size,
+                                        const unsigned int chunk_size) {
+  return Arena::AlignedSize(ComputeRequiredElements(size, chunk_size)
+                            * sizeof(TypeValue));
+}
+
 }  // namespace synthesizer
 }  // namespace openmini
 
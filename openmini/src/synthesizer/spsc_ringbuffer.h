@@ -0,0 +1,269 @@
+/// @filename spsc_ringbuffer.h
+/// @brief Lock-free single producer / single consumer ringbuffer
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_SPSC_RINGBUFFER_H_
+#define OPENMINI_SRC_SYNTHESIZER_SPSC_RINGBUFFER_H_
+
+// std::copy_n, std::min
+#include <algorithm>
+#include <atomic>
+
+#include "openmini/src/common.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Wait-free circular buffer for one producer and one consumer thread
+///
+/// Exactly one thread may call producer methods (Push, GetWriteSpans,
+/// CommitWrite, WriteAvailable) while exactly one other thread calls consumer
+/// methods (Pop, GetReadSpans, CommitRead, ReadAvailable):
+/// no lock is ever taken and no call ever blocks.
+///
+/// Contrary to RingBuffer, pushing or popping more than possible does not
+/// assert: as many elements as possible are transferred,
+/// and their count is returned.
+///
+/// Elements are copied with std::copy, hence should be trivially copyable:
+/// audio samples, Midi or parameters events...
+///
+/// Writing and reading positions are free-running counters,
+/// each on its own cache line along with the data only its owner uses,
+/// so that producer and consumer do not keep stealing each other's lines.
+template <typename TypeValue>
+class SpscRingBuffer final {
+ public:
+  /// @brief Two contiguous parts of the buffer, the second one being used
+  /// only when crossing the buffer end
+  struct Spans {
+    TypeValue* first;  ///< First part beginning
+    unsigned int first_count;  ///< First part elements count
+    TypeValue* second;  ///< Second part beginning (buffer beginning)
+    unsigned int second_count;  ///< Second part elements count
+  };
+
+  /// @brief Default constructor
+  ///
+  /// Memory is only allocated here.
+  ///
+  /// @param[in]  capacity    Minimal amount of elements to be stored
+  explicit SpscRingBuffer(const unsigned int capacity);
+  ~SpscRingBuffer();
+
+  /// @brief (Producer) Push elements into the buffer
+  ///
+  /// @param[in]  src   Buffer to push
+  /// @param[in]  count   Buffer elements count
+  ///
+  /// @return the count of elements actually pushed
+  unsigned int Push(const TypeValue* const src, const unsigned int count);
+
+  /// @brief (Consumer) Pop elements out of the buffer
+  ///
+  /// Nothing is zero-padded, contrary to RingBuffer
+  ///
+  /// @param[out]   dest          Buffer to store the elements into
+  /// @param[in]    count         Elements count to retrieve
+  ///
+  /// @return the count of elements actually popped
+  unsigned int Pop(TypeValue* dest, const unsigned int count);
+
+  /// @brief (Producer) Retrieve the free space, to be written directly
+  ///
+  /// Elements are only made available to the consumer by CommitWrite().
+  ///
+  /// @param[in]  count   Maximum elements count to be written
+  ///
+  /// @return at most "count" elements to be written, in two parts
+  Spans GetWriteSpans(const unsigned int count);
+
+  /// @brief (Producer) Make available the elements written in the spans
+  ///
+  /// @param[in]  count   Elements count written, at most the spans length
+  void CommitWrite(const unsigned int count);
+
+  /// @brief (Consumer) Retrieve the next elements, to be read directly
+  ///
+  /// @param[in]  count   Maximum elements count to be read
+  ///
+  /// @return at most "count" elements to be read, in two parts
+  Spans GetReadSpans(const unsigned int count);
+
+  /// @brief (Consumer) Drop the elements read from the spans
+  ///
+  /// @param[in]  count   Elements count read, at most the spans length
+  void CommitRead(const unsigned int count);
+
+  /// @brief (Producer) How many elements may be pushed into the buffer
+  unsigned int WriteAvailable(void) const;
+
+  /// @brief (Consumer) How many elements may be popped from the buffer
+  unsigned int ReadAvailable(void) const;
+
+  /// @brief Total amount of elements the buffer may hold
+  unsigned int Capacity(void) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  SpscRingBuffer(const SpscRingBuffer& right);
+  SpscRingBuffer& operator=(const SpscRingBuffer& right);
+
+  /// @brief Build the spans for "count" elements starting at "position"
+  Spans MakeSpans(const unsigned int position, const unsigned int count) const;
+
+  // Read-only after construction, shared by both threads
+  TypeValue* data_;  ///< Internal elements buffer
+  unsigned int capacity_;  ///< Internal buffer length, a power of two
+  unsigned int mask_;  ///< Mask applied to positions for wrapping around
+  // Producer-owned
+  alignas(kCacheLineSize) std::atomic<unsigned int> writing_position_;
+  unsigned int cached_reading_position_;  ///< Last seen reading position
+  // Consumer-owned
+  alignas(kCacheLineSize) std::atomic<unsigned int> reading_position_;
+  unsigned int cached_writing_position_;  ///< Last seen writing position
+};
+
+template <typename TypeValue>
+SpscRingBuffer<TypeValue>::SpscRingBuffer(const unsigned int capacity)
+    : data_(nullptr),
+      capacity_(GetNextPowerOfTwo(capacity)),
+      mask_(capacity_ - 1),
+      writing_position_(0),
+      cached_reading_position_(0),
+      reading_position_(0),
+      cached_writing_position_(0) {
+  OPENMINI_ASSERT(capacity > 0);
+  data_ = Allocate<TypeValue>(capacity_);
+  OPENMINI_ASSERT(data_ != nullptr);
+  std::fill(&data_[0], &data_[capacity_], TypeValue());
+}
+
+template <typename TypeValue>
+SpscRingBuffer<TypeValue>::~SpscRingBuffer() {
+  Deallocate(data_);
+  data_ = nullptr;
+}
+
+template <typename TypeValue>
+unsigned int SpscRingBuffer<TypeValue>::Push(const TypeValue* const src,
+                                             const unsigned int count) {
+  const Spans spans(GetWriteSpans(count));
+  std::copy_n(&src[0], spans.first_count, spans.first);
+  std::copy_n(&src[spans.first_count], spans.second_count, spans.second);
+  const unsigned int pushed(spans.first_count + spans.second_count);
+  CommitWrite(pushed);
+  return pushed;
+}
+
+template <typename TypeValue>
+unsigned int SpscRingBuffer<TypeValue>::Pop(TypeValue* dest,
+                                            const unsigned int count) {
+  const Spans spans(GetReadSpans(count));
+  std::copy_n(spans.first, spans.first_count, &dest[0]);
+  std::copy_n(spans.second, spans.second_count, &dest[spans.first_count]);
+  const unsigned int popped(spans.first_count + spans.second_count);
+  CommitRead(popped);
+  return popped;
+}
+
+template <typename TypeValue>
+typename SpscRingBuffer<TypeValue>::Spans
+    SpscRingBuffer<TypeValue>::GetWriteSpans(const unsigned int count) {
+  const unsigned int position(
+    writing_position_.load(std::memory_order_relaxed));
+  unsigned int available(capacity_ - (position - cached_reading_position_));
+  if (available < count) {
+    // Only synchronize with the consumer when the cached value is not enough
+    cached_reading_position_ = reading_position_.load(
+      std::memory_order_acquire);
+    available = capacity_ - (position - cached_reading_position_);
+  }
+  return MakeSpans(position, std::min(count, available));
+}
+
+template <typename TypeValue>
+void SpscRingBuffer<TypeValue>::CommitWrite(const unsigned int count) {
+  const unsigned int position(
+    writing_position_.load(std::memory_order_relaxed));
+  OPENMINI_ASSERT(count <= capacity_ - (position - cached_reading_position_));
+  // Release: written elements are visible before the new position
+  writing_position_.store(position + count, std::memory_order_release);
+}
+
+template <typename TypeValue>
+typename SpscRingBuffer<TypeValue>::Spans
+    SpscRingBuffer<TypeValue>::GetReadSpans(const unsigned int count) {
+  const unsigned int position(
+    reading_position_.load(std::memory_order_relaxed));
+  unsigned int available(cached_writing_position_ - position);
+  if (available < count) {
+    // Only synchronize with the producer when the cached value is not enough
+    cached_writing_position_ = writing_position_.load(
+      std::memory_order_acquire);
+    available = cached_writing_position_ - position;
+  }
+  return MakeSpans(position, std::min(count, available));
+}
+
+template <typename TypeValue>
+void SpscRingBuffer<TypeValue>::CommitRead(const unsigned int count) {
+  const unsigned int position(
+    reading_position_.load(std::memory_order_relaxed));
+  OPENMINI_ASSERT(count <= cached_writing_position_ - position);
+  // Release: elements are read before the producer may overwrite them
+  reading_position_.store(position + count, std::memory_order_release);
+}
+
+template <typename TypeValue>
+unsigned int SpscRingBuffer<TypeValue>::WriteAvailable(void) const {
+  return capacity_
+         - (writing_position_.load(std::memory_order_relaxed)
+            - reading_position_.load(std::memory_order_acquire));
+}
+
+template <typename TypeValue>
+unsigned int SpscRingBuffer<TypeValue>::ReadAvailable(void) const {
+  return writing_position_.load(std::memory_order_acquire)
+         - reading_position_.load(std::memory_order_relaxed);
+}
+
+template <typename TypeValue>
+unsigned int SpscRingBuffer<TypeValue>::Capacity(void) const {
+  return capacity_;
+}
+
+template <typename TypeValue>
+typename SpscRingBuffer<TypeValue>::Spans
+    SpscRingBuffer<TypeValue>::MakeSpans(const unsigned int position,
+                                         const unsigned int count) const {
+  const unsigned int index(position & mask_);
+  const unsigned int first_count(std::min(capacity_ - index, count));
+  const Spans spans = {&data_[index],
+                       first_count,
+                       &data_[0],
+                       count - first_count};
+  return spans;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_SPSC_RINGBUFFER_H_
@@ -18,28 +18,45 @@
 /// You should have received a copy of the GNU General Public License
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
-// std::fill
+// std::fill_n, std::max, std::min
 #include <algorithm>
+// std::ceil
+#include <cmath>
 
 #include "openmini/src/synthesizer/synthesizer.h"
 
 #include "openmini/src/samplingrate.h"
+#include "openmini/src/synthesizer/denormals.h"
 #include "openmini/src/synthesizer/parameters.h"
 #include "openmini/src/synthesizer/synthesizer_common.h"
 
 namespace openmini {
 namespace synthesizer {
 
-/// @brief Default (on startup) expected block size
-static const unsigned int kDefaultBlockSize(512);
+/// @brief Filter output level below which it has rung out (-100dB)
+static const float kSilenceThreshold(1e-5f);
 
-Synthesizer::Synthesizer(const float output_limit)
-    : ParametersManager(Parameters::kParametersMeta),
-      mixer_(),
-      filter_(),
-      modulator_(),
+/// @brief Samples the filter output has to stay below the above threshold
+/// for the synthesizer to go to sleep
+static const unsigned int kSleepHoldSamples(64);
+
+Synthesizer::Synthesizer(const float output_limit,
+                         const unsigned int max_block_size)
+    // Default values are precomputed once for all instances
+    : ParametersManager(Parameters::kParametersMeta,
+                        Parameters::kParametersDefaults),
+      arena_(ArenaSize(max_block_size)),
+      mixer_(&arena_),
+      filter_(&arena_),
+      modulator_(&arena_),
       limiter_(output_limit),
-      buffer_() {
+      buffer_(&arena_, max_block_size),
+      max_block_size_(max_block_size),
+      sampling_rate_(SamplingRate::Instance().Get()),
+      quiet_samples_(0),
+      // Nothing to render before the first note
+      sleeping_(true),
+      silent_output_(true) {
   // Nothing to do here for now
 }
 
@@ -48,17 +65,25 @@ void Synthesizer::ProcessAudio(float* const output,
   OPENMINI_ASSERT(output != nullptr);
   OPENMINI_ASSERT(length > 0);
 
-  // First, zeroing the output
-  std::fill(&output[0], &output[length], 0.0f);
+  // Decaying states would otherwise reach the (slow) denormal range
+  const FlushDenormals flush_denormals;
   ProcessParameters();
 
-  // Resizing the buffer if need be
-  buffer_.Reserve(length);
-
-  while (buffer_.Size() < length) {
-    buffer_.Push(limiter_(modulator_(filter_(mixer_()))));
+  // Nothing pending nor to be rendered: the output is only zeros
+  silent_output_ = sleeping_ && (buffer_.Size() == 0);
+  // No need to zero the output: each element is written by Pop()
+  unsigned int processed(0);
+  while (processed < length) {
+    const unsigned int chunk_length(std::min(length - processed,
+                                             max_block_size_));
+    buffer_.Reserve(chunk_length);
+    while (!sleeping_ && (buffer_.Size() < chunk_length)) {
+      RenderBlock(chunk_length - buffer_.Size());
+    }
+    // When sleeping, pending samples are followed by zeros
+    buffer_.Pop(&output[processed], chunk_length);
+    processed += chunk_length;
   }
-  buffer_.Pop(output, length);
 }
 
 void Synthesizer::NoteOn(const unsigned int note) {
@@ -72,6 +97,8 @@ void Synthesizer::NoteOn(const unsigned int note) {
   filter_.TriggerOn();
   mixer_.NoteOn(note);
   modulator_.TriggerOn();
+  sleeping_ = false;
+  quiet_samples_ = 0;
 }
 
 void Synthesizer::NoteOff(const unsigned int note) {
@@ -89,9 +116,204 @@ void Synthesizer::NoteOff(const unsigned int note) {
 
 void Synthesizer::SetOutputSamplingFrequency(const float freq) {
   SamplingRate::Instance().Set(freq);
+  // Wavetables are built here rather than within the audio thread
+  mixer_.SetSamplingRate(freq);
   // Trigger changes to all parameters in order to take
-  // sampling frequency change into account
-  ParametersManager::ForceParametersProcess();
+  // sampling frequency change into account, if it actually changed
+  // for this instance (e.g. not on the first prepare at the default one)
+  if (freq != sampling_rate_) {
+    ParametersManager::ForceParametersProcess();
+    sampling_rate_ = freq;
+  }
+}
+
+void Synthesizer::SetMaxBlockSize(const unsigned int length) {
+  OPENMINI_ASSERT(length > 0);
+  // Changing the buffer capacity drops its content:
+  // the few pending samples are lost, which is fine at this point.
+  // This only allocates above the block size the arena was sized for
+  buffer_.SetCapacity(length);
+  max_block_size_ = length;
+}
+
+void Synthesizer::SetNoiseSeed(const uint32_t seed) {
+  mixer_.SetNoiseSeed(seed);
+}
+
+bool Synthesizer::IsSleeping(void) const {
+  return sleeping_;
+}
+
+bool Synthesizer::IsOutputSilent(void) const {
+  return silent_output_;
+}
+
+unsigned int Synthesizer::TailLength(void) const {
+  // The filter rings out once the amplitude envelop is released,
+  // from its lowest cutoff: the contour one never goes below it
+  const float ring_out(Vcf::RingOutLength(
+    GetRawValue(Parameters::kFilterFreq),
+    GetRawValue(Parameters::kFilterResonance),
+    kSilenceThreshold));
+  const float tail(
+    static_cast<float>(GetDiscreteValue<unsigned int>(Parameters::kDecayTime))
+    + ring_out
+    + static_cast<float>(kSleepHoldSamples + SampleSize));
+  if (!(tail < static_cast<float>(kInfiniteTail))) {
+    return kInfiniteTail;
+  }
+  return static_cast<unsigned int>(std::ceil(tail));
+}
+
+void Synthesizer::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  // In between two calls to ProcessAudio() there is always less than
+  // one Sample worth of pending output
+  OPENMINI_ASSERT(buffer_.Size() <= SampleSize);
+
+  SnapshotParameters(&state->parameters);
+  mixer_.Snapshot(&state->mixer);
+  filter_.Snapshot(&state->filter);
+  modulator_.Snapshot(&state->modulator);
+  // Pending samples are the last ones of the last pushed Sample
+  state->pending_count = buffer_.Size();
+  std::fill_n(&state->pending[0], SampleSize, 0.0f);
+  buffer_.Peek(&state->pending[SampleSize - state->pending_count],
+               state->pending_count);
+  state->sampling_rate = sampling_rate_;
+  state->quiet_samples = quiet_samples_;
+  state->sleeping = sleeping_;
+}
+
+void Synthesizer::Restore(const State& state) {
+  OPENMINI_ASSERT(state.pending_count <= SampleSize);
+
+  RestoreParameters(state.parameters);
+  mixer_.Restore(state.mixer);
+  filter_.Restore(state.filter);
+  modulator_.Restore(state.modulator);
+  // The whole Sample is pushed back in order to keep the buffer
+  // writing position aligned, its already retrieved part being dropped
+  buffer_.Clear();
+  buffer_.Push(&state.pending[0], SampleSize);
+  float dropped[SampleSize];
+  buffer_.Pop(&dropped[0], SampleSize - state.pending_count);
+  sampling_rate_ = state.sampling_rate;
+  quiet_samples_ = state.quiet_samples;
+  sleeping_ = state.sleeping;
+}
+
+Synthesizer* Synthesizer::Clone(void) const {
+  Synthesizer* clone(new Synthesizer(limiter_.Threshold(), max_block_size_));
+  OPENMINI_ASSERT(clone != nullptr);
+  State state;
+  Snapshot(&state);
+  clone->Restore(state);
+  return clone;
+}
+
+size_t Synthesizer::ArenaSize(const unsigned int max_block_size) {
+  return Mixer::ArenaSize()
+         + Vcf::ArenaSize()
+         + Vca::ArenaSize()
+         + RingBuffer<float>::ArenaSize(max_block_size);
+}
+
+MemoryReport Synthesizer::MemoryUsage(void) const {
+  MemoryReport report;
+  report.generators = sizeof(mixer_) + Mixer::ArenaSize();
+  report.filters = sizeof(filter_) + Vcf::ArenaSize();
+  report.envelopes = sizeof(modulator_) + Vca::ArenaSize();
+  report.ring_buffer = sizeof(buffer_) + buffer_.MemoryUsage();
+  report.parameters = ParametersMemoryUsage();
+
+  // The ring buffer leaves the arena when growing beyond it
+  const size_t arena_accounted(
+    Mixer::ArenaSize()
+    + Vcf::ArenaSize()
+    + Vca::ArenaSize()
+    + (buffer_.OwnsMemory() ? 0 : buffer_.MemoryUsage()));
+  const size_t objects_accounted(sizeof(ParametersManager)
+                                 + sizeof(mixer_)
+                                 + sizeof(filter_)
+                                 + sizeof(modulator_)
+                                 + sizeof(buffer_));
+  // The arena allocation has one more cache line for its own alignment
+  const size_t arena_total(arena_.Capacity() + kCacheLineSize);
+  report.others = sizeof(*this) - objects_accounted
+                  + arena_total - arena_accounted;
+  return report;
+}
+
+unsigned int Synthesizer::DenormalsCount(void) const {
+  State state;
+  Snapshot(&state);
+  const OscillatorBank::State& bank(state.mixer.bank);
+  const BlockEnvelop::State& contour(state.filter.contour_gen);
+  const BlockEnvelop::State& envelop(state.modulator.generator);
+  return CountDenormals(&bank.phases[0], kOscillatorBankLanesCount)
+         + CountDenormals(&bank.differentiators[0], kOscillatorBankLanesCount)
+         + CountDenormals(&state.mixer.noise.filters[0], kNoiseLanesCount)
+         + CountDenormals(&state.filter.ladder.stages[0][0],
+                          kLadderStagesCount * kLadderLanesCount)
+         + CountDenormals(&contour.value, 1)
+         + CountDenormals(&contour.origin, 1)
+         + CountDenormals(&envelop.value, 1)
+         + CountDenormals(&envelop.origin, 1)
+         + CountDenormals(&state.pending[0], SampleSize);
+}
+
+size_t MemoryReport::Total(void) const {
+  return generators + filters + envelopes + ring_buffer + parameters + others;
+}
+
+void Synthesizer::RenderBlock(const unsigned int missing) {
+  OPENMINI_ASSERT(missing > 0);
+  modulator_.ProcessParameters();
+  // Sleeping is only decided on the last Sample of a block
+  // (@see UpdateSleep()): the mixer is stopped once the amplitude envelop
+  // is idle, the block then ends with the Sample it gets idle in.
+  // Once idle, it ends with the earliest Sample sleeping may start at.
+  const bool idle(modulator_.IsIdle());
+  const unsigned int active_length(idle
+    ? std::min(kSleepHoldSamples - quiet_samples_, kBlockSize)
+    : GetNextMultiple(std::min(modulator_.ActiveLength(), kBlockSize),
+                      SampleSize));
+  const unsigned int length(std::min(GetNextMultiple(missing, SampleSize),
+                                     std::max(active_length, SampleSize)));
+  alignas(16) float block[kBlockSize];
+  alignas(16) float filtered[kBlockSize];
+  mixer_.Process(&block[0], length);
+  filter_.Process(&block[0], &filtered[0], length);
+  modulator_.Process(&filtered[0], &block[0], length);
+  limiter_.Process(&block[0], &block[0], length);
+  buffer_.Push(&block[0], length);
+  // Not idle yet, all Samples but the last one would reset the quiet count
+  if (!idle) {
+    quiet_samples_ = 0;
+  }
+  for (unsigned int i(idle ? 0 : length - SampleSize);
+       i < length;
+       i += SampleSize) {
+    UpdateSleep(VectorMath::Fill(&filtered[i]));
+  }
+}
+
+void Synthesizer::UpdateSleep(SampleRead filtered) {
+  if (!modulator_.IsIdle()) {
+    quiet_samples_ = 0;
+    return;
+  }
+  // Nothing can be heard anymore: VCOs are stopped, and the filter rings out
+  mixer_.Stop();
+  if (VectorMath::GreaterEqual(kSilenceThreshold, VectorMath::Abs(filtered))) {
+    quiet_samples_ += SampleSize;
+    if (quiet_samples_ >= kSleepHoldSamples) {
+      sleeping_ = true;
+    }
+  } else {
+    quiet_samples_ = 0;
+  }
 }
 
 void Synthesizer::ProcessParameters(void) {
@@ -169,6 +391,20 @@ void Synthesizer::ProcessParameters(void) {
           filter_.SetAmount(GetRawValue(Parameters::kContourAmount));
           break;
         }
+        case(Parameters::kNoiseVolume): {
+          mixer_.SetNoiseVolume(GetRawValue(Parameters::kNoiseVolume));
+          break;
+        }
+        case(Parameters::kNoiseColor): {
+          mixer_.SetNoiseColor(
+            GetDiscreteValue<NoiseColor::Type>(Parameters::kNoiseColor));
+          break;
+        }
+        case(Parameters::kOscillatorEngine): {
+          mixer_.SetEngine(GetDiscreteValue<OscillatorEngine::Type>(
+            Parameters::kOscillatorEngine));
+          break;
+        }
         default: {
           // Should never happen
           OPENMINI_ASSERT(false);
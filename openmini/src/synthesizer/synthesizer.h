@@ -22,7 +22,9 @@
 #define OPENMINI_SRC_SYNTHESIZER_SYNTHESIZER_H_
 
 #include <array>
+#include <limits>
 
+#include "openmini/src/synthesizer/arena.h"
 #include "openmini/src/synthesizer/limiter.h"
 #include "openmini/src/synthesizer/mixer.h"
 #include "openmini/src/synthesizer/parameters_manager.h"
@@ -33,18 +35,75 @@
 namespace openmini {
 namespace synthesizer {
 
+/// @brief Default (on startup) expected block size
+static const unsigned int kDefaultBlockSize(512);
+
+/// @brief Tail length reported when the filter never rings out
+static const unsigned int kInfiniteTail(
+  std::numeric_limits<unsigned int>::max());
+
+/// @brief Memory used by one synthesizer instance, in bytes, by module
+///
+/// Each module accounts for both its own object and the memory it uses
+/// within the instance arena.
+struct MemoryReport {
+  size_t generators;  ///< VCOs and their generators
+  size_t filters;  ///< Filters and their contour envelop
+  size_t envelopes;  ///< Amplitude envelop
+  size_t ring_buffer;  ///< Output ring buffer
+  size_t parameters;  ///< Parameters values and changes tracking
+  size_t others;  ///< Everything else: limiter, arena padding and unused room
+
+  /// @brief Total memory used by the instance
+  size_t Total(void) const;
+};
+
 /// @brief Synthesizer: main object, everything lives within it
+///
+/// All DSP state is placed into one per-instance arena, allocated at once
+/// on construction, in processing order.
+///
+/// Once the amplitude envelop is fully released, VCOs are stopped;
+/// as soon as the filter has rung out, the synthesizer goes to sleep:
+/// nothing is rendered anymore, the output is only zeros,
+/// until the next note wakes it up.
 class Synthesizer : public ParametersManager {
  public:
+  /// @brief Whole synthesizer state, trivially copyable
+  ///
+  /// Holds everything required to resume rendering exactly where it was
+  /// captured: parameters, oscillators phases, filters memory,
+  /// envelops stages and output samples computed but not retrieved yet.
+  /// It is only valid within the process it was captured in.
+  struct State {
+    ParametersState parameters;  ///< Parameters values and pending changes
+    Mixer::State mixer;  ///< Mixer and VCOs state
+    Vcf::State filter;  ///< Filter state
+    Vca::State modulator;  ///< Modulator state
+    float pending[SampleSize];  ///< Last computed Sample, whose last
+                                ///< pending_count elements are not
+                                ///< retrieved yet
+    unsigned int pending_count;  ///< Output samples not retrieved yet
+    float sampling_rate;  ///< Sampling rate parameters were processed for
+    unsigned int quiet_samples;  ///< Samples the filter has been silent for
+    bool sleeping;  ///< True if rendering is suspended
+  };
+
   /// @brief Default constructor
   ///
   /// The output max amplitude can be set here - everything above it is clipped
   ///
   /// @param[in]  output_limit    Max absolute output amplitude
-  explicit Synthesizer(const float output_limit = 1.0f);
+  /// @param[in]  max_block_size  Expected block size the arena is sized for:
+  ///                             SetMaxBlockSize() only allocates above it
+  explicit Synthesizer(const float output_limit = 1.0f,
+                       const unsigned int max_block_size = kDefaultBlockSize);
 
   /// @brief Process function for one buffer
   ///
+  /// Buffers longer than the maximum block size are processed by chunks:
+  /// no memory is allocated here.
+  ///
   /// @param[out]   output      Output buffer to write into
   /// @param[in]    length      Output buffer length
   void ProcessAudio(float* const output, const unsigned int length);
@@ -68,6 +127,75 @@ class Synthesizer : public ParametersManager {
   /// @param[in]  freq    Output sampling frequency
   void SetOutputSamplingFrequency(const float freq);
 
+  /// @brief Set the maximum expected block size
+  ///
+  /// Internal buffers are allocated here, it should be called before
+  /// audio processing starts (e.g. not from within the audio thread).
+  /// Longer blocks are still allowed but will be processed by chunks.
+  ///
+  /// @param[in]  length    Maximum expected ProcessAudio() buffer length
+  void SetMaxBlockSize(const unsigned int length);
+
+  /// @brief Restart the noise source from the given seed
+  ///
+  /// Renders are reproducible: the same seed gives the same noise.
+  ///
+  /// @param[in]  seed    Noise seed, kDefaultNoiseSeed on construction
+  void SetNoiseSeed(const uint32_t seed);
+
+  /// @brief Check if the synthesizer is sleeping, i.e. not rendering
+  /// anything until the next note
+  bool IsSleeping(void) const;
+
+  /// @brief Check if the last ProcessAudio() output was only zeros
+  ///
+  /// Hosts may skip mixing it, or calling ProcessAudio() again until
+  /// the next note.
+  bool IsOutputSilent(void) const;
+
+  /// @brief Samples rendered after a note off until going to sleep
+  ///
+  /// Computed from the current amplitude decay time and filter settings:
+  /// kInfiniteTail on a self-oscillating filter, which never rings out.
+  unsigned int TailLength(void) const;
+
+  /// @brief Capture the whole synthesizer state
+  ///
+  /// To be called in between two ProcessAudio() calls
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// The state may come from another instance: rendering then goes on
+  /// exactly as it would have within the captured one.
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+  /// @brief Create a new instance with the very same state
+  ///
+  /// The user is responsible for the destruction of the created object
+  ///
+  /// @return a pointer to the created synthesizer
+  Synthesizer* Clone(void) const;
+
+  /// @brief Arena room required by one instance
+  ///
+  /// @param[in]  max_block_size  Expected block size
+  static size_t ArenaSize(const unsigned int max_block_size);
+
+  /// @brief Report memory used by this instance, by module
+  MemoryReport MemoryUsage(void) const;
+
+  /// @brief Count denormal values within all modules state
+  ///
+  /// Debugging purpose only: this is not meant to be called
+  /// from the audio thread. Should always be zero, denormals being
+  /// flushed to zero during ProcessAudio().
+  unsigned int DenormalsCount(void) const;
+
  protected:
   /// @brief Asynchronous parameters update
   ///
@@ -75,11 +203,33 @@ class Synthesizer : public ParametersManager {
   void ProcessParameters(void);
 
  private:
+  /// @brief Render one block into the output buffer
+  ///
+  /// Whole Samples are rendered, up to kBlockSize, each stage processing
+  /// the whole block at once: blocks also end with the amplitude envelop,
+  /// so that VCOs are stopped and sleeping starts exactly where they
+  /// would be rendering one Sample at a time.
+  ///
+  /// @param[in]  missing     Count of output samples still required
+  void RenderBlock(const unsigned int missing);
+
+  /// @brief Check if the synthesizer may go to sleep
+  ///
+  /// @param[in]  filtered    Last filter output
+  void UpdateSleep(SampleRead filtered);
+
+  Arena arena_;  ///< Memory for all objects below, hence declared first
   Mixer mixer_;  ///< Mixer object for VCOs management
   Vcf filter_;  ///< Filter object
   Vca modulator_;  ///< Modulator object
   Limiter limiter_;  ///< Limiter object
-  RingBuffer buffer_;  ///< Adapter object for output audio stream matching
+  RingBuffer<float> buffer_;  ///< Adapter object for output audio
+                              ///< stream matching
+  unsigned int max_block_size_;  ///< Longest chunk processed at once
+  float sampling_rate_;  ///< Sampling rate parameters are processed for
+  unsigned int quiet_samples_;  ///< Samples the filter has been silent for
+  bool sleeping_;  ///< True if rendering is suspended until the next note
+  bool silent_output_;  ///< True if the last output was only zeros
 };
 
 }  // namespace synthesizer
@@ -67,6 +67,15 @@ unsigned int GetPrevMultiple(const unsigned int input,
   return input - remainder;
 }
 
+unsigned int GetNextPowerOfTwo(const unsigned int input) {
+  OPENMINI_ASSERT(input > 0);
+  unsigned int power(1);
+  while (power < input) {
+    power <<= 1;
+  }
+  return power;
+}
+
 unsigned int GetOffsetFromNextMultiple(const unsigned int input,
                                        const unsigned int multiple) {
   return input % multiple;
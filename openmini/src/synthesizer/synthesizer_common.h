@@ -28,6 +28,10 @@
 namespace openmini {
 namespace synthesizer {
 
+/// @brief Assumed cache line size, used to keep apart data shared by threads
+/// and to align per-instance data
+static const unsigned int kCacheLineSize(64);
+
 /// @brief Floor the input value and convert it as the given type
 ///
 /// @param[in] value     Value to convert
@@ -79,6 +83,11 @@ unsigned int GetNextMultiple(const unsigned int input,
 unsigned int GetPrevMultiple(const unsigned int input,
                              const unsigned int multiple);
 
+/// @brief Find the smallest power of two bigger than the given number
+///
+/// @param[in]   input     Number to be rounded from, strictly positive
+unsigned int GetNextPowerOfTwo(const unsigned int input);
+
 /// @brief Find the offset to add to the number to get it to the next
 /// immediate multiple
 ///
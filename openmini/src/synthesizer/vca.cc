@@ -20,16 +20,16 @@
 
 #include "openmini/src/synthesizer/vca.h"
 
-#include "soundtailor/src/modulators/adsd.h"
+#include <new>
 
 #include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
 
 namespace openmini {
 namespace synthesizer {
 
-Vca::Vca()
-  : // TODO(gm): use a factory?
-    generator_(new soundtailor::modulators::Adsd()),
+Vca::Vca(Arena* arena)
+  : generator_(new (arena->Allocate<BlockEnvelop>()) BlockEnvelop()),
     attack_(0),
     decay_(0),
     sustain_level_(0.0f),
@@ -39,7 +39,8 @@ Vca::Vca()
 
 Vca::~Vca() {
   OPENMINI_ASSERT(generator_ != nullptr);
-  delete generator_;
+  // Memory itself belongs to the arena
+  generator_->~BlockEnvelop();
 }
 
 void Vca::TriggerOn(void) {
@@ -57,14 +58,25 @@ void Vca::TriggerOff(void) {
 Sample Vca::operator()(SampleRead input) {
   OPENMINI_ASSERT(generator_ != nullptr);
   ProcessParameters();
-  // TODO(gm): this cast should not be done:
-  // the generator is actually known at compile-time,
-  // so find an elegant way to statically do this
-  soundtailor::modulators::Adsd* static_generator_ptr
-    = static_cast<soundtailor::modulators::Adsd*>(generator_);
-  const Sample envelop((*static_generator_ptr)());
-
-  return VectorMath::Mul(input, envelop);
+  return VectorMath::Mul(input, (*generator_)());
+}
+
+void Vca::Process(const float* const input,
+                  float* const output,
+                  const unsigned int length) {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(IsMultipleOf(length, SampleSize));
+  OPENMINI_ASSERT(length <= kBlockSize);
+  ProcessParameters();
+  alignas(16) float envelop[kBlockSize];
+  generator_->Process(&envelop[0], length);
+  for (unsigned int i(0); i < length; i += SampleSize) {
+    VectorMath::Store(&output[i],
+                      VectorMath::Mul(VectorMath::Fill(&input[i]),
+                                      VectorMath::Fill(&envelop[i])));
+  }
 }
 
 void Vca::SetAttack(const unsigned int attack) {
@@ -102,5 +114,38 @@ void Vca::ProcessParameters(void) {
   }
 }
 
+bool Vca::IsIdle(void) const {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  return generator_->IsIdle();
+}
+
+unsigned int Vca::ActiveLength(void) const {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  return generator_->ActiveLength();
+}
+
+void Vca::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  OPENMINI_ASSERT(generator_ != nullptr);
+  generator_->Snapshot(&state->generator);
+  state->attack = attack_;
+  state->decay = decay_;
+  state->sustain_level = sustain_level_;
+  state->update = update_;
+}
+
+void Vca::Restore(const State& state) {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  generator_->Restore(state.generator);
+  attack_ = state.attack;
+  decay_ = state.decay;
+  sustain_level_ = state.sustain_level;
+  update_ = state.update;
+}
+
+size_t Vca::ArenaSize(void) {
+  return Arena::AlignedSize(sizeof(BlockEnvelop));
+}
+
 }  // namespace synthesizer
 }  // namespace openmini
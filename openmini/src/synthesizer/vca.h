@@ -24,13 +24,8 @@
 #define OPENMINI_SRC_SYNTHESIZER_VCA_H_
 
 #include "openmini/src/common.h"
-
-// SoundTailor forward declarations
-namespace soundtailor {
-namespace modulators {
-class EnvelopGenerator_Base;
-}  // namespace modulators
-}  // namespace soundtailor
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/block_envelop.h"
 
 namespace openmini {
 namespace synthesizer {
@@ -41,8 +36,19 @@ namespace synthesizer {
 /// It handles everything about asynchronous parameters update.
 class Vca {
  public:
+  /// @brief Whole VCA state, trivially copyable
+  struct State {
+    BlockEnvelop::State generator;  ///< Internal envelop generator state
+    unsigned int attack;  ///< Envelop attack time
+    unsigned int decay;  ///< Envelop decay time
+    float sustain_level;  ///< Envelop sustain level
+    bool update;  ///< True if any parameter is pending
+  };
+
   /// @brief Default constructor
-  Vca();
+  ///
+  /// @param[in]  arena   Arena to take the envelop generator memory from
+  explicit Vca(Arena* arena);
   /// @brief Default destructor
   ~Vca();
 
@@ -61,6 +67,18 @@ class Vca {
   /// @brief Actual process function for one sample
   Sample operator()(SampleRead input);
 
+  /// @brief Process function for one buffer
+  ///
+  /// The envelop is rendered for the whole buffer at once
+  ///
+  /// @param[in]  input     Input buffer
+  /// @param[out] output    Modulated output, may be the input buffer
+  /// @param[in]  length    Buffers length, a multiple of SampleSize
+  ///                       at most kBlockSize
+  void Process(const float* const input,
+               float* const output,
+               const unsigned int length);
+
   /// @brief Set the given attack time
   ///
   /// The parameter is not normalized here - the unit is "samples"
@@ -84,12 +102,36 @@ class Vca {
   /// Allows asynchronous updates; to be called within an update loop.
   void ProcessParameters(void);
 
+  /// @brief Check if the envelop is idle, i.e. fully released:
+  /// the output is then only zeros until the next trigger
+  bool IsIdle(void) const;
+
+  /// @brief Samples left before the envelop is idle,
+  /// if it is not triggered in between, @see BlockEnvelop::ActiveLength()
+  ///
+  /// Pending parameters are not taken into account:
+  /// ProcessParameters() has to be called beforehand.
+  unsigned int ActiveLength(void) const;
+
+  /// @brief Capture the whole VCA state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+  /// @brief Arena room required by one instance
+  static size_t ArenaSize(void);
+
  private:
-  // No assignment operator for this class
+  // No copy nor assignment operator for this class
+  Vca(const Vca& right);
   Vca& operator=(const Vca& right);
 
-  // TODO(gm): polymorphism probably no longer useful here
-  soundtailor::modulators::EnvelopGenerator_Base* generator_;  ///< Envelop generator
+  BlockEnvelop* const generator_;  ///< Envelop generator, within the arena
   unsigned int attack_; ///< Envelop attack time (due to asynchronous update,
                         ///< it may as well be the value to be applied soon
   unsigned int decay_; ///< Envelop decay time (due to asynchronous update,
@@ -22,8 +22,12 @@
 
 // std::min
 #include <algorithm>
+// std::log, std::pow
+#include <cmath>
+// std::numeric_limits
+#include <limits>
 
-#include "soundtailor/src/filters/moog_oversampled.h"
+#include "soundtailor/src/filters/moog.h"
 #include "soundtailor/src/utilities.h"
 
 #include "openmini/src/synthesizer/parameters.h"
@@ -31,10 +35,11 @@
 namespace openmini {
 namespace synthesizer {
 
-Vcf::Vcf()
-  : filters_(Allocate<InternalFilter>(2)),
-    dry_filter_(new (&filters_[0]) InternalFilter()),
-    wet_filter_(new (&filters_[1]) InternalFilter()),
+/// @brief Filter whose parameters ranges are followed by the ladder
+typedef soundtailor::filters::Moog MetaFilter;
+
+Vcf::Vcf(Arena* arena)
+  : ladder_(new (arena->Allocate<DualLadder>()) DualLadder()),
     contour_gen_(),
     attack_(0),
     decay_(0),
@@ -43,14 +48,13 @@ Vcf::Vcf()
     resonance_(0.0f),
     amount_(0.0f),
     update_(false) {
-  OPENMINI_ASSERT(filters_ != nullptr);
-  OPENMINI_ASSERT(dry_filter_ != nullptr);
-  OPENMINI_ASSERT(wet_filter_ != nullptr);
+  OPENMINI_ASSERT(ladder_ != nullptr);
 }
 
 Vcf::~Vcf() {
-  OPENMINI_ASSERT(filters_ != nullptr);
-  Deallocate(filters_);
+  OPENMINI_ASSERT(ladder_ != nullptr);
+  // Memory itself belongs to the arena
+  ladder_->~DualLadder();
 }
 
 void Vcf::TriggerOn(void) {
@@ -64,8 +68,8 @@ void Vcf::TriggerOff(void) {
 }
 
 void Vcf::SetFrequency(const float frequency) {
-  OPENMINI_ASSERT(frequency >= InternalFilter::Meta().freq_min);
-  OPENMINI_ASSERT(frequency <= InternalFilter::Meta().freq_max);
+  OPENMINI_ASSERT(frequency >= MetaFilter::Meta().freq_min);
+  OPENMINI_ASSERT(frequency <= MetaFilter::Meta().freq_max);
 
   // TODO(gm): find a way to do this generically
   if (frequency != frequency_) {
@@ -75,8 +79,8 @@ void Vcf::SetFrequency(const float frequency) {
 }
 
 void Vcf::SetResonance(const float resonance) {
-  OPENMINI_ASSERT(resonance >= InternalFilter::Meta().res_min);
-  OPENMINI_ASSERT(resonance <= InternalFilter::Meta().res_max);
+  OPENMINI_ASSERT(resonance >= MetaFilter::Meta().res_min);
+  OPENMINI_ASSERT(resonance <= MetaFilter::Meta().res_max);
 
   // TODO(gm): find a way to do this generically
   if (resonance != resonance_) {
@@ -128,36 +132,111 @@ void Vcf::SetAmount(const float amount) {
 }
 
 Sample Vcf::operator()(SampleRead sample) {
-  OPENMINI_ASSERT(dry_filter_ != nullptr);
-  OPENMINI_ASSERT(wet_filter_ != nullptr);
+  alignas(16) float samples[SampleSize];
+  VectorMath::Store(&samples[0], sample);
+  Process(&samples[0], &samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void Vcf::Process(const float* const input,
+                  float* const output,
+                  const unsigned int length) {
+  OPENMINI_ASSERT(ladder_ != nullptr);
+  OPENMINI_ASSERT(input != nullptr);
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(length <= kBlockSize);
   ProcessParameters();
-  const Sample dry(VectorMath::MulConst((1.0f - amount_), (*dry_filter_)(sample)));
-  const Sample wet(VectorMath::MulConst(amount_, (*wet_filter_)(sample)));
-  // Update filter contour based on last envelop generator output
-  wet_filter_->SetParameters(ComputeContour(), resonance_);
-  return VectorMath::Add(dry, wet);
+  // The wet filter frequency follows the contour on each sample
+  alignas(16) float frequencies[kBlockSize];
+  ComputeContour(&frequencies[0], length);
+  ladder_->Process(input,
+                   &frequencies[0],
+                   1.0f - amount_,
+                   amount_,
+                   output,
+                   length);
 }
 
 void Vcf::ProcessParameters(void) {
-  OPENMINI_ASSERT(dry_filter_ != nullptr);
-  OPENMINI_ASSERT(wet_filter_ != nullptr);
+  OPENMINI_ASSERT(ladder_ != nullptr);
   if (update_) {
-    dry_filter_->SetParameters(frequency_, resonance_);
-    wet_filter_->SetParameters(frequency_, resonance_);
+    ladder_->SetFrequency(LadderLane::kDry, frequency_);
+    ladder_->SetFrequency(LadderLane::kWet, frequency_);
+    ladder_->SetResonance(resonance_);
     contour_gen_.SetParameters(attack_, decay_, decay_, sustain_level_);
     update_ = false;
   }
 }
 
-float Vcf::ComputeContour(void) {
+float Vcf::RingOutLength(const float frequency,
+                         const float resonance,
+                         const float level) {
+  OPENMINI_ASSERT(level > 0.0f);
+  OPENMINI_ASSERT(level < 1.0f);
+  // With a feedback k within [0 ; 4], the ladder dominant pole lies at
+  // wc * (-1 + (k / 4)^(1/4)) + j...: it self-oscillates at k = 4.
+  // The ladder feedback compensation only shortens it, hence ignored here
+  const float feedback(resonance / MetaFilter::Meta().res_max);
+  const float damping(1.0f - std::pow(Math::Max(0.0f, feedback), 0.25f));
+  const float decay_rate(static_cast<float>(2.0 * Pi) * frequency * damping);
+  if (decay_rate <= 0.0f) {
+    return std::numeric_limits<float>::infinity();
+  }
+  // Without resonance the four poles are stacked, the impulse response
+  // being x^3 / 6 * exp(-x): solving it for the level by fixed point
+  // keeps the estimate on the safe side in all cases
+  const float single_pole(-std::log(level));
+  float length(single_pole);
+  for (unsigned int i(0); i < 4; ++i) {
+    length = Math::Max(single_pole,
+                       single_pole + 3.0f * std::log(length) - std::log(6.0f));
+  }
+  return length / decay_rate;
+}
+
+void Vcf::ComputeContour(float* const frequencies,
+                         const unsigned int length) {
+  OPENMINI_ASSERT(frequencies != nullptr);
+  OPENMINI_ASSERT(length <= kBlockSize);
   // TODO(gm): Decide if accumulation is allowed for filter contour generator
-  const Sample contour(contour_gen_());
-  const float base_value(Math::Max(0.0f, Math::Min(1.0f, VectorMath::GetLast(contour))));
-  OPENMINI_ASSERT(base_value >= 0.0f);
-  OPENMINI_ASSERT(base_value <= 1.0f);
-  // Adaptation from normalized range [0.0 ; 1.0]
-  // into [frequency_ ; max allowed filter frequency]
-  return base_value * (InternalFilter::Meta().freq_max - frequency_) + frequency_;
+  alignas(16) float contour[kBlockSize];
+  contour_gen_.Process(&contour[0], length);
+  for (unsigned int i(0); i < length; ++i) {
+    const float base_value(Math::Max(0.0f, Math::Min(1.0f, contour[i])));
+    // Adaptation from normalized range [0.0 ; 1.0]
+    // into [frequency_ ; max allowed filter frequency]
+    frequencies[i] = base_value * (MetaFilter::Meta().freq_max - frequency_)
+                     + frequency_;
+  }
+}
+
+void Vcf::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  ladder_->Snapshot(&state->ladder);
+  contour_gen_.Snapshot(&state->contour_gen);
+  state->attack = attack_;
+  state->decay = decay_;
+  state->sustain_level = sustain_level_;
+  state->frequency = frequency_;
+  state->resonance = resonance_;
+  state->amount = amount_;
+  state->update = update_;
+}
+
+void Vcf::Restore(const State& state) {
+  ladder_->Restore(state.ladder);
+  contour_gen_.Restore(state.contour_gen);
+  attack_ = state.attack;
+  decay_ = state.decay;
+  sustain_level_ = state.sustain_level;
+  frequency_ = state.frequency;
+  resonance_ = state.resonance;
+  amount_ = state.amount;
+  update_ = state.update;
+}
+
+size_t Vcf::ArenaSize(void) {
+  return Arena::AlignedSize(sizeof(DualLadder));
 }
 
 }  // namespace synthesizer
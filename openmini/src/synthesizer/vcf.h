@@ -24,15 +24,9 @@
 
 #include "openmini/src/common.h"
 #include "openmini/src/maths.h"
-
-#include "soundtailor/src/modulators/adsd.h"
-
-// SoundTailor forward declarations
-namespace soundtailor {
-namespace filters {
-class MoogOversampled;
-}  // namespace filters
-}  // namespace soundtailor
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/block_envelop.h"
+#include "openmini/src/synthesizer/dual_ladder.h"
 
 namespace openmini {
 namespace synthesizer {
@@ -41,10 +35,30 @@ namespace synthesizer {
 /// additional parameters as well as a more advanced parameters management.
 ///
 /// It handles everything about asynchronous parameters update.
+///
+/// Dry and wet filters are run together by one dual-lane ladder,
+/// which directly outputs their mix.
 class Vcf {
  public:
+  /// @brief Whole filter state, trivially copyable
+  struct State {
+    DualLadder::State ladder;  ///< Dry and wet filters state
+    BlockEnvelop::State contour_gen;  ///< Internal envelop generator state
+    unsigned int attack;  ///< Envelop attack time
+    unsigned int decay;  ///< Envelop decay time
+    float sustain_level;  ///< Envelop sustain level
+    float frequency;  ///< Frequency of the filter
+    float resonance;  ///< Resonance of the filter
+    float amount;  ///< Dry/Wet tuning
+    bool update;  ///< True if any parameter is pending
+  };
+
   /// @brief Default constructor
-  Vcf();
+  ///
+  /// The internal dual-lane filter is placed into the given arena
+  ///
+  /// @param[in]  arena   Arena to take internal memory from
+  explicit Vcf(Arena* arena);
   /// @brief Default destructor
   ~Vcf();
 
@@ -93,27 +107,62 @@ class Vcf {
   /// @brief Actual process function for one sample
   Sample operator()(SampleRead sample);
 
+  /// @brief Process function for one buffer
+  ///
+  /// The contour envelop is rendered for the whole buffer at once
+  ///
+  /// @param[in]  input     Input buffer
+  /// @param[out] output    Filtered output, may be the input buffer
+  /// @param[in]  length    Buffers length, at most kBlockSize
+  void Process(const float* const input,
+               float* const output,
+               const unsigned int length);
 
   /// @brief Update internal generator parameters
   ///
   /// Allows asynchronous updates; to be called within an update loop.
   void ProcessParameters(void);
 
- private:
-  typedef soundtailor::filters::MoogOversampled InternalFilter;
+  /// @brief Capture the whole filter state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
 
+  /// @brief Restore a previously captured state
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+  /// @brief Arena room required by one instance
+  static size_t ArenaSize(void);
+
+  /// @brief Estimate how long the filter rings once its input stops
+  ///
+  /// Based on the ladder dominant pole damping: it gets infinite
+  /// on a self-oscillating setting.
+  ///
+  /// @param[in]  frequency   Filter frequency, as given to SetFrequency()
+  /// @param[in]  resonance   Filter resonance, as given to SetResonance()
+  /// @param[in]  level       Relative level the output has to decay to
+  ///
+  /// @return the ring out length in samples
+  static float RingOutLength(const float frequency,
+                             const float resonance,
+                             const float level);
+
+ private:
   /// @brief Internal helper wrapper for filter contour computation
   ///
-  /// @return the new filter contour (e.g. its new cutoff frequency)
-  float ComputeContour(void);
-  // No assignment operator for this class
+  /// @param[out] frequencies   Wet filter frequency for each sample
+  /// @param[in]  length        Count of samples to compute
+  void ComputeContour(float* const frequencies, const unsigned int length);
+
+  // No copy nor assignment operator for this class
+  Vcf(const Vcf& right);
   Vcf& operator=(const Vcf& right);
 
-  InternalFilter* const filters_;  ///< Internal filters, not to be used:
-                                   ///< access done through the pointers below
-  InternalFilter* const dry_filter_;  ///< Internal dry filter
-  InternalFilter* const wet_filter_;  ///< Internal wet filter
-  soundtailor::modulators::Adsd contour_gen_;  ///< Internal envelop generator
+  DualLadder* const ladder_;  ///< Dry and wet filters, within the arena
+  BlockEnvelop contour_gen_;  ///< Internal envelop generator
 
   unsigned int attack_; ///< Envelop attack time (due to asynchronous update,
                         ///< it may as well be the value to be applied soon
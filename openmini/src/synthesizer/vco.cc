@@ -20,27 +20,37 @@
 
 #include "openmini/src/synthesizer/vco.h"
 
+// std::fill_n
+#include <algorithm>
+
 #include "soundtailor/src/generators/generator_base.h"
 
-#include "openmini/src/synthesizer/generator_factory.h"
+#include "openmini/src/samplingrate.h"
+#include "openmini/src/synthesizer/polyblep.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+#include "openmini/src/synthesizer/wavetable_oscillator.h"
 
 namespace openmini {
 namespace synthesizer {
 
-Vco::Vco()
-  : // Default on Triangle
-    generator_(generators::CreateGenerator(Waveform::kTriangle)),
+Vco::Vco(Arena* arena)
+  : generator_slot_(arena->Allocate(generators::GeneratorSlotSize())),
+    // Default on Triangle
+    generator_(generators::CreateGenerator(generator_slot_,
+                                           Waveform::kTriangle)),
+    tables_(nullptr),
     volume_(1.0f),
     frequency_(0.0f),
     last_(VectorMath::Fill(0.0f)),
     waveform_(Waveform::kTriangle),
+    engine_(OscillatorEngine::kDPW),
     update_(false) {
   OPENMINI_ASSERT(generator_ != nullptr);
 }
 
 Vco::~Vco() {
   OPENMINI_ASSERT(generator_ != nullptr);
-  generators::DestroyGenerator(generator_);
+  generators::DestroyGeneratorInPlace(generator_);
 }
 
 void Vco::SetFrequency(const float frequency) {
@@ -64,27 +74,101 @@ void Vco::SetVolume(const float volume) {
 void Vco::SetWaveform(const Waveform::Type value) {
   // This is temporary
   if (value != waveform_) {
-    ::soundtailor::generators::Generator_Base* temp
-      = generators::CreateGenerator(value, VectorMath::GetLast(last_));
-    OPENMINI_ASSERT(temp != nullptr);
-    generators::DestroyGenerator(generator_);
-    generator_ = temp;
     waveform_ = value;
-    // Force parameters processing!
-    update_ = true;
-    ProcessParameters();
-    // Explicit call to generators "take last change into account"
-    generator_->ProcessParameters();
+    ReplaceGenerator();
+  }
+}
+
+void Vco::SetEngine(const OscillatorEngine::Type value) {
+  OPENMINI_ASSERT(value < OscillatorEngine::kCount);
+
+  if (value != engine_) {
+    engine_ = value;
+    ReplaceGenerator();
+  }
+}
+
+void Vco::SetTables(const Wavetables* tables) {
+  OPENMINI_ASSERT(tables != nullptr);
+  tables_ = tables;
+  BindTables();
+}
+
+void Vco::ReplaceGenerator(void) {
+  // The new generator takes the place of the previous one
+  generators::DestroyGeneratorInPlace(generator_);
+  generator_ = generators::CreateGenerator(
+    generator_slot_,
+    generators::GetGeneratorType(engine_, waveform_),
+    VectorMath::GetLast(last_));
+  OPENMINI_ASSERT(generator_ != nullptr);
+  BindTables();
+  // Force parameters processing!
+  update_ = true;
+  ProcessParameters();
+  // Explicit call to generators "take last change into account"
+  generator_->ProcessParameters();
+}
+
+void Vco::BindTables(void) {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  if ((OscillatorEngine::kWavetable == engine_) && (tables_ != nullptr)) {
+    static_cast<generators::WavetableOscillator*>(generator_)->SetTables(
+      tables_);
   }
 }
 
 Sample Vco::operator()(void) {
   OPENMINI_ASSERT(generator_ != nullptr);
   ProcessParameters();
-  last_ = VectorMath::MulConst(volume_, (*generator_)());
+  // Muted: the generator is not run at all, hence frozen.
+  // Its state stays coherent, so that it resumes smoothly once unmuted
+  if (volume_ == 0.0f) {
+    last_ = VectorMath::Fill(0.0f);
+  } else {
+    last_ = VectorMath::MulConst(volume_, (*generator_)());
+  }
   return last_;
 }
 
+void Vco::Process(float* const output, const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(generator_ != nullptr);
+  OPENMINI_ASSERT(length > 0);
+  OPENMINI_ASSERT(IsMultipleOf(length, SampleSize));
+  ProcessParameters();
+  // Muted: the generator is not run at all, same as operator()
+  if (volume_ == 0.0f) {
+    std::fill_n(output, length, 0.0f);
+    last_ = VectorMath::Fill(0.0f);
+    return;
+  }
+  switch (engine_) {
+    case(OscillatorEngine::kPolyBlep): {
+      static_cast<generators::PolyBlep_Base*>(generator_)->Process(output,
+                                                                   length);
+      break;
+    }
+    case(OscillatorEngine::kWavetable): {
+      static_cast<generators::WavetableOscillator*>(generator_)->Process(
+        output,
+        length);
+      break;
+    }
+    default: {
+      // SoundTailor generators only render one Sample at a time
+      for (unsigned int i(0); i < length; i += SampleSize) {
+        VectorMath::Store(&output[i], (*generator_)());
+      }
+      break;
+    }
+  }
+  for (unsigned int i(0); i < length; ++i) {
+    output[i] *= volume_;
+  }
+  last_ = VectorMath::Fill(&output[length - SampleSize]);
+}
+
 void Vco::ProcessParameters(void) {
   OPENMINI_ASSERT(generator_ != nullptr);
   if (update_) {
@@ -94,5 +178,42 @@ void Vco::ProcessParameters(void) {
   }
 }
 
+void Vco::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  OPENMINI_ASSERT(generator_ != nullptr);
+  // Opaque generators resume from the last output, as on waveform changes
+  generators::SnapshotGenerator(
+    *generator_,
+    generators::GetGeneratorType(engine_, waveform_),
+    VectorMath::GetLast(last_),
+    frequency_ / SamplingRate::Instance().Get(),
+    &state->generator);
+  state->last = last_;
+  state->volume = volume_;
+  state->frequency = frequency_;
+  state->waveform = waveform_;
+  state->engine = engine_;
+  state->update = update_;
+}
+
+void Vco::Restore(const State& state) {
+  OPENMINI_ASSERT(generator_ != nullptr);
+  // The new generator takes the place of the current one
+  generators::DestroyGeneratorInPlace(generator_);
+  generator_ = generators::RestoreGenerator(generator_slot_, state.generator);
+  OPENMINI_ASSERT(generator_ != nullptr);
+  last_ = state.last;
+  volume_ = state.volume;
+  frequency_ = state.frequency;
+  waveform_ = state.waveform;
+  engine_ = state.engine;
+  update_ = state.update;
+  BindTables();
+}
+
+size_t Vco::ArenaSize(void) {
+  return Arena::AlignedSize(generators::GeneratorSlotSize());
+}
+
 }  // namespace synthesizer
 }  // namespace openmini
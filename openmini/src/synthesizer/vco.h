@@ -25,6 +25,9 @@
 
 #include "openmini/src/common.h"
 #include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/generator_factory.h"
+#include "openmini/src/synthesizer/wavetables.h"
 
 // SoundTailor forward declarations
 namespace soundtailor {
@@ -40,10 +43,31 @@ namespace synthesizer {
 /// additional parameters as well as a more advanced parameters management.
 ///
 /// It handles everything about asynchronous parameters update.
+///
+/// A muted VCO does not run its generator.
+///
+/// Its generator is taken from the selected engine (e.g. polyBLEP or
+/// wavetable ones), DPW by default.
 class Vco {
  public:
+  /// @brief Whole VCO state, trivially copyable
+  struct State {
+    generators::GeneratorState generator;  ///< Internal generator state
+    Sample last;  ///< Last computed sample
+    float volume;  ///< Volume of the generator
+    float frequency;  ///< Frequency of the generator
+    Waveform::Type waveform;  ///< Waveform of the generator
+    OscillatorEngine::Type engine;  ///< Family of the generator
+    bool update;  ///< True if any parameter is pending
+  };
+
   /// @brief Default constructor
-  Vco();
+  ///
+  /// The internal generator slot is taken from the given arena,
+  /// it is reused by all waveform changes
+  ///
+  /// @param[in]  arena   Arena to take internal memory from
+  explicit Vco(Arena* arena);
   /// @brief Default destructor
   ~Vco();
   /// @brief Set the VCO to the given frequency
@@ -62,24 +86,71 @@ class Vco {
   ///
   /// @param[in]    value          Waveform type to set the VCO to
   void SetWaveform(const Waveform::Type value);
+  /// @brief Set the VCO generator to the given engine one
+  ///
+  /// @param[in]    value          Generators family to set the VCO to
+  void SetEngine(const OscillatorEngine::Type value);
+  /// @brief Set the tables wavetable generators read from
+  ///
+  /// Tables are not owned, the user has to keep them alive as long as
+  /// they are used (@see Mixer). They have to be set before running
+  /// the wavetable engine.
+  ///
+  /// @param[in]    tables         Tables of the current sampling rate
+  void SetTables(const Wavetables* tables);
   /// @brief Actual process function for one sample
   Sample operator()(void);
+  /// @brief Process function for one buffer
+  ///
+  /// Generators rendering whole blocks (e.g. polyBLEP and wavetable ones)
+  /// are run once for the whole buffer.
+  ///
+  /// @param[out]   output      Output buffer, aligned on the Sample size
+  /// @param[in]    length      Buffer length, a multiple of the Sample size
+  void Process(float* const output, const unsigned int length);
   /// @brief Update internal generator parameters
   ///
   /// Allows asynchronous updates; to be called within an update loop.
   void ProcessParameters(void);
 
+  /// @brief Capture the whole VCO state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// The generator is created anew from its captured state;
+  /// wavetable generators read from the tables given to SetTables().
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+  /// @brief Arena room required by one instance
+  static size_t ArenaSize(void);
+
  private:
-  // No assignment operator for this class
+  // No copy nor assignment operator for this class
+  Vco(const Vco& right);
   Vco& operator=(const Vco& right);
 
+  /// @brief Replace the generator by the current engine and waveform one,
+  /// keeping the last output as its phase
+  void ReplaceGenerator(void);
+
+  /// @brief Give the tables to the generator, if it is a wavetable one
+  void BindTables(void);
+
+  void* const generator_slot_;  ///< Arena memory the generator lives in
   soundtailor::generators::Generator_Base* generator_;  ///< Internal generator
+  const Wavetables* tables_;  ///< Wavetable generators tables, not owned
   float volume_; ///< Volume of the generator (due to asynchronous update,
                  ///< it may as well be the volume to be applied soon
   float frequency_; ///< Frequency of the generator (non-normalized, in Hz).
                     ///< Same as above.
   Sample last_; ///< Last computed sample
   Waveform::Type waveform_;  ///< Waveform of the generator. Same as above.
+  OscillatorEngine::Type engine_;  ///< Family of the generator
   bool update_;  ///< True if any parameter was updated since the last call to
                  ///< ProcessParameters()
 };
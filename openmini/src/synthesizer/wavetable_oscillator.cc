@@ -0,0 +1,118 @@
+/// @filename wavetable_oscillator.cc
+/// @brief Wavetable generator - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/wavetable_oscillator.h"
+
+namespace openmini {
+namespace generators {
+
+/// @brief Highest allowed normalized frequency
+static const float kWavetableMaxFrequency(0.5f);
+
+WavetableOscillator::WavetableOscillator(const Waveform::Type waveform,
+                                         const float phase)
+    : Generator_Base(phase),
+      tables_(nullptr),
+      table_(nullptr),
+      waveform_(waveform),
+      position_(0.0f),
+      step_(0.0f) {
+  OPENMINI_ASSERT(waveform < Waveform::kCount);
+  WavetableOscillator::SetPhase(phase);
+}
+
+WavetableOscillator::~WavetableOscillator() {
+  // Nothing to do here for now: tables are not owned
+}
+
+void WavetableOscillator::SetPhase(const float phase) {
+  OPENMINI_ASSERT(phase <= 1.0f);
+  OPENMINI_ASSERT(phase >= -1.0f);
+
+  position_ = 0.5f * (phase + 1.0f);
+  if (position_ >= 1.0f) {
+    position_ -= 1.0f;
+  }
+}
+
+void WavetableOscillator::SetFrequency(const float frequency) {
+  OPENMINI_ASSERT(frequency >= 0.0f);
+  OPENMINI_ASSERT(frequency <= kWavetableMaxFrequency);
+
+  step_ = frequency;
+  if (tables_ != nullptr) {
+    table_ = tables_->Table(waveform_, frequency * tables_->SamplingRate());
+  }
+}
+
+void WavetableOscillator::SetTables(const synthesizer::Wavetables* tables) {
+  OPENMINI_ASSERT(tables != nullptr);
+  tables_ = tables;
+  table_ = tables_->Table(waveform_, step_ * tables_->SamplingRate());
+}
+
+void WavetableOscillator::ProcessParameters(void) {
+  // Nothing to do here: parameters are applied as soon as they are set
+}
+
+Sample WavetableOscillator::operator()(void) {
+  alignas(16) float samples[SampleSize];
+  Process(&samples[0], SampleSize);
+  return VectorMath::Fill(&samples[0]);
+}
+
+void WavetableOscillator::Process(float* const output,
+                                  const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+  OPENMINI_ASSERT(table_ != nullptr);
+
+  const float* const table(table_);
+  const float step(step_);
+  float position(position_);
+  for (unsigned int i(0); i < length; ++i) {
+    // The guard sample allows reading one sample past the table end
+    const float cursor(
+      position * static_cast<float>(synthesizer::kWavetableLength));
+    const unsigned int index(static_cast<unsigned int>(cursor));
+    const float ratio(cursor - static_cast<float>(index));
+    output[i] = table[index] + ratio * (table[index + 1] - table[index]);
+    position += step;
+    if (position >= 1.0f) {
+      position -= 1.0f;
+    }
+  }
+  position_ = position;
+}
+
+void WavetableOscillator::Snapshot(State* state) const {
+  OPENMINI_ASSERT(state != nullptr);
+  state->position = position_;
+  state->step = step_;
+}
+
+void WavetableOscillator::Restore(const State& state) {
+  OPENMINI_ASSERT(state.step >= 0.0f);
+  OPENMINI_ASSERT(state.step <= kWavetableMaxFrequency);
+  position_ = state.position;
+  SetFrequency(state.step);
+}
+
+}  // namespace generators
+}  // namespace openmini
@@ -0,0 +1,117 @@
+/// @filename wavetable_oscillator.h
+/// @brief Wavetable generator reading process-wide tables
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_WAVETABLE_OSCILLATOR_H_
+#define OPENMINI_SRC_SYNTHESIZER_WAVETABLE_OSCILLATOR_H_
+
+#include "soundtailor/src/generators/generator_base.h"
+
+#include "openmini/src/common.h"
+#include "openmini/src/maths.h"
+#include "openmini/src/synthesizer/wavetables.h"
+
+namespace openmini {
+namespace generators {
+
+/// @brief Wavetable generator
+///
+/// Each output sample is one linearly interpolated read from the
+/// band-limited table of the current octave: its cost does not depend on
+/// the waveform, and is lower than DPW ones.
+/// Tables are shared by all generators within the process
+/// (@see Wavetables), each instance only holding its phase and a pointer
+/// to its current table.
+///
+/// Tables are not owned: they are given by the user, who keeps them alive
+/// as long as the generator uses them (@see SetTables()). Nothing is
+/// acquired nor released here, so that all methods are real-time safe.
+/// The generator must not be run before being given its tables.
+///
+/// As for SoundTailor generators, the phase is within [-1.0f ; 1.0f] and
+/// the normalized frequency within [0.0f ; 0.5f].
+class WavetableOscillator : public soundtailor::generators::Generator_Base {
+ public:
+  /// @brief Whole generator state, trivially copyable
+  ///
+  /// The tables are not part of it, being shared
+  struct State {
+    float position;  ///< Phase, within [0.0f ; 1.0f[
+    float step;  ///< Phase increment, the normalized frequency
+  };
+
+  /// @brief Default constructor
+  ///
+  /// @param[in]  waveform    Waveform of the generator
+  /// @param[in]  phase       Phase to initialize the generator to
+  explicit WavetableOscillator(const Waveform::Type waveform,
+                               const float phase = 0.0f);
+  virtual ~WavetableOscillator();
+
+  virtual void SetPhase(const float phase);
+  virtual void SetFrequency(const float frequency);
+  virtual void ProcessParameters(void);
+
+  /// @brief Set the tables the generator reads from
+  ///
+  /// Tables are not owned, the user has to keep them alive as long as
+  /// they are used. Their sampling rate is the one frequencies
+  /// are normalized with.
+  ///
+  /// @param[in]  tables    Tables to read from
+  void SetTables(const synthesizer::Wavetables* tables);
+
+  /// @brief Process function for one Sample, @see Process()
+  virtual Sample operator()(void);
+
+  /// @brief Process function for one buffer
+  ///
+  /// @param[out] output    Output buffer to write into
+  /// @param[in]  length    Buffer length
+  void Process(float* const output, const unsigned int length);
+
+  /// @brief Capture the whole generator state
+  ///
+  /// @param[out] state   State to write into
+  void Snapshot(State* state) const;
+
+  /// @brief Restore a previously captured state
+  ///
+  /// The generator waveform is kept: the state only holds its phase
+  /// and frequency.
+  ///
+  /// @param[in]  state   State to restore
+  void Restore(const State& state);
+
+ private:
+  // No copy nor assignment operator for this class
+  WavetableOscillator(const WavetableOscillator& right);
+  WavetableOscillator& operator=(const WavetableOscillator& right);
+
+  const synthesizer::Wavetables* tables_;  ///< Shared tables, not owned
+  const float* table_;  ///< Current octave table
+  const Waveform::Type waveform_;  ///< Waveform of the generator
+  float position_;  ///< Phase, within [0.0f ; 1.0f[
+  float step_;  ///< Phase increment, the normalized frequency
+};
+
+}  // namespace generators
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_WAVETABLE_OSCILLATOR_H_
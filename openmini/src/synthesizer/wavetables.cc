@@ -0,0 +1,308 @@
+/// @filename wavetables.cc
+/// @brief Process-wide band-limited wavetables - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/wavetables.h"
+
+// std::fill, std::max, std::min
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+// std::remove, std::rename
+#include <cstdio>
+// std::memcpy
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#if (defined(__unix__) || defined(__APPLE__))
+  #define _USE_MAPPED_TABLES 1
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#else
+  #define _USE_MAPPED_TABLES 0
+#endif
+
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Count of samples of one table, including its guard sample
+static const unsigned int kTableSize(kWavetableLength + 1);
+/// @brief Count of samples of all tables
+static const unsigned int kTablesSize(Waveform::kCount
+                                      * kWavetableOctavesCount
+                                      * kTableSize);
+/// @brief Highest harmonic a table can hold
+static const unsigned int kMaxHarmonic(kWavetableLength / 2 - 1);
+
+/// @brief Tables files header, followed by all tables
+struct TablesHeader {
+  uint32_t magic;  ///< Always kTablesMagic
+  uint32_t version;  ///< Always kTablesVersion
+  float sampling_rate;  ///< Sampling rate the tables were built for
+  uint32_t length;  ///< Tables length, kWavetableLength
+  uint32_t octaves;  ///< Octaves count, kWavetableOctavesCount
+  uint32_t waveforms;  ///< Waveforms count, Waveform::kCount
+};
+/// @brief Tables files magic number ("OMWT")
+static const uint32_t kTablesMagic(0x54574D4F);
+/// @brief Tables files format version
+static const uint32_t kTablesVersion(1);
+/// @brief Tables files size, in bytes
+static const size_t kTablesFileSize(sizeof(TablesHeader)
+                                    + kTablesSize * sizeof(float));
+
+/// @brief Process-wide tables instances, and their users count
+struct Registered {
+  Wavetables* tables;
+  unsigned int references;
+};
+static std::map<float, Registered> tables_instances;
+static std::string tables_directory;
+static std::mutex tables_mutex;
+
+const Wavetables* Wavetables::Acquire(const float sampling_rate) {
+  OPENMINI_ASSERT(sampling_rate > 0.0f);
+
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  Registered& registered(tables_instances[sampling_rate]);
+  if (nullptr == registered.tables) {
+    registered.tables = new Wavetables(sampling_rate);
+    registered.references = 0;
+  }
+  registered.references += 1;
+  return registered.tables;
+}
+
+void Wavetables::Release(const Wavetables* tables) {
+  OPENMINI_ASSERT(tables != nullptr);
+
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  std::map<float, Registered>::iterator registered(
+    tables_instances.find(tables->SamplingRate()));
+  OPENMINI_ASSERT(registered != tables_instances.end());
+  OPENMINI_ASSERT(registered->second.tables == tables);
+  OPENMINI_ASSERT(registered->second.references > 0);
+  registered->second.references -= 1;
+  if (0 == registered->second.references) {
+    delete registered->second.tables;
+    tables_instances.erase(registered);
+  }
+}
+
+void Wavetables::SetDirectory(const std::string& directory) {
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  tables_directory = directory;
+#if (_USE_MAPPED_TABLES)
+  if (!directory.empty()) {
+    // Already existing directories are fine
+    mkdir(directory.c_str(), 0755);
+  }
+#endif  // (_USE_MAPPED_TABLES)
+}
+
+unsigned int Wavetables::InstancesCount(void) {
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  return static_cast<unsigned int>(tables_instances.size());
+}
+
+const float* Wavetables::Table(const Waveform::Type waveform,
+                               const float frequency) const {
+  OPENMINI_ASSERT(waveform < Waveform::kCount);
+  OPENMINI_ASSERT(frequency >= 0.0f);
+
+  unsigned int octave(0);
+  if (frequency > kWavetableLowestFrequency) {
+    octave = std::min(
+      static_cast<unsigned int>(std::log2(frequency
+                                          / kWavetableLowestFrequency)),
+      kWavetableOctavesCount - 1);
+  }
+  return &data_[(waveform * kWavetableOctavesCount + octave) * kTableSize];
+}
+
+float Wavetables::SamplingRate(void) const {
+  return sampling_rate_;
+}
+
+bool Wavetables::IsMapped(void) const {
+  return mapping_ != nullptr;
+}
+
+Wavetables::Wavetables(const float sampling_rate)
+    : sampling_rate_(sampling_rate),
+      data_(nullptr),
+      built_(nullptr),
+      mapping_(nullptr),
+      mapping_size_(0) {
+  // Called with tables_mutex locked
+  const std::string directory(tables_directory);
+  const std::string path(directory
+                         + "/wavetables_"
+                         + std::to_string(static_cast<unsigned int>(
+                             Round(sampling_rate)))
+                         + ".tables");
+  if (directory.empty() || !Map(path)) {
+    Build();
+    if (!directory.empty()) {
+      Save(path);
+    }
+  }
+}
+
+Wavetables::~Wavetables() {
+#if (_USE_MAPPED_TABLES)
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+#endif  // (_USE_MAPPED_TABLES)
+  Deallocate(built_);
+}
+
+void Wavetables::Build(void) {
+  built_ = static_cast<float*>(Allocate(kTablesSize * sizeof(float)));
+  OPENMINI_ASSERT(built_ != nullptr);
+
+  // Harmonics phases are exact multiples of the table step:
+  // all of them are read from one sine period
+  std::vector<double> sine(kWavetableLength);
+  for (unsigned int i(0); i < kWavetableLength; ++i) {
+    sine[i] = std::sin(2.0 * Pi * i / kWavetableLength);
+  }
+  const double nyquist(0.5 * sampling_rate_);
+  std::vector<double> sum(kWavetableLength);
+  for (unsigned int waveform(0); waveform < Waveform::kCount; ++waveform) {
+    std::fill(sum.begin(), sum.end(), 0.0);
+    // Lower octaves hold all the harmonics of the higher ones:
+    // they are built from the highest, only adding the missing harmonics
+    unsigned int harmonics(0);
+    for (int octave(kWavetableOctavesCount - 1); octave >= 0; --octave) {
+      const double highest_fundamental(kWavetableLowestFrequency
+                                       * std::pow(2.0, octave + 1));
+      const unsigned int octave_harmonics(std::max(1u, std::min(
+        kMaxHarmonic,
+        static_cast<unsigned int>(nyquist / highest_fundamental))));
+      for (unsigned int harmonic(harmonics + 1);
+           harmonic <= octave_harmonics;
+           ++harmonic) {
+        double amplitude(0.0);
+        unsigned int offset(0);
+        if (Waveform::kSawtooth == waveform) {
+          // Rising from -1 to 1: -2/pi sum(sin(k.x) / k)
+          amplitude = -2.0 / (Pi * harmonic);
+        } else if (harmonic % 2 == 1) {
+          // Starting from -1: -8/pi^2 sum(cos(k.x) / k^2), k odd
+          amplitude = -8.0 / (Pi * Pi * harmonic * harmonic);
+          offset = kWavetableLength / 4;
+        }
+        if (amplitude != 0.0) {
+          for (unsigned int i(0); i < kWavetableLength; ++i) {
+            sum[i] += amplitude
+                      * sine[(harmonic * i + offset) % kWavetableLength];
+          }
+        }
+      }
+      harmonics = octave_harmonics;
+      float* const table(
+        &built_[(waveform * kWavetableOctavesCount + octave) * kTableSize]);
+      for (unsigned int i(0); i < kWavetableLength; ++i) {
+        table[i] = static_cast<float>(sum[i]);
+      }
+      table[kWavetableLength] = table[0];
+    }
+  }
+  data_ = built_;
+}
+
+bool Wavetables::Map(const std::string& path) {
+#if (_USE_MAPPED_TABLES)
+  const int file(open(path.c_str(), O_RDONLY));
+  if (file < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  void* mapped(MAP_FAILED);
+  if ((fstat(file, &file_stat) == 0)
+      && (static_cast<size_t>(file_stat.st_size) == kTablesFileSize)) {
+    // Shared pages: all processes mapping the file use the same memory
+    mapped = mmap(nullptr, kTablesFileSize, PROT_READ, MAP_SHARED, file, 0);
+  }
+  close(file);
+  if (MAP_FAILED == mapped) {
+    return false;
+  }
+  TablesHeader header;
+  std::memcpy(&header, mapped, sizeof(header));
+  if ((header.magic != kTablesMagic)
+      || (header.version != kTablesVersion)
+      || (header.sampling_rate != sampling_rate_)
+      || (header.length != kWavetableLength)
+      || (header.octaves != kWavetableOctavesCount)
+      || (header.waveforms != Waveform::kCount)) {
+    munmap(mapped, kTablesFileSize);
+    return false;
+  }
+  mapping_ = mapped;
+  mapping_size_ = kTablesFileSize;
+  data_ = reinterpret_cast<const float*>(static_cast<const char*>(mapped)
+                                         + sizeof(TablesHeader));
+  return true;
+#else  // (_USE_MAPPED_TABLES)
+  IGNORE(path);
+  return false;
+#endif  // (_USE_MAPPED_TABLES)
+}
+
+void Wavetables::Save(const std::string& path) const {
+#if (_USE_MAPPED_TABLES)
+  const TablesHeader header = {kTablesMagic,
+                               kTablesVersion,
+                               sampling_rate_,
+                               kWavetableLength,
+                               kWavetableOctavesCount,
+                               Waveform::kCount};
+  // Written aside then renamed: a tables file is always complete
+  const std::string temporary_path(path + ".tmp");
+  {
+    std::ofstream file(temporary_path.c_str(),
+                       std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data_),
+               kTablesSize * sizeof(float));
+    if (!file.good()) {
+      std::remove(temporary_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+  }
+#else  // (_USE_MAPPED_TABLES)
+  IGNORE(path);
+#endif  // (_USE_MAPPED_TABLES)
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
@@ -0,0 +1,120 @@
+/// @filename wavetables.h
+/// @brief Process-wide band-limited wavetables
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_WAVETABLES_H_
+#define OPENMINI_SRC_SYNTHESIZER_WAVETABLES_H_
+
+#include <string>
+
+#include "openmini/src/common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Length of one table, a power of 2 - without its guard sample
+static const unsigned int kWavetableLength(2048);
+/// @brief Count of tables, one per octave, for each waveform
+static const unsigned int kWavetableOctavesCount(11);
+/// @brief Lowest fundamental frequency of the first octave, in Hz
+static const float kWavetableLowestFrequency(20.0f);
+
+/// @brief Band-limited mip-mapped tables for one sampling rate
+///
+/// For each waveform there is one table per octave, each table holding
+/// all harmonics of the octave highest fundamental below Nyquist.
+/// Tables are immutable once built, and shared by all users
+/// within the process: there is one instance per sampling rate,
+/// created by the first Acquire() and destroyed by the last Release().
+///
+/// Building the tables may take a few milliseconds: when a directory
+/// is given, built tables are saved into it, and later instances
+/// - e.g. in other processes - directly map them from there.
+/// Mapping relies on POSIX (mmap); on other platforms
+/// tables are always built.
+class Wavetables {
+ public:
+  /// @brief Retrieve the tables for the given sampling rate,
+  /// creating them if required
+  ///
+  /// @param[in]  sampling_rate   Sampling rate, in Hz
+  static const Wavetables* Acquire(const float sampling_rate);
+
+  /// @brief Release tables previously acquired, destroying them if unused
+  ///
+  /// @param[in]  tables    Tables to release
+  static void Release(const Wavetables* tables);
+
+  /// @brief Set the directory tables are saved into and mapped from
+  ///
+  /// Already existing tables are not affected.
+  ///
+  /// @param[in]  directory   Tables directory, empty to disable it
+  static void SetDirectory(const std::string& directory);
+
+  /// @brief Count of tables instances within the process
+  static unsigned int InstancesCount(void);
+
+  /// @brief Retrieve the table for the given waveform and fundamental
+  ///
+  /// Tables are kWavetableLength + 1 long, the last sample being a copy
+  /// of the first one for interpolation purpose.
+  ///
+  /// @param[in]  waveform    Waveform of the table
+  /// @param[in]  frequency   Fundamental frequency, in Hz
+  const float* Table(const Waveform::Type waveform,
+                     const float frequency) const;
+
+  /// @brief Sampling rate the tables were built for
+  float SamplingRate(void) const;
+
+  /// @brief Check if the tables were mapped from a file
+  bool IsMapped(void) const;
+
+ private:
+  /// @brief Only Acquire() is allowed to create tables
+  explicit Wavetables(const float sampling_rate);
+  ~Wavetables();
+
+  // No copy nor assignment operator for this class
+  Wavetables(const Wavetables& right);
+  Wavetables& operator=(const Wavetables& right);
+
+  /// @brief Build all tables through additive synthesis
+  void Build(void);
+
+  /// @brief Map tables from the given file
+  ///
+  /// @return true if a valid tables file was found and mapped
+  bool Map(const std::string& path);
+
+  /// @brief Save all tables into the given file
+  void Save(const std::string& path) const;
+
+  const float sampling_rate_;  ///< Sampling rate, in Hz
+  const float* data_;  ///< All tables, by waveform then octave
+  float* built_;  ///< Memory data_ lives in when built
+  void* mapping_;  ///< File mapping data_ lives in when mapped
+  size_t mapping_size_;  ///< File mapping size, in bytes
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_WAVETABLES_H_
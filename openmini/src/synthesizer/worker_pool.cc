@@ -0,0 +1,399 @@
+/// @filename worker_pool.cc
+/// @brief Process-wide worker pool - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/src/synthesizer/worker_pool.h"
+
+// std::max, std::min
+#include <algorithm>
+#include <chrono>
+// INT_MAX
+#include <climits>
+#include <mutex>
+// placement new
+#include <new>
+
+#if defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <time.h>
+  #include <unistd.h>
+#else
+  #include <condition_variable>
+#endif
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Maximum duration a thread sleeps before checking again
+///
+/// Sleeping threads are always woken up, this is only a safety net.
+static const std::chrono::microseconds kWorkerIdlePeriod(10000);
+
+/// @brief Count of spinning iterations when collecting a job being rendered,
+/// before going to sleep until it is done
+static const unsigned int kCollectSpinCount(4096);
+
+#if !defined(__linux__)
+/// @brief Wait-on-address emulation, for platforms without futexes
+static std::mutex wait_mutex;
+static std::condition_variable wait_condition;
+#endif  // !defined(__linux__)
+
+/// @brief Sleep while the given word holds the expected value
+///
+/// May return early (spuriously, or after the timeout):
+/// the caller has to check its condition again.
+static void WaitOnAddress(std::atomic<int>* address,
+                          const int expected,
+                          const std::chrono::microseconds timeout) {
+#if defined(__linux__)
+  static_assert(sizeof(std::atomic<int>) == sizeof(int),
+                "Futexes require plain integers");
+  timespec duration;
+  duration.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+  duration.tv_nsec = static_cast<long>(  // NOLINT
+    (timeout.count() % 1000000) * 1000);
+  syscall(SYS_futex,
+          reinterpret_cast<int*>(address),
+          FUTEX_WAIT_PRIVATE,
+          expected,
+          &duration,
+          nullptr,
+          0);
+#else
+  std::unique_lock<std::mutex> lock(wait_mutex);
+  if (address->load(std::memory_order_acquire) == expected) {
+    wait_condition.wait_for(lock, timeout);
+  }
+#endif  // defined(__linux__)
+}
+
+/// @brief Wake up to the given count of threads sleeping on the given word
+///
+/// The word has to be changed beforehand.
+static void WakeAddress(std::atomic<int>* address, const int count) {
+#if defined(__linux__)
+  syscall(SYS_futex,
+          reinterpret_cast<int*>(address),
+          FUTEX_WAKE_PRIVATE,
+          count,
+          nullptr,
+          nullptr,
+          0);
+#else
+  // Taking the lock: a waiter is either not checking the word yet,
+  // or already waiting
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex);
+  }
+  wait_condition.notify_all();
+#endif  // defined(__linux__)
+}
+
+/// @brief Hint the CPU that the calling thread is spinning
+static inline void Pause(void) {
+#if (_USE_SSE)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif  // (_USE_SSE)
+}
+
+/// @brief Process-wide pool instance, and its users count
+///
+/// The instance is built into static storage: slots are cache-line aligned,
+/// beyond what operator new guarantees.
+alignas(WorkerPool) static unsigned char pool_storage[sizeof(WorkerPool)];
+static WorkerPool* pool_instance(nullptr);
+static unsigned int pool_references(0);
+static std::mutex pool_mutex;
+
+WorkerPool* WorkerPool::Acquire(void) {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (nullptr == pool_instance) {
+    pool_instance = new (pool_storage) WorkerPool();
+  }
+  pool_references += 1;
+  return pool_instance;
+}
+
+void WorkerPool::Release(void) {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  OPENMINI_ASSERT(pool_references > 0);
+  pool_references -= 1;
+  if (0 == pool_references) {
+    pool_instance->~WorkerPool();
+    pool_instance = nullptr;
+  }
+}
+
+WorkerPool::Slot::Slot()
+    : synth(nullptr),
+      buffer(nullptr),
+      length(0),
+      state(kIdle),
+      collecting(false) {
+  // Nothing to do here for now
+}
+
+WorkerPool::WorkerPool()
+    : slots_(),
+      workers_(),
+      running_(true),
+      pending_(0),
+      wakeups_(0),
+      sleepers_(0) {
+  // The host audio thread being busy as well, one core is left to it
+  const unsigned int threads_count(
+    std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  for (unsigned int i(0); i < threads_count; ++i) {
+    workers_.push_back(std::thread(&WorkerPool::Run, this));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  running_.store(false, std::memory_order_release);
+  Wake(INT_MAX);
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  for (auto& slot : slots_) {
+    Deallocate(slot.buffer);
+    slot.buffer = nullptr;
+  }
+}
+
+int WorkerPool::Register(Synthesizer* synth,
+                         const unsigned int max_block_size) {
+  OPENMINI_ASSERT(synth != nullptr);
+  OPENMINI_ASSERT(max_block_size > 0);
+
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  for (unsigned int slot_id(0); slot_id < kMaxPooledSynthesizers; ++slot_id) {
+    Slot& slot(slots_[slot_id]);
+    if (nullptr == slot.synth) {
+      slot.buffer = Allocate<float>(max_block_size);
+      OPENMINI_ASSERT(slot.buffer != nullptr);
+      slot.length = 0;
+      slot.synth = synth;
+      slot.state.store(kIdle, std::memory_order_release);
+      return static_cast<int>(slot_id);
+    }
+  }
+  return -1;
+}
+
+void WorkerPool::Unregister(const int slot_id) {
+  OPENMINI_ASSERT(slot_id >= 0);
+  OPENMINI_ASSERT(slot_id < static_cast<int>(kMaxPooledSynthesizers));
+
+  Collect(slot_id);
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  Slot& slot(slots_[slot_id]);
+  Deallocate(slot.buffer);
+  slot.buffer = nullptr;
+  slot.synth = nullptr;
+}
+
+void WorkerPool::Submit(const int slot_id, const unsigned int length) {
+  OPENMINI_ASSERT(slot_id >= 0);
+  OPENMINI_ASSERT(slot_id < static_cast<int>(kMaxPooledSynthesizers));
+  Slot& slot(slots_[slot_id]);
+  OPENMINI_ASSERT(slot.synth != nullptr);
+  OPENMINI_ASSERT(slot.state.load(std::memory_order_relaxed) != kPending);
+  OPENMINI_ASSERT(slot.state.load(std::memory_order_relaxed) != kRunning);
+
+  slot.length = length;
+  pending_.fetch_add(1, std::memory_order_seq_cst);
+  // Release: synthesizer changes and length are visible to the worker
+  slot.state.store(kPending, std::memory_order_release);
+  Wake(1);
+}
+
+const float* WorkerPool::Collect(const int slot_id) {
+  OPENMINI_ASSERT(slot_id >= 0);
+  OPENMINI_ASSERT(slot_id < static_cast<int>(kMaxPooledSynthesizers));
+  Slot& slot(slots_[slot_id]);
+
+  if (kIdle == slot.state.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  // Not picked yet: no need to wait for a worker
+  TryRender(&slot);
+  // Being rendered: the worker should be done soon
+  for (unsigned int spin(0);
+       (spin < kCollectSpinCount)
+       && (slot.state.load(std::memory_order_acquire) != kDone);
+       ++spin) {
+    Pause();
+  }
+  while (slot.state.load(std::memory_order_acquire) != kDone) {
+    // Seen by the worker either before or after it flags the job as done
+    slot.collecting.store(true, std::memory_order_seq_cst);
+    WaitOnAddress(&slot.state, kRunning, kWorkerIdlePeriod);
+  }
+  slot.collecting.store(false, std::memory_order_relaxed);
+  slot.state.store(kIdle, std::memory_order_relaxed);
+  return slot.buffer;
+}
+
+unsigned int WorkerPool::ThreadsCount(void) const {
+  return static_cast<unsigned int>(workers_.size());
+}
+
+void WorkerPool::Run(void) {
+  while (running_.load(std::memory_order_acquire)) {
+    bool rendered(false);
+    if (pending_.load(std::memory_order_acquire) > 0) {
+      for (auto& slot : slots_) {
+        rendered |= TryRender(&slot);
+      }
+    }
+    if (!rendered) {
+      Sleep();
+    }
+  }
+}
+
+void WorkerPool::Sleep(void) {
+  // Either Submit() sees this worker going to sleep and wakes it up,
+  // or this worker sees the pending job
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  const int wakeups(wakeups_.load(std::memory_order_seq_cst));
+  if ((0 == pending_.load(std::memory_order_seq_cst))
+      && running_.load(std::memory_order_acquire)) {
+    // Returns at once if a wakeup happened since the counter was read
+    WaitOnAddress(&wakeups_, wakeups, kWorkerIdlePeriod);
+  }
+  sleepers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void WorkerPool::Wake(const int count) {
+  wakeups_.fetch_add(1, std::memory_order_seq_cst);
+  // No system call if all workers are busy
+  if ((sleepers_.load(std::memory_order_seq_cst) > 0)
+      || !running_.load(std::memory_order_acquire)) {
+    WakeAddress(&wakeups_, count);
+  }
+}
+
+bool WorkerPool::TryRender(Slot* slot) {
+  int expected(kPending);
+  if (!slot->state.compare_exchange_strong(expected,
+                                           kRunning,
+                                           std::memory_order_acquire)) {
+    return false;
+  }
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+  slot->synth->ProcessAudio(slot->buffer, slot->length);
+  // Release: rendered samples are visible to the collecting thread
+  slot->state.store(kDone, std::memory_order_seq_cst);
+  if (slot->collecting.load(std::memory_order_seq_cst)) {
+    WakeAddress(&slot->state, INT_MAX);
+  }
+  return true;
+}
+
+PooledRenderer::PooledRenderer(Synthesizer* synth,
+                               const unsigned int max_block_size)
+    : synth_(synth),
+      pool_(WorkerPool::Acquire()),
+      slot_id_(-1),
+      latency_(max_block_size),
+      delay_(max_block_size),
+      pending_length_(0),
+      silent_length_(0),
+      silent_output_(true) {
+  OPENMINI_ASSERT(synth != nullptr);
+  OPENMINI_ASSERT(max_block_size > 0);
+  slot_id_ = pool_->Register(synth, max_block_size);
+  if (IsPooled()) {
+    // The whole output is delayed by the max block size
+    const std::vector<float> silence(latency_, 0.0f);
+    delay_.Push(&silence[0], latency_);
+    silent_length_ = latency_;
+  }
+}
+
+PooledRenderer::~PooledRenderer() {
+  if (IsPooled()) {
+    pool_->Unregister(slot_id_);
+  }
+  WorkerPool::Release();
+}
+
+void PooledRenderer::Sync(void) {
+  if (pending_length_ > 0) {
+    const float* rendered(pool_->Collect(slot_id_));
+    OPENMINI_ASSERT(rendered != nullptr);
+    delay_.Push(rendered, pending_length_);
+    // The synthesizer is not being rendered anymore
+    silent_length_ = synth_->IsOutputSilent()
+                     ? silent_length_ + pending_length_
+                     : 0;
+    pending_length_ = 0;
+  }
+}
+
+void PooledRenderer::ProcessAudio(float* const output,
+                                  const unsigned int length) {
+  OPENMINI_ASSERT(output != nullptr);
+
+  if (!IsPooled()) {
+    synth_->ProcessAudio(output, length);
+    silent_output_ = synth_->IsOutputSilent();
+    return;
+  }
+  silent_output_ = true;
+  // Neither the slot buffer nor the delay may hold more than the latency
+  unsigned int position(0);
+  do {
+    const unsigned int chunk(std::min(latency_, length - position));
+    Sync();
+    // Popped samples are only zeros if the whole delay ends with zeros
+    silent_output_ = silent_output_ && (silent_length_ >= delay_.Size());
+    delay_.Pop(&output[position], chunk);
+    silent_length_ = std::min(silent_length_, delay_.Size());
+    if (chunk > 0) {
+      pool_->Submit(slot_id_, chunk);
+      pending_length_ = chunk;
+    }
+    position += chunk;
+  } while (position < length);
+}
+
+bool PooledRenderer::IsOutputSilent(void) const {
+  return silent_output_;
+}
+
+unsigned int PooledRenderer::Latency(void) const {
+  return IsPooled() ? latency_ : 0;
+}
+
+bool PooledRenderer::IsPooled(void) const {
+  return slot_id_ >= 0;
+}
+
+}  // namespace synthesizer
+}  // namespace openmini
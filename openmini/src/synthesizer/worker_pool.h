@@ -0,0 +1,220 @@
+/// @filename worker_pool.h
+/// @brief Process-wide worker pool rendering many synthesizers in parallel
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_SRC_SYNTHESIZER_WORKER_POOL_H_
+#define OPENMINI_SRC_SYNTHESIZER_WORKER_POOL_H_
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "openmini/src/synthesizer/ringbuffer.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+#include "openmini/src/synthesizer/synthesizer_common.h"
+
+namespace openmini {
+namespace synthesizer {
+
+/// @brief Maximum count of synthesizers registered at once into the pool
+static const unsigned int kMaxPooledSynthesizers(128);
+
+/// @brief Process-wide pool of worker threads rendering synthesizers blocks
+///
+/// There is one pool per loaded library, created by the first Acquire()
+/// and destroyed by the last Release(): each user (e.g. plugin instance)
+/// holds a reference to it.
+///
+/// Each synthesizer is registered into its own slot; rendering one block
+/// for a slot is submitted from the audio thread, picked by any idle worker,
+/// and later collected from the audio thread again.
+/// Collecting a job not picked yet renders it on the collecting thread,
+/// so that the audio thread never waits for a sleeping worker.
+/// Collecting a job being rendered spins for a bounded time, then sleeps
+/// until the worker is done.
+///
+/// Idle workers sleep on a wakeup counter, bumped by each submission:
+/// a submission happening while a worker is going to sleep is never lost.
+///
+/// Submitting and collecting never lock nor allocate
+/// (waking a worker up is a futex call on Linux, a short lock elsewhere);
+/// registering and acquiring do both, and should not be done from within
+/// the audio thread.
+///
+/// @see PooledRenderer for the actual use from an instance point of view
+class WorkerPool {
+ public:
+  /// @brief Retrieve the process-wide pool, creating it if required
+  static WorkerPool* Acquire(void);
+
+  /// @brief Release the process-wide pool, destroying it if unused
+  static void Release(void);
+
+  /// @brief Register a synthesizer into a free slot
+  ///
+  /// @param[in]  synth             Synthesizer to render
+  /// @param[in]  max_block_size    Maximum length of a block to render
+  ///
+  /// @return the slot ID, -1 if all slots are used
+  int Register(Synthesizer* synth, const unsigned int max_block_size);
+
+  /// @brief Free a slot, waiting for its pending job if required
+  ///
+  /// @param[in]  slot_id   Slot to free
+  void Unregister(const int slot_id);
+
+  /// @brief (Audio thread) Submit the rendering of one block
+  ///
+  /// The synthesizer must not be used until the block is collected.
+  ///
+  /// @param[in]  slot_id   Slot to render
+  /// @param[in]  length    Block length, at most the max block size
+  void Submit(const int slot_id, const unsigned int length);
+
+  /// @brief (Audio thread) Wait for the last submitted block to be rendered
+  ///
+  /// Renders it on the calling thread if no worker picked it yet.
+  ///
+  /// @param[in]  slot_id   Slot to collect
+  ///
+  /// @return the rendered block, nullptr if nothing was submitted
+  const float* Collect(const int slot_id);
+
+  /// @brief Worker threads count
+  unsigned int ThreadsCount(void) const;
+
+ private:
+  /// @brief Slot jobs states
+  enum State {
+    kIdle = 0,
+    kPending,
+    kRunning,
+    kDone
+  };
+
+  /// @brief One registered synthesizer and its rendered block
+  ///
+  /// Each slot is on its own cache line(s): slots are written by
+  /// different audio and worker threads at once.
+  struct alignas(kCacheLineSize) Slot {
+    Slot();
+
+    Synthesizer* synth;  ///< Registered synthesizer, nullptr if unused
+    float* buffer;  ///< Rendered block
+    unsigned int length;  ///< Length of the block to be rendered
+    std::atomic<int> state;  ///< Job state
+    std::atomic<bool> collecting;  ///< A thread sleeps until the job is done
+  };
+
+  WorkerPool();
+  ~WorkerPool();
+  // No copy nor assignment operator for this class
+  WorkerPool(const WorkerPool& right);
+  WorkerPool& operator=(const WorkerPool& right);
+
+  /// @brief Worker threads loop
+  void Run(void);
+
+  /// @brief Pick and render the given slot job if it is pending
+  ///
+  /// @return true if the job was rendered here
+  bool TryRender(Slot* slot);
+
+  /// @brief Put the calling worker to sleep, unless jobs are pending
+  void Sleep(void);
+
+  /// @brief Wake up to the given count of sleeping workers
+  void Wake(const int count);
+
+  std::array<Slot, kMaxPooledSynthesizers> slots_;  ///< Registered slots
+  std::vector<std::thread> workers_;  ///< Worker threads
+  std::atomic<bool> running_;  ///< Worker threads should keep going
+  std::atomic<unsigned int> pending_;  ///< Count of jobs not picked yet
+  std::atomic<int> wakeups_;  ///< Bumped on each wakeup, workers sleep on it
+  std::atomic<unsigned int> sleepers_;  ///< Count of workers going to sleep
+};
+
+/// @brief Renders one synthesizer through the process-wide worker pool
+///
+/// Each call to ProcessAudio() returns the previously rendered samples
+/// and submits the rendering of the next ones, hence output is delayed by
+/// the maximum block size: this has to be reported to the host as latency.
+///
+/// The synthesizer is being rendered between two calls to ProcessAudio():
+/// Sync() has to be called before changing it (notes, parameters...).
+///
+/// renderer.Sync();
+/// synth.NoteOn(note);
+/// renderer.ProcessAudio(output, length);
+class PooledRenderer {
+ public:
+  /// @brief Default constructor: acquires the pool and registers into it
+  ///
+  /// Falls back on rendering on the calling thread if the pool is full.
+  ///
+  /// @param[in]  synth             Synthesizer to render
+  /// @param[in]  max_block_size    Maximum ProcessAudio() length
+  PooledRenderer(Synthesizer* synth, const unsigned int max_block_size);
+  ~PooledRenderer();
+
+  /// @brief Wait for the block being rendered, if any
+  ///
+  /// Once done the synthesizer may be safely changed.
+  void Sync(void);
+
+  /// @brief Retrieve rendered samples and render the next ones
+  ///
+  /// Blocks longer than the max block size are split into chunks,
+  /// each one waiting for the previous one to be rendered.
+  ///
+  /// @param[out]   output      Output buffer to write into
+  /// @param[in]    length      Output buffer length
+  void ProcessAudio(float* const output, const unsigned int length);
+
+  /// @brief Check if the last ProcessAudio() output was only zeros,
+  /// @see Synthesizer::IsOutputSilent()
+  bool IsOutputSilent(void) const;
+
+  /// @brief Output delay, in samples
+  unsigned int Latency(void) const;
+
+  /// @brief Returns true if actually rendered through the pool
+  bool IsPooled(void) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  PooledRenderer(const PooledRenderer& right);
+  PooledRenderer& operator=(const PooledRenderer& right);
+
+  Synthesizer* synth_;  ///< Rendered synthesizer
+  WorkerPool* pool_;  ///< Process-wide pool
+  int slot_id_;  ///< Registered slot, -1 if not pooled
+  const unsigned int latency_;  ///< Output delay (max block size)
+  RingBuffer<float> delay_;  ///< Rendered samples waiting to be output
+  unsigned int pending_length_;  ///< Length of the block being rendered,
+                                 ///< 0 if none
+  unsigned int silent_length_;  ///< Count of zeros ending the delay
+  bool silent_output_;  ///< True if the last output was only zeros
+};
+
+}  // namespace synthesizer
+}  // namespace openmini
+
+#endif  // OPENMINI_SRC_SYNTHESIZER_WORKER_POOL_H_
@@ -0,0 +1,233 @@
+/// @filename perf_counters.cc
+/// @brief Hardware performance counters for performance tests - implementation
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/tests/perf_counters.h"
+
+#include <cstdio>
+// std::memset
+#include <cstring>
+
+#if (defined(_ENABLE_PERF_COUNTERS) && defined(__linux__))
+  #define _USE_PERF_EVENTS 1
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#else
+  #define _USE_PERF_EVENTS 0
+#endif
+
+#if defined(__linux__)
+  // sysconf
+  #include <unistd.h>
+#endif
+
+#include "openmini/src/common.h"
+
+#if (_USE_PERF_EVENTS)
+/// @brief Open one counter for the current thread, on any cpu
+///
+/// @return the counter file descriptor, -1 if it could not be opened
+static int OpenCounter(const PerfEvent::Type event) {
+  perf_event_attr attributes;
+  std::memset(&attributes, 0, sizeof(attributes));
+  attributes.size = sizeof(attributes);
+  attributes.disabled = 1;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+                           | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  switch (event) {
+    case(PerfEvent::kInstructions): {
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+      break;
+    }
+    case(PerfEvent::kCycles): {
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+      break;
+    }
+    case(PerfEvent::kL1DataMisses): {
+      attributes.type = PERF_TYPE_HW_CACHE;
+      attributes.config = PERF_COUNT_HW_CACHE_L1D
+                          | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                          | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    }
+    case(PerfEvent::kLastLevelMisses): {
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+      break;
+    }
+    case(PerfEvent::kBranchMisses): {
+      attributes.type = PERF_TYPE_HARDWARE;
+      attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+      break;
+    }
+    default: {
+      // Should never happen
+      OPENMINI_ASSERT(false);
+    }
+  }
+  return static_cast<int>(syscall(__NR_perf_event_open,
+                                  &attributes,
+                                  0,  // Current thread
+                                  -1,  // Any cpu
+                                  -1,  // No group
+                                  0));
+}
+#endif  // (_USE_PERF_EVENTS)
+
+PerfCounters::PerfCounters()
+    : descriptors_(),
+      values_(),
+      start_(),
+      duration_(0.0) {
+  descriptors_.fill(-1);
+  values_.fill(0.0);
+#if (_USE_PERF_EVENTS)
+  for (unsigned int event(0); event < PerfEvent::kCount; ++event) {
+    descriptors_[event] = OpenCounter(static_cast<PerfEvent::Type>(event));
+  }
+#endif  // (_USE_PERF_EVENTS)
+}
+
+PerfCounters::~PerfCounters() {
+#if (_USE_PERF_EVENTS)
+  for (auto& descriptor : descriptors_) {
+    if (descriptor >= 0) {
+      close(descriptor);
+    }
+  }
+#endif  // (_USE_PERF_EVENTS)
+}
+
+void PerfCounters::Start(void) {
+#if (_USE_PERF_EVENTS)
+  for (auto& descriptor : descriptors_) {
+    if (descriptor >= 0) {
+      ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+      ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif  // (_USE_PERF_EVENTS)
+  start_ = std::chrono::high_resolution_clock::now();
+}
+
+void PerfCounters::Stop(void) {
+  const std::chrono::high_resolution_clock::time_point stop(
+    std::chrono::high_resolution_clock::now());
+#if (_USE_PERF_EVENTS)
+  for (auto& descriptor : descriptors_) {
+    if (descriptor >= 0) {
+      ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+  for (unsigned int event(0); event < PerfEvent::kCount; ++event) {
+    const int descriptor(descriptors_[event]);
+    if (descriptor < 0) {
+      continue;
+    }
+    // {value, time enabled, time running}
+    std::uint64_t data[3] = {0, 0, 0};
+    if ((read(descriptor, &data[0], sizeof(data)) != sizeof(data))
+        || (0 == data[2])) {
+      // The counter never actually ran: consider it unavailable
+      close(descriptor);
+      descriptors_[event] = -1;
+      continue;
+    }
+    // Scale the count if the kernel had to multiplex counters
+    values_[event] = static_cast<double>(data[0])
+                     * static_cast<double>(data[1])
+                     / static_cast<double>(data[2]);
+  }
+#endif  // (_USE_PERF_EVENTS)
+  duration_ = std::chrono::duration<double>(stop - start_).count();
+}
+
+bool PerfCounters::IsAvailable(const PerfEvent::Type event) const {
+  OPENMINI_ASSERT(event < PerfEvent::kCount);
+  return descriptors_[event] >= 0;
+}
+
+double PerfCounters::Get(const PerfEvent::Type event) const {
+  OPENMINI_ASSERT(IsAvailable(event));
+  return values_[event];
+}
+
+double PerfCounters::Duration(void) const {
+  return duration_;
+}
+
+void PerfCounters::Report(const char* name,
+                          const unsigned int samples_count) const {
+  OPENMINI_ASSERT(name != nullptr);
+  OPENMINI_ASSERT(samples_count > 0);
+
+  const double samples(static_cast<double>(samples_count));
+  std::printf("[ PERF     ] %s: %.2f ns/sample",
+              name,
+              duration_ * 1e9 / samples);
+  if (IsAvailable(PerfEvent::kInstructions)
+      && IsAvailable(PerfEvent::kCycles)
+      && (Get(PerfEvent::kCycles) > 0.0)) {
+    std::printf(", IPC %.2f, %.2f cycles/sample",
+                Get(PerfEvent::kInstructions) / Get(PerfEvent::kCycles),
+                Get(PerfEvent::kCycles) / samples);
+  } else {
+    std::printf(", IPC n/a");
+  }
+  const char* kMissesNames[] = {"L1D misses", "LLC misses", "branch misses"};
+  const PerfEvent::Type kMissesEvents[] = {PerfEvent::kL1DataMisses,
+                                           PerfEvent::kLastLevelMisses,
+                                           PerfEvent::kBranchMisses};
+  for (unsigned int i(0); i < 3; ++i) {
+    if (IsAvailable(kMissesEvents[i])) {
+      std::printf(", %.4f %s/sample",
+                  Get(kMissesEvents[i]) / samples,
+                  kMissesNames[i]);
+    } else {
+      std::printf(", %s n/a", kMissesNames[i]);
+    }
+  }
+  std::printf("\n");
+}
+
+size_t GetResidentMemory(void) {
+#if defined(__linux__)
+  std::FILE* statm(std::fopen("/proc/self/statm", "r"));
+  if (nullptr == statm) {
+    return 0;
+  }
+  unsigned long size(0);  // NOLINT
+  unsigned long resident(0);  // NOLINT
+  const int read(std::fscanf(statm, "%lu %lu", &size, &resident));
+  std::fclose(statm);
+  if (read != 2) {
+    return 0;
+  }
+  return static_cast<size_t>(resident)
+         * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 0;
+#endif  // defined(__linux__)
+}
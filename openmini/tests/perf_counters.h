@@ -0,0 +1,105 @@
+/// @filename perf_counters.h
+/// @brief Hardware performance counters for performance tests - declarations
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMINI_TESTS_PERF_COUNTERS_H_
+#define OPENMINI_TESTS_PERF_COUNTERS_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief Hardware events which may be counted
+namespace PerfEvent {
+enum Type {
+  kInstructions = 0,
+  kCycles,
+  kL1DataMisses,
+  kLastLevelMisses,
+  kBranchMisses,
+  kCount
+};
+}  // namespace PerfEvent
+
+/// @brief Hardware performance counters for one measured region
+///
+/// Counters are only collected when built with OPENMINI_ENABLE_PERF_COUNTERS
+/// on Linux (using perf_event_open). Each event is opened separately:
+/// if one of them is not supported by the current machine (virtual machines,
+/// restrictive perf_event_paranoid setting...) it is reported as unavailable
+/// while others are still collected.
+/// The wall-clock duration of the region is always measured.
+///
+/// PerfCounters counters;
+/// counters.Start();
+/// DO_YOUR_STUFF
+/// counters.Stop();
+/// counters.Report("Module", processed_samples_count);
+class PerfCounters {
+ public:
+  /// @brief Default constructor: opens all available counters
+  PerfCounters();
+  ~PerfCounters();
+
+  /// @brief Reset and start all counters
+  void Start(void);
+
+  /// @brief Stop all counters and retrieve their values
+  void Stop(void);
+
+  /// @brief Check if the given event could be counted
+  ///
+  /// @param[in]  event   Event to check
+  bool IsAvailable(const PerfEvent::Type event) const;
+
+  /// @brief Get the given event count for the last measured region
+  ///
+  /// Counts are scaled if the kernel had to multiplex counters.
+  ///
+  /// @param[in]  event   Event to retrieve, has to be available
+  double Get(const PerfEvent::Type event) const;
+
+  /// @brief Last measured region duration, in seconds
+  double Duration(void) const;
+
+  /// @brief Print out IPC and per-sample counts for the last measured region
+  ///
+  /// @param[in]  name            Name of the measured module
+  /// @param[in]  samples_count   Samples count processed within the region
+  void Report(const char* name, const unsigned int samples_count) const;
+
+ private:
+  // No copy nor assignment operator for this class
+  PerfCounters(const PerfCounters& right);
+  PerfCounters& operator=(const PerfCounters& right);
+
+  std::array<int, PerfEvent::kCount> descriptors_;  ///< One per event,
+                                                    ///< -1 if unavailable
+  std::array<double, PerfEvent::kCount> values_;  ///< Last retrieved counts
+  std::chrono::high_resolution_clock::time_point start_;  ///< Region start
+  double duration_;  ///< Last region duration, in seconds
+};
+
+/// @brief Current process resident memory (RSS), in bytes
+///
+/// Only available on Linux (using /proc/self/statm), 0 elsewhere.
+size_t GetResidentMemory(void);
+
+#endif  // OPENMINI_TESTS_PERF_COUNTERS_H_
@@ -0,0 +1,131 @@
+/// @filename tests_arena.cc
+/// @brief Arena specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/arena.h"
+#include "openmini/src/synthesizer/ringbuffer.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::Arena;
+using openmini::synthesizer::kCacheLineSize;
+using openmini::synthesizer::RingBuffer;
+using openmini::synthesizer::Synthesizer;
+
+/// @brief Blocks are cache line aligned, contiguous and within the arena
+TEST(Arena, Alignment) {
+  std::uniform_int_distribution<unsigned int> kSizeDistribution(1, 1024);
+  const unsigned int kBlocksCount(64);
+  std::vector<unsigned int> sizes;
+  size_t capacity(0);
+  for (unsigned int i(0); i < kBlocksCount; ++i) {
+    sizes.push_back(kSizeDistribution(kRandomGenerator));
+    capacity += Arena::AlignedSize(sizes.back());
+  }
+
+  Arena arena(capacity);
+  EXPECT_EQ(capacity, arena.Capacity());
+  const char* expected(nullptr);
+  for (const unsigned int size : sizes) {
+    const char* block(static_cast<const char*>(arena.Allocate(size)));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) % kCacheLineSize);
+    EXPECT_TRUE(arena.Contains(block));
+    EXPECT_TRUE(arena.Contains(&block[size - 1]));
+    if (expected != nullptr) {
+      EXPECT_EQ(expected, block);
+    }
+    expected = block + Arena::AlignedSize(size);
+  }
+  EXPECT_EQ(capacity, arena.Used());
+  EXPECT_FALSE(arena.Contains(expected));
+}
+
+/// @brief A ring buffer taking its memory from an arena only allocates
+/// when growing beyond it
+TEST(Arena, RingBuffer) {
+  const unsigned int kCapacity(512);
+  Arena arena(RingBuffer<float>::ArenaSize(kCapacity));
+  RingBuffer<float> ring(&arena, kCapacity);
+  EXPECT_EQ(arena.Capacity(), arena.Used());
+  EXPECT_LE(kCapacity, ring.Capacity());
+
+  std::vector<float> data(kCapacity);
+  for (unsigned int i(0); i < kCapacity; ++i) {
+    data[i] = static_cast<float>(i);
+  }
+  // Shrinking: still within the arena
+  ring.SetCapacity(kCapacity / 4);
+  ring.Push(&data[0], kCapacity / 4);
+  std::vector<float> output(kCapacity);
+  ring.Pop(&output[0], kCapacity / 4);
+  for (unsigned int i(0); i < kCapacity / 4; ++i) {
+    EXPECT_EQ(data[i], output[i]);
+  }
+  // Growing: allocated outside of it
+  ring.SetCapacity(4 * kCapacity);
+  ring.Push(&data[0], kCapacity);
+  ring.Pop(&output[0], kCapacity);
+  for (unsigned int i(0); i < kCapacity; ++i) {
+    EXPECT_EQ(data[i], output[i]);
+  }
+}
+
+/// @brief Many instances construction and rendering (performance test)
+TEST(Arena, Perf) {
+  const unsigned int kInstancesCount(512);
+  const unsigned int kHostBlockSize(256);
+  std::vector<std::unique_ptr<Synthesizer>> synths;
+  const std::chrono::high_resolution_clock::time_point construction_start(
+    std::chrono::high_resolution_clock::now());
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    synths.emplace_back(new Synthesizer());
+  }
+  const double construction(std::chrono::duration<double>(
+    std::chrono::high_resolution_clock::now() - construction_start).count());
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    synths[i]->SetMaxBlockSize(kHostBlockSize);
+    synths[i]->NoteOn(kMinKeyNote + 13 + i % 64);
+  }
+
+  std::vector<float> data(kHostBlockSize);
+  const std::chrono::high_resolution_clock::time_point process_start(
+    std::chrono::high_resolution_clock::now());
+  for (auto& synth : synths) {
+    synth->ProcessAudio(&data[0], kHostBlockSize);
+  }
+  const double process(std::chrono::duration<double>(
+    std::chrono::high_resolution_clock::now() - process_start).count());
+
+  std::printf("[ PERF     ] %u instances (%u bytes arena each): "
+              "construction %.3f us, one block %.3f us per instance\n",
+              kInstancesCount,
+              static_cast<unsigned int>(
+                Synthesizer::ArenaSize(openmini::synthesizer::kDefaultBlockSize)),
+              1e6 * construction / kInstancesCount,
+              1e6 * process / kInstancesCount);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
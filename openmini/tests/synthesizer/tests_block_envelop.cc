@@ -0,0 +1,207 @@
+/// @filename tests_block_envelop.cc
+/// @brief BlockEnvelop specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "soundtailor/src/modulators/adsd.h"
+
+#include "openmini/src/synthesizer/block_envelop.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::BlockEnvelop;
+namespace EnvelopCurve = openmini::synthesizer::EnvelopCurve;
+
+/// @brief Time parameters allowed max
+static const unsigned int kMaxTime(kDataTestSetSize / 4);
+/// @brief Time parameters random generator
+static std::uniform_int_distribution<unsigned int> kTimeDistribution(1,
+                                                                     kMaxTime);
+
+/// @brief Render the given envelop, one sample at a time
+static std::vector<float> Render(BlockEnvelop* envelop,
+                                 const unsigned int length) {
+  std::vector<float> output(length);
+  for (unsigned int i(0); i < length; ++i) {
+    envelop->Process(&output[i], 1);
+  }
+  return output;
+}
+
+/// @brief Linear ramps go through all segments in the expected times
+TEST(BlockEnvelop, LinearSegments) {
+  for (unsigned int iterations(0); iterations < kIterations; ++iterations) {
+    IGNORE(iterations);
+
+    const unsigned int kAttack(kTimeDistribution(kRandomGenerator));
+    const unsigned int kDecay(kTimeDistribution(kRandomGenerator));
+    const unsigned int kSustain(kTimeDistribution(kRandomGenerator));
+    const unsigned int kRelease(kTimeDistribution(kRandomGenerator));
+    const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
+
+    BlockEnvelop envelop;
+    envelop.SetParameters(kAttack, kDecay, kRelease, kSustainLevel);
+    EXPECT_TRUE(envelop.IsIdle());
+    envelop.TriggerOn();
+    const std::vector<float> on(Render(&envelop, kAttack + kDecay + kSustain));
+    for (unsigned int i(0); i < kAttack; ++i) {
+      const float expected(static_cast<float>(i + 1) / kAttack);
+      EXPECT_NEAR(expected, on[i], 1e-5f);
+    }
+    EXPECT_EQ(1.0f, on[kAttack - 1]);
+    for (unsigned int i(0); i < kDecay; ++i) {
+      const float expected(1.0f - (1.0f - kSustainLevel) * (i + 1) / kDecay);
+      EXPECT_NEAR(expected, on[kAttack + i], 1e-5f);
+    }
+    for (unsigned int i(kAttack + kDecay - 1); i < on.size(); ++i) {
+      EXPECT_EQ(kSustainLevel, on[i]);
+    }
+
+    envelop.TriggerOff();
+    const std::vector<float> off(Render(&envelop, kRelease + kSustain));
+    for (unsigned int i(0); i < kRelease; ++i) {
+      const float expected(kSustainLevel * (kRelease - i - 1) / kRelease);
+      EXPECT_NEAR(expected, off[i], 1e-5f);
+    }
+    for (unsigned int i(kRelease - 1); i < off.size(); ++i) {
+      EXPECT_EQ(0.0f, off[i]);
+    }
+    EXPECT_TRUE(envelop.IsIdle());
+  }  // iterations?
+}
+
+/// @brief Exponential ramps are monotonic and end on their target
+TEST(BlockEnvelop, ExponentialSegments) {
+  for (unsigned int iterations(0); iterations < kIterations; ++iterations) {
+    IGNORE(iterations);
+
+    const unsigned int kAttack(kTimeDistribution(kRandomGenerator));
+    const unsigned int kDecay(kTimeDistribution(kRandomGenerator));
+    const unsigned int kRelease(kTimeDistribution(kRandomGenerator));
+    const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
+
+    BlockEnvelop envelop;
+    envelop.SetParameters(kAttack, kDecay, kRelease, kSustainLevel);
+    envelop.SetCurve(EnvelopCurve::kExponential);
+    envelop.TriggerOn();
+    const std::vector<float> on(Render(&envelop, kAttack + kDecay));
+    for (unsigned int i(1); i < kAttack; ++i) {
+      EXPECT_LE(on[i - 1], on[i]);
+    }
+    EXPECT_EQ(1.0f, on[kAttack - 1]);
+    for (unsigned int i(kAttack); i < kAttack + kDecay; ++i) {
+      EXPECT_GE(on[i - 1], on[i]);
+    }
+    EXPECT_EQ(kSustainLevel, on.back());
+
+    envelop.TriggerOff();
+    const std::vector<float> off(Render(&envelop, kRelease));
+    for (unsigned int i(1); i < kRelease; ++i) {
+      EXPECT_GE(off[i - 1], off[i]);
+    }
+    EXPECT_EQ(0.0f, off.back());
+    EXPECT_TRUE(envelop.IsIdle());
+  }  // iterations?
+}
+
+/// @brief Rendering by blocks should not change the output
+TEST(BlockEnvelop, BlockProcessing) {
+  std::uniform_int_distribution<unsigned int> kBlockSizeDistribution(1, 256);
+  for (const auto curve : {EnvelopCurve::kLinear, EnvelopCurve::kExponential}) {
+    const unsigned int kAttack(kTimeDistribution(kRandomGenerator));
+    const unsigned int kDecay(kTimeDistribution(kRandomGenerator));
+    const unsigned int kRelease(kTimeDistribution(kRandomGenerator));
+    const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
+    const unsigned int kTriggerOff(kAttack + kDecay / 2);
+    const unsigned int kDataLength(kTriggerOff + kRelease + 256);
+
+    BlockEnvelop expected_envelop;
+    BlockEnvelop envelop;
+    for (BlockEnvelop* current : {&expected_envelop, &envelop}) {
+      current->SetParameters(kAttack, kDecay, kRelease, kSustainLevel);
+      current->SetCurve(curve);
+      current->TriggerOn();
+    }
+    std::vector<float> expected(Render(&expected_envelop, kTriggerOff));
+    expected_envelop.TriggerOff();
+    const std::vector<float> released(Render(&expected_envelop,
+                                             kDataLength - kTriggerOff));
+    expected.insert(expected.end(), released.begin(), released.end());
+
+    std::vector<float> actual(kDataLength);
+    unsigned int sample_idx(0);
+    while (sample_idx < kDataLength) {
+      unsigned int length(std::min(kBlockSizeDistribution(kRandomGenerator),
+                                   kDataLength - sample_idx));
+      if (sample_idx < kTriggerOff) {
+        length = std::min(length, kTriggerOff - sample_idx);
+      }
+      envelop.Process(&actual[sample_idx], length);
+      sample_idx += length;
+      if (sample_idx == kTriggerOff) {
+        envelop.TriggerOff();
+      }
+    }
+
+    for (unsigned int i(0); i < kDataLength; ++i) {
+      EXPECT_NEAR(expected[i], actual[i], 1e-5f);
+    }
+  }
+}
+
+/// @brief Generates an envelop with random parameters (performance test)
+TEST(BlockEnvelop, Perf) {
+  const unsigned int kAttack(kTimeDistribution(kRandomGenerator));
+  const unsigned int kDecay(kTimeDistribution(kRandomGenerator));
+  const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
+  std::vector<float> output(kGeneratorDataPerfSetSize);
+  for (const auto curve : {EnvelopCurve::kLinear, EnvelopCurve::kExponential}) {
+    const char* const name(curve == EnvelopCurve::kLinear
+                           ? "BlockEnvelop linear"
+                           : "BlockEnvelop exponential");
+    BlockEnvelop envelop;
+    envelop.SetParameters(kAttack, kDecay, kDecay, kSustainLevel);
+    envelop.SetCurve(curve);
+    envelop.TriggerOn();
+
+    PerfCounters counters;
+    counters.Start();
+    envelop.Process(&output[0], kGeneratorDataPerfSetSize);
+    counters.Stop();
+    counters.Report(name, kGeneratorDataPerfSetSize);
+  }
+  {
+    // The former per-Sample generator
+    soundtailor::modulators::Adsd envelop;
+    envelop.SetParameters(kAttack, kDecay, kDecay, kSustainLevel);
+    envelop.TriggerOn();
+
+    PerfCounters counters;
+    counters.Start();
+    for (unsigned int i(0); i < kGeneratorDataPerfSetSize; i += SampleSize) {
+      VectorMath::Store(&output[i], envelop());
+    }
+    counters.Stop();
+    counters.Report("Adsd", kGeneratorDataPerfSetSize);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
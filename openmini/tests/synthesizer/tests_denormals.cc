@@ -0,0 +1,189 @@
+/// @filename tests_denormals.cc
+/// @brief Denormals flushing and detection specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/denormals.h"
+#include "openmini/src/synthesizer/dual_ladder.h"
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+#if (_USE_SSE)
+#include <xmmintrin.h>
+#endif  // (_USE_SSE)
+
+// Using declarations for tested class
+using openmini::synthesizer::CountDenormals;
+using openmini::synthesizer::DualLadder;
+using openmini::synthesizer::FlushDenormals;
+using openmini::synthesizer::IsDenormal;
+using openmini::synthesizer::Synthesizer;
+
+#if (_USE_SSE)
+/// @brief MXCSR "flush to zero" and "denormals are zero" bits
+static const unsigned int kFlushModes(0x8000 | 0x0040);
+
+/// @brief Clear flushing modes for the lifetime of the object,
+/// whatever the initial ones (e.g. set by the runtime on startup)
+class NoFlushDenormals {
+ public:
+  NoFlushDenormals()
+      : previous_mode_(_mm_getcsr()) {
+    _mm_setcsr(previous_mode_ & ~kFlushModes);
+  }
+  ~NoFlushDenormals() {
+    _mm_setcsr(previous_mode_);
+  }
+
+ private:
+  const unsigned int previous_mode_;
+};
+#endif  // (_USE_SSE)
+
+/// @brief Build a float from its bit pattern, whatever the flushing modes
+static float FromBits(const uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/// @brief Only denormal values are counted
+TEST(Denormals, Count) {
+  const float kValues[] = {
+    0.0f,
+    -1.0f,
+    1e-30f,
+    FromBits(0x00800000),  // Smallest normal
+    FromBits(0x00400000),  // Half of it
+    FromBits(0x80000001),  // Negative smallest denormal
+    FromBits(0x7F800000)  // Infinity
+  };
+  EXPECT_EQ(2u, CountDenormals(&kValues[0], sizeof(kValues) / sizeof(float)));
+}
+
+/// @brief Denormals are flushed within the scope only
+TEST(Denormals, FlushScope) {
+  volatile float denormal(FromBits(0x00400000));
+  EXPECT_TRUE(IsDenormal(denormal));
+#if (_USE_SSE)
+  const NoFlushDenormals no_flush_denormals;
+  EXPECT_TRUE(IsDenormal(denormal * 0.5f));
+  {
+    const FlushDenormals flush_denormals;
+    EXPECT_EQ(kFlushModes, _mm_getcsr() & kFlushModes);
+    EXPECT_EQ(0.0f, denormal * 0.5f);
+  }
+  EXPECT_EQ(0u, _mm_getcsr() & kFlushModes);
+  EXPECT_TRUE(IsDenormal(denormal * 0.5f));
+#endif  // (_USE_SSE)
+}
+
+/// @brief No denormal should be left in any module state during a note tail,
+/// nor the caller floating point mode be changed
+TEST(Denormals, SynthesizerTail) {
+  const unsigned int kBlockSize(256);
+  const unsigned int kMaxBlocksCount(4096);
+  Synthesizer synth;
+  synth.SetMaxBlockSize(kBlockSize);
+  synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.01f);
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterFreq, 0.1f);
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterResonance, 0.9f);
+  std::vector<float> data(kBlockSize);
+#if (_USE_SSE)
+  const unsigned int kCallerModes(_mm_getcsr() & kFlushModes);
+#endif  // (_USE_SSE)
+
+  synth.NoteOn(kMinKeyNote + 13);
+  synth.ProcessAudio(&data[0], kBlockSize);
+  synth.NoteOff(kMinKeyNote + 13);
+  unsigned int blocks_count(0);
+  while (!synth.IsSleeping() && (blocks_count < kMaxBlocksCount)) {
+    synth.ProcessAudio(&data[0], kBlockSize);
+    EXPECT_EQ(0u, synth.DenormalsCount());
+    EXPECT_EQ(0u, CountDenormals(&data[0], kBlockSize));
+#if (_USE_SSE)
+    EXPECT_EQ(kCallerModes, _mm_getcsr() & kFlushModes);
+#endif  // (_USE_SSE)
+    blocks_count += 1;
+  }
+  EXPECT_TRUE(synth.IsSleeping());
+}
+
+/// @brief A filter ringing out down to the denormal range,
+/// with and without flushing them (performance test)
+TEST(Denormals, Perf) {
+  const unsigned int kBlockSize(64);
+  const unsigned int kBlocksCount(kFilterDataPerfSetSize / kBlockSize);
+  // Low enough for a long tail, reaching the denormal range within the test
+  const float kFrequency(0.01f);
+  std::vector<float> input(kBlockSize, 0.0f);
+  std::vector<float> output(kBlockSize);
+#if (_USE_SSE)
+  // The runtime may already flush them (e.g. with "fast math")
+  const NoFlushDenormals no_flush_denormals;
+#endif  // (_USE_SSE)
+  for (const bool flush : {false, true}) {
+    std::unique_ptr<FlushDenormals> flush_denormals(
+      flush ? new FlushDenormals() : nullptr);
+    DualLadder ladder;
+    ladder.SetFrequency(openmini::synthesizer::LadderLane::kDry, kFrequency);
+    ladder.SetFrequency(openmini::synthesizer::LadderLane::kWet, kFrequency);
+    ladder.SetResonance(1.0f);
+    // One impulse, then the filter rings out
+    input[0] = 1.0f;
+
+    double total(0.0);
+    double worst(0.0);
+    unsigned int denormal_blocks(0);
+    for (unsigned int block(0); block < kBlocksCount; ++block) {
+      const std::chrono::high_resolution_clock::time_point start(
+        std::chrono::high_resolution_clock::now());
+      ladder.Process(&input[0], nullptr, 0.5f, 0.5f, &output[0], kBlockSize);
+      const double elapsed(std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - start).count());
+      input[0] = 0.0f;
+      total += elapsed;
+      worst = std::max(worst, elapsed);
+
+      DualLadder::State state;
+      ladder.Snapshot(&state);
+      if (CountDenormals(&state.stages[0][0],
+                         openmini::synthesizer::kLadderStagesCount
+                         * openmini::synthesizer::kLadderLanesCount) > 0) {
+        denormal_blocks += 1;
+      }
+    }
+
+    std::printf("[ PERF     ] DualLadder tail, %s: time per block "
+                "mean %.3f us, worst %.3f us, %u blocks with denormals\n",
+                flush ? "flushed" : "not flushed",
+                1e6 * total / kBlocksCount,
+                1e6 * worst,
+                denormal_blocks);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
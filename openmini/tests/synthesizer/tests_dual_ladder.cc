@@ -0,0 +1,315 @@
+/// @filename tests_dual_ladder.cc
+/// @brief DualLadder specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <string>
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "soundtailor/src/filters/moog_oversampled.h"
+
+#include "openmini/src/synthesizer/dual_ladder.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::DualLadder;
+using openmini::synthesizer::LadderLane::kDry;
+using openmini::synthesizer::LadderLane::kWet;
+
+/// @brief Each lane should be independent from the other one:
+/// its output is the same as a dual ladder with both lanes equally set
+TEST(DualLadder, LanesIndependence) {
+  const float kDryFrequency(0.05f);
+  const float kWetFrequency(0.3f);
+  const float kResonance(3.0f);
+  DualLadder dry_only;
+  DualLadder wet_only;
+  DualLadder dry_reference;
+  DualLadder wet_reference;
+  for (DualLadder* ladder : {&dry_only, &wet_only}) {
+    ladder->SetFrequency(kDry, kDryFrequency);
+    ladder->SetFrequency(kWet, kWetFrequency);
+  }
+  dry_reference.SetFrequency(kDry, kDryFrequency);
+  dry_reference.SetFrequency(kWet, kDryFrequency);
+  wet_reference.SetFrequency(kDry, kWetFrequency);
+  wet_reference.SetFrequency(kWet, kWetFrequency);
+  for (DualLadder* ladder : {&dry_only, &wet_only,
+                             &dry_reference, &wet_reference}) {
+    ladder->SetResonance(kResonance);
+  }
+
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    const Sample input(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+    EXPECT_TRUE(VectorMath::Equal(dry_reference(input, 1.0f, 0.0f),
+                                  dry_only(input, 1.0f, 0.0f)));
+    EXPECT_TRUE(VectorMath::Equal(wet_reference(input, 0.0f, 1.0f),
+                                  wet_only(input, 0.0f, 1.0f)));
+  }
+}
+
+/// @brief A lane whose output is not used may be skipped: switching over to it
+/// should then resume from the other lane state, as if it had been running
+TEST(DualLadder, SkippedLaneTakesOver) {
+  const float kFrequency(0.05f);
+  DualLadder switched;
+  DualLadder reference;
+  for (DualLadder* ladder : {&switched, &reference}) {
+    ladder->SetFrequency(kDry, kFrequency);
+    ladder->SetFrequency(kWet, kFrequency);
+    ladder->SetResonance(3.0f);
+  }
+
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    const Sample input(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+    // Switching lanes every few Samples
+    const bool wet((i / SampleSize) % 8 < 4);
+    EXPECT_TRUE(VectorMath::Equal(reference(input, 1.0f, 0.0f),
+                                  switched(input,
+                                           wet ? 0.0f : 1.0f,
+                                           wet ? 1.0f : 0.0f)));
+  }
+}
+
+/// @brief Both lanes run together should output the mix of each lane run
+/// alone, whichever way (packed or not) they are computed
+TEST(DualLadder, MixOfSingleLanes) {
+  const float kDryFrequency(0.05f);
+  const float kWetFrequency(0.2f);
+  const unsigned int kBlockSize(64);
+  DualLadder mixed;
+  DualLadder dry_only;
+  DualLadder wet_only;
+  for (DualLadder* ladder : {&mixed, &dry_only, &wet_only}) {
+    ladder->SetFrequency(kDry, kDryFrequency);
+    ladder->SetFrequency(kWet, kWetFrequency);
+    ladder->SetResonance(2.0f);
+  }
+  std::vector<float> input(kBlockSize);
+  std::vector<float> expected_dry(kBlockSize);
+  std::vector<float> expected_wet(kBlockSize);
+  std::vector<float> actual(kBlockSize);
+  const float kEpsilon(1e-5f);
+  for (unsigned int block(0); block < kDataTestSetSize / kBlockSize; ++block) {
+    for (float& value : input) {
+      value = kNormDistribution(kRandomGenerator);
+    }
+    dry_only.Process(&input[0], nullptr, 1.0f, 0.0f,
+                     &expected_dry[0], kBlockSize);
+    wet_only.Process(&input[0], nullptr, 0.0f, 1.0f,
+                     &expected_wet[0], kBlockSize);
+    mixed.Process(&input[0], nullptr, 0.25f, 0.75f, &actual[0], kBlockSize);
+    for (unsigned int i(0); i < kBlockSize; ++i) {
+      EXPECT_NEAR(0.25f * expected_dry[i] + 0.75f * expected_wet[i],
+                  actual[i],
+                  kEpsilon);
+    }
+  }
+}
+
+/// @brief A constant modulation should be the same as no modulation at all
+TEST(DualLadder, ConstantModulation) {
+  const float kFrequency(0.1f);
+  const unsigned int kBlockSize(64);
+  DualLadder modulated;
+  DualLadder reference;
+  for (DualLadder* ladder : {&modulated, &reference}) {
+    ladder->SetFrequency(kDry, kFrequency);
+    ladder->SetFrequency(kWet, kFrequency);
+    ladder->SetResonance(2.0f);
+  }
+  const std::vector<float> frequencies(kBlockSize, kFrequency);
+  std::vector<float> input(kBlockSize);
+  std::vector<float> expected(kBlockSize);
+  std::vector<float> actual(kBlockSize);
+  for (unsigned int block(0); block < kDataTestSetSize / kBlockSize; ++block) {
+    for (float& value : input) {
+      value = kNormDistribution(kRandomGenerator);
+    }
+    reference.Process(&input[0], nullptr, 0.0f, 1.0f,
+                      &expected[0], kBlockSize);
+    modulated.Process(&input[0], &frequencies[0], 0.0f, 1.0f,
+                      &actual[0], kBlockSize);
+    for (unsigned int i(0); i < kBlockSize; ++i) {
+      EXPECT_EQ(expected[i], actual[i]);
+    }
+  }
+}
+
+/// @brief Without resonance, the magnitude response should be the one of
+/// the analog 4 poles prototype: (1 + (f / fc)^2)^-2, whatever the
+/// oversampling ratio
+TEST(DualLadder, FrequencyResponse) {
+  const float kSamplingRate(48000.0f);
+  const float kCutoff(0.02f);
+  // Small enough to stay out of the saturation
+  const float kAmplitude(0.01f);
+  const unsigned int kSettleLength(8192);
+  const unsigned int kMeasureLength(8192);
+  const float kToleranceDb(1.0f);
+  for (const unsigned int ratio : {1u, 2u, 4u}) {
+    for (const float frequency : {0.005f, 0.01f, 0.02f, 0.04f, 0.08f}) {
+      DualLadder ladder(ratio);
+      ladder.SetFrequency(kDry, kCutoff);
+      ladder.SetResonance(0.0f);
+      SinusGenerator generator(frequency * kSamplingRate, kSamplingRate);
+      std::vector<float> input(kSettleLength + kMeasureLength);
+      for (float& value : input) {
+        value = kAmplitude * generator();
+      }
+      std::vector<float> output(input.size());
+      ladder.Process(&input[0], nullptr, 1.0f, 0.0f,
+                     &output[0], static_cast<unsigned int>(input.size()));
+      double input_power(0.0);
+      double output_power(0.0);
+      for (unsigned int i(kSettleLength); i < input.size(); ++i) {
+        input_power += input[i] * input[i];
+        output_power += output[i] * output[i];
+      }
+      const double actual_db(10.0 * std::log10(output_power / input_power));
+      const double relative(frequency / kCutoff);
+      const double expected_db(-40.0 * std::log10(1.0 + relative * relative));
+      EXPECT_NEAR(expected_db, actual_db, kToleranceDb)
+        << "oversampling " << ratio << ", frequency " << frequency;
+    }
+  }
+}
+
+/// @brief Measure a filter gain for a sine input, in dB
+///
+/// @param[in]  filter      Filter to measure, processing one Sample at a time
+/// @param[in]  frequency   Normalized sine frequency
+template <typename FilterFunction>
+static double MeasureGainDb(FilterFunction filter, const float frequency) {
+  const float kSamplingRate(48000.0f);
+  // Small enough to stay out of the saturation
+  const float kAmplitude(0.01f);
+  const unsigned int kSettleLength(8192);
+  const unsigned int kMeasureLength(8192);
+  SinusGenerator generator(frequency * kSamplingRate, kSamplingRate);
+  double input_power(0.0);
+  double output_power(0.0);
+  for (unsigned int i(0); i < kSettleLength + kMeasureLength; i += SampleSize) {
+    float input[SampleSize];
+    for (float& value : input) {
+      value = kAmplitude * generator();
+    }
+    float output[SampleSize];
+    VectorMath::StoreUnaligned(&output[0],
+                               filter(VectorMath::Fill(&input[0])));
+    if (i >= kSettleLength) {
+      for (unsigned int j(0); j < SampleSize; ++j) {
+        input_power += input[j] * input[j];
+        output_power += output[j] * output[j];
+      }
+    }
+  }
+  return 10.0 * std::log10(output_power / input_power);
+}
+
+/// @brief The ladder replaced SoundTailor MoogOversampled filters in Vcf:
+/// with the same parameters, its magnitude response should stay close to the
+/// MoogOversampled one, below resonance peaks
+TEST(DualLadder, MoogOversampledResponse) {
+  const float kCutoff(0.02f);
+  const float kToleranceDb(3.0f);
+  for (const float resonance : {0.0f, 1.0f, 2.0f}) {
+    for (const float frequency : {0.002f, 0.005f, 0.01f, 0.02f, 0.04f}) {
+      DualLadder ladder;
+      ladder.SetFrequency(kDry, kCutoff);
+      ladder.SetResonance(resonance);
+      soundtailor::filters::MoogOversampled moog;
+      moog.SetParameters(kCutoff, resonance);
+      const double actual_db(MeasureGainDb(
+        [&ladder](SampleRead input) { return ladder(input, 1.0f, 0.0f); },
+        frequency));
+      const double expected_db(MeasureGainDb(
+        [&moog](SampleRead input) { return moog(input); },
+        frequency));
+      EXPECT_NEAR(expected_db, actual_db, kToleranceDb)
+        << "resonance " << resonance << ", frequency " << frequency;
+    }
+  }
+}
+
+/// @brief Both lanes at once for each oversampling ratio, compared to
+/// two separate SoundTailor filters (performance test)
+TEST(DualLadder, Perf) {
+  const float kDryFrequency(0.05f);
+  const float kWetFrequency(0.3f);
+  const float kResonance(2.0f);
+  std::vector<float> input(kFilterDataPerfSetSize);
+  for (float& value : input) {
+    value = kNormDistribution(kRandomGenerator);
+  }
+  std::vector<float> frequencies(kFilterDataPerfSetSize);
+  for (float& value : frequencies) {
+    value = kWetFrequency * kNormPosDistribution(kRandomGenerator);
+  }
+  std::vector<float> output(kFilterDataPerfSetSize);
+  for (const unsigned int ratio : {1u, 2u, 4u}) {
+    for (const bool modulated : {false, true}) {
+      // Both lanes, then the wet one only
+      for (const float dry_gain : {0.5f, 0.0f}) {
+        DualLadder ladder(ratio);
+        ladder.SetFrequency(kDry, kDryFrequency);
+        ladder.SetFrequency(kWet, kWetFrequency);
+        ladder.SetResonance(kResonance);
+
+        PerfCounters counters;
+        counters.Start();
+        ladder.Process(&input[0],
+                       modulated ? &frequencies[0] : nullptr,
+                       dry_gain,
+                       1.0f - dry_gain,
+                       &output[0],
+                       kFilterDataPerfSetSize);
+        counters.Stop();
+        const std::string name("DualLadder "
+                               + std::to_string(ratio)
+                               + (modulated ? "x, modulated" : "x")
+                               + (dry_gain == 0.0f ? ", wet only" : ""));
+        counters.Report(name.c_str(), kFilterDataPerfSetSize);
+      }
+    }
+  }
+  {
+    // The former Vcf filtering: the wet filter set on each Sample
+    soundtailor::filters::MoogOversampled dry;
+    soundtailor::filters::MoogOversampled wet;
+    dry.SetParameters(kDryFrequency, kResonance);
+    wet.SetParameters(kWetFrequency, kResonance);
+
+    PerfCounters counters;
+    counters.Start();
+    for (unsigned int i(0); i < kFilterDataPerfSetSize; i += SampleSize) {
+      const Sample current(VectorMath::Fill(&input[i]));
+      const Sample mixed(
+        VectorMath::Add(VectorMath::MulConst(0.5f, dry(current)),
+                        VectorMath::MulConst(0.5f, wet(current))));
+      wet.SetParameters(frequencies[i], kResonance);
+      VectorMath::Store(&output[i], mixed);
+    }
+    counters.Stop();
+    counters.Report("MoogOversampled x2, modulated", kFilterDataPerfSetSize);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
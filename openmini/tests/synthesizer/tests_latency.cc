@@ -0,0 +1,183 @@
+/// @filename tests_latency.cc
+/// @brief Note-on to sound latency tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdio>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::Synthesizer;
+
+/// @brief Clock used for all wall-clock measurements
+typedef std::chrono::high_resolution_clock Clock;
+
+/// @brief Output amplitude above which the note is considered audible
+static const float kAudibleThreshold(1e-3f);
+
+/// @brief Note to trig for latency measurements (A4)
+static const unsigned int kLatencyNote(49);
+
+/// @brief Host-like block sizes to measure latency with
+static const unsigned int kLatencyBlockSizes[] = {
+  1, 32, 64, 128, 256, 512, 1024};
+
+/// @brief Attack times to measure latency with, in samples
+static const unsigned int kLatencyAttackTimes[] = {0, 64, 480, 4800};
+
+/// @brief Maximum allowed latency on top of the attack time, in samples
+static const unsigned int kMaxExtraLatency(openmini::kBlockSize);
+
+/// @brief Result of one latency measurement
+struct LatencyResult {
+  unsigned int samples;  ///< Note-on to sound delay, in samples
+  double wallclock;  ///< Note-on call to the end of the block holding
+                     ///< the first audible sample, in seconds
+};
+
+/// @brief Trig a note at the given offset within a block,
+/// measure when the first audible output sample is generated
+///
+/// The offset emulates a Midi event positioned within a host block:
+/// the block is split around it.
+///
+/// @param[in]  block_size      Host block size
+/// @param[in]  attack          Attack time, in samples
+/// @param[in]  offset          Note-on position within the block
+/// @param[in]  sampling_rate   Output sampling rate
+static LatencyResult MeasureLatency(const unsigned int block_size,
+                                    const unsigned int attack,
+                                    const unsigned int offset,
+                                    const float sampling_rate) {
+  OPENMINI_ASSERT(offset < block_size);
+  const unsigned int kMaxLength(attack + 2 * block_size + kMaxExtraLatency
+                                + static_cast<unsigned int>(sampling_rate));
+  std::vector<float> data(kMaxLength + block_size);
+  Synthesizer synth;
+  synth.SetOutputSamplingFrequency(sampling_rate);
+  synth.SetValue(openmini::synthesizer::Parameters::kAttackTime,
+                 static_cast<float>(attack)
+                 / static_cast<float>(openmini::kMaxTime));
+  // Warm up: processing parameters and filling internal buffers
+  synth.ProcessAudio(&data[0], block_size);
+
+  // Beginning of the block holding the note-on event
+  if (offset > 0) {
+    synth.ProcessAudio(&data[0], offset);
+  }
+  const Clock::time_point kNoteOnTime(Clock::now());
+  synth.NoteOn(kLatencyNote);
+
+  LatencyResult result = {kMaxLength, 0.0};
+  unsigned int sample_idx(0);
+  unsigned int length(block_size - offset);
+  while (sample_idx < kMaxLength) {
+    synth.ProcessAudio(&data[sample_idx], length);
+    for (unsigned int i(sample_idx); i < sample_idx + length; ++i) {
+      if (std::fabs(data[i]) > kAudibleThreshold) {
+        result.samples = i;
+        result.wallclock = std::chrono::duration<double>(
+          Clock::now() - kNoteOnTime).count();
+        return result;
+      }
+    }
+    sample_idx += length;
+    length = block_size;
+  }
+  return result;
+}
+
+/// @brief Measure note-on to sound latency for various block sizes,
+/// attack times and event positions within the block
+TEST(Latency, NoteOnToSound) {
+  const float kSamplingRate(48000.0f);
+  for (const unsigned int block_size : kLatencyBlockSizes) {
+    for (const unsigned int attack : kLatencyAttackTimes) {
+      // Event at the block beginning, and anywhere else
+      const unsigned int kOffsets[] = {
+        0,
+        std::uniform_int_distribution<unsigned int>(0, block_size - 1)
+          (kRandomGenerator)};
+      for (const unsigned int offset : kOffsets) {
+        const LatencyResult result(MeasureLatency(block_size,
+                                                  attack,
+                                                  offset,
+                                                  kSamplingRate));
+        std::printf("[ LATENCY  ] block %4u, attack %4u, offset %4u: "
+                    "%5u samples (%.3f ms), wall-clock %.3f ms\n",
+                    block_size,
+                    attack,
+                    offset,
+                    result.samples,
+                    1e3 * result.samples / kSamplingRate,
+                    1e3 * result.wallclock);
+        EXPECT_GE(attack + kMaxExtraLatency, result.samples);
+      }
+    }
+  }
+}
+
+/// @brief Measure the wall-clock cost of the first block following a note-on
+/// (all pending parameters being processed) relatively to the next ones
+TEST(Latency, NoteOnFirstBlockPerf) {
+  const float kSamplingRate(48000.0f);
+  const unsigned int kIterationsCount(64);
+  for (const unsigned int block_size : kLatencyBlockSizes) {
+    std::vector<float> data(block_size);
+    double first_block(0.0);
+    double next_blocks(0.0);
+    for (unsigned int iteration(0);
+         iteration < kIterationsCount;
+         ++iteration) {
+      Synthesizer synth;
+      synth.SetOutputSamplingFrequency(kSamplingRate);
+      synth.ProcessAudio(&data[0], block_size);
+      // Random parameters value, to be processed on the next note-on
+      for (unsigned int param_id(0);
+           param_id < openmini::synthesizer::Parameters::kCount;
+           ++param_id) {
+        synth.SetValue(param_id, kNormPosDistribution(kRandomGenerator));
+      }
+
+      const Clock::time_point kFirstStart(Clock::now());
+      synth.NoteOn(kLatencyNote);
+      synth.ProcessAudio(&data[0], block_size);
+      const Clock::time_point kNextStart(Clock::now());
+      synth.ProcessAudio(&data[0], block_size);
+      const Clock::time_point kNextEnd(Clock::now());
+
+      first_block += std::chrono::duration<double>(
+        kNextStart - kFirstStart).count();
+      next_blocks += std::chrono::duration<double>(
+        kNextEnd - kNextStart).count();
+    }
+    std::printf("[ LATENCY  ] block %4u: first block after note-on %.3f us, "
+                "next block %.3f us\n",
+                block_size,
+                1e6 * first_block / kIterationsCount,
+                1e6 * next_blocks / kIterationsCount);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
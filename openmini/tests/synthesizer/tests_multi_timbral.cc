@@ -0,0 +1,167 @@
+/// @filename tests_multi_timbral.cc
+/// @brief MultiTimbral specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/multi_timbral.h"
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::kMidiChannelsCount;
+using openmini::synthesizer::MultiTimbral;
+using openmini::synthesizer::Synthesizer;
+
+/// @brief Maximum host block size used in these tests
+static const unsigned int kMultiMaxBlockSize(256);
+
+/// @brief Each part output should be the same as an independent synthesizer
+/// with the same notes and parameters
+TEST(MultiTimbral, SameOutput) {
+  const unsigned int kDataLength(32 * kMultiMaxBlockSize);
+  std::vector<std::unique_ptr<Synthesizer>> synths;
+  MultiTimbral multi;
+  multi.SetOutputSamplingFrequency(48000.0f);
+  multi.SetMaxBlockSize(kMultiMaxBlockSize);
+  for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+    synths.emplace_back(new Synthesizer());
+    synths.back()->SetOutputSamplingFrequency(48000.0f);
+    synths.back()->SetMaxBlockSize(kMultiMaxBlockSize);
+    // Each part has its own parameters
+    const float cutoff(static_cast<float>(channel + 1) / kMidiChannelsCount);
+    synths.back()->SetValue(openmini::synthesizer::Parameters::kFilterFreq,
+                            cutoff);
+    multi.Part(channel).SetValue(openmini::synthesizer::Parameters::kFilterFreq,
+                                 cutoff);
+    synths.back()->NoteOn(kMinKeyNote + 13 + 3 * channel);
+    multi.NoteOn(channel, kMinKeyNote + 13 + 3 * channel);
+  }
+
+  std::vector<std::vector<float>> expected(kMidiChannelsCount,
+                                           std::vector<float>(kDataLength));
+  std::vector<std::vector<float>> actual(kMidiChannelsCount,
+                                         std::vector<float>(kDataLength));
+  std::vector<float*> outputs(kMidiChannelsCount);
+  std::uniform_int_distribution<unsigned int> kBlockSizeDistribution(
+    1,
+    2 * kMultiMaxBlockSize);
+  unsigned int sample_idx(0);
+  while (sample_idx < kDataLength) {
+    const unsigned int kLength(std::min(kBlockSizeDistribution(kRandomGenerator),
+                                        kDataLength - sample_idx));
+    for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+      synths[channel]->ProcessAudio(&expected[channel][sample_idx], kLength);
+      outputs[channel] = &actual[channel][sample_idx];
+    }
+    multi.ProcessAudio(&outputs[0], kLength);
+    sample_idx += kLength;
+  }
+
+  for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+    for (unsigned int i(0); i < kDataLength; ++i) {
+      EXPECT_EQ(expected[channel][i], actual[channel][i]);
+    }
+  }
+}
+
+/// @brief Summed output should be the sum of all parts outputs
+TEST(MultiTimbral, SummedOutput) {
+  const unsigned int kDataLength(16 * kMultiMaxBlockSize);
+  MultiTimbral separated;
+  MultiTimbral summed;
+  for (auto* multi : {&separated, &summed}) {
+    multi->SetOutputSamplingFrequency(48000.0f);
+    multi->SetMaxBlockSize(kMultiMaxBlockSize);
+    for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+      multi->NoteOn(channel, kMinKeyNote + 25 + channel);
+    }
+  }
+
+  std::vector<std::vector<float>> parts(kMidiChannelsCount,
+                                        std::vector<float>(kDataLength));
+  std::vector<float*> outputs(kMidiChannelsCount);
+  for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+    outputs[channel] = &parts[channel][0];
+  }
+  std::vector<float> actual(kDataLength);
+  separated.ProcessAudio(&outputs[0], kDataLength);
+  summed.ProcessAudio(&actual[0], kDataLength);
+
+  for (unsigned int i(0); i < kDataLength; ++i) {
+    float expected(0.0f);
+    float magnitude(0.0f);
+    for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+      expected += parts[channel][i];
+      magnitude += std::fabs(parts[channel][i]);
+    }
+    // Summed in another order: allow one rounding error per part
+    EXPECT_NEAR(expected,
+                actual[i],
+                kMidiChannelsCount * std::numeric_limits<float>::epsilon()
+                * magnitude);
+  }
+}
+
+/// @brief All parts rendered serially or in parallel (performance test)
+TEST(MultiTimbral, Perf) {
+  const unsigned int kBlocksCount(kFilterDataPerfSetSize
+                                  / kMultiMaxBlockSize
+                                  / kMidiChannelsCount);
+  std::vector<float> data(kMultiMaxBlockSize);
+  double serial(0.0);
+  double pooled(0.0);
+  unsigned int pooled_parts(0);
+  for (const bool use_pool : {false, true}) {
+    MultiTimbral multi(use_pool);
+    multi.SetOutputSamplingFrequency(48000.0f);
+    multi.SetMaxBlockSize(kMultiMaxBlockSize);
+    for (unsigned int channel(0); channel < kMidiChannelsCount; ++channel) {
+      multi.NoteOn(channel, kMinKeyNote + 13 + channel);
+    }
+    const std::chrono::high_resolution_clock::time_point start(
+      std::chrono::high_resolution_clock::now());
+    for (unsigned int block(0); block < kBlocksCount; ++block) {
+      multi.ProcessAudio(&data[0], kMultiMaxBlockSize);
+    }
+    const double elapsed(std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start).count());
+    if (use_pool) {
+      pooled = elapsed;
+      pooled_parts = multi.PooledPartsCount();
+    } else {
+      serial = elapsed;
+    }
+  }
+
+  std::printf("[ PERF     ] %u parts, time per block: "
+              "serial %.3f us, pooled (%u parts) %.3f us\n",
+              kMidiChannelsCount,
+              1e6 * serial / kBlocksCount,
+              pooled_parts,
+              1e6 * pooled / kBlocksCount);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
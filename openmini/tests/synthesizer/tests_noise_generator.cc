@@ -0,0 +1,187 @@
+/// @filename tests_noise_generator.cc
+/// @brief NoiseGenerator specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "openmini/src/synthesizer/noise_generator.h"
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::NoiseGenerator;
+using openmini::synthesizer::Synthesizer;
+namespace NoiseColor = openmini::NoiseColor;
+
+/// @brief Lag-one difference power relative to the signal power:
+/// 2.0 for white noise, lower for low frequency heavy signals
+static float DifferencePowerRatio(const std::vector<float>& data) {
+  double power(0.0);
+  double difference_power(0.0);
+  for (unsigned int i(1); i < data.size(); ++i) {
+    const double difference(data[i] - data[i - 1]);
+    power += data[i] * data[i];
+    difference_power += difference * difference;
+  }
+  return static_cast<float>(difference_power / power);
+}
+
+/// @brief White noise range and distribution
+TEST(NoiseGenerator, White) {
+  const float kVolume(kNormPosDistribution(kRandomGenerator));
+  NoiseGenerator generator;
+  generator.SetVolume(kVolume);
+  std::vector<float> data(kDataTestSetSize);
+  generator.Process(&data[0], kDataTestSetSize);
+
+  double sum(0.0);
+  double power(0.0);
+  for (const float value : data) {
+    EXPECT_GE(kVolume, value);
+    EXPECT_LE(-kVolume, value);
+    sum += value;
+    power += value * value;
+  }
+  // Uniform distribution: null mean, variance = 1 / 3
+  EXPECT_NEAR(0.0, sum / kDataTestSetSize, 0.02 * kVolume);
+  EXPECT_NEAR(kVolume * kVolume / 3.0,
+              power / kDataTestSetSize,
+              0.02 * kVolume * kVolume);
+  EXPECT_NEAR(2.0f, DifferencePowerRatio(data), 0.1f);
+}
+
+/// @brief Pink noise is bounded and low frequency heavy
+TEST(NoiseGenerator, Pink) {
+  NoiseGenerator generator;
+  generator.SetVolume(1.0f);
+  generator.SetColor(NoiseColor::kPink);
+  std::vector<float> data(kDataTestSetSize);
+  generator.Process(&data[0], kDataTestSetSize);
+
+  for (const float value : data) {
+    EXPECT_GE(1.0f, std::fabs(value));
+  }
+  EXPECT_GT(0.5f, DifferencePowerRatio(data));
+}
+
+/// @brief The output only depends on the seed, not on the buffers lengths
+TEST(NoiseGenerator, Reproducible) {
+  std::uniform_int_distribution<unsigned int> kBlockSizeDistribution(1, 67);
+  const uint32_t kSeed(kRandomGenerator());
+  for (const auto color : {NoiseColor::kWhite, NoiseColor::kPink}) {
+    NoiseGenerator expected_generator;
+    NoiseGenerator generator;
+    NoiseGenerator other_generator;
+    for (NoiseGenerator* current : {&expected_generator,
+                                    &generator,
+                                    &other_generator}) {
+      current->SetVolume(1.0f);
+      current->SetColor(color);
+      current->SetSeed(kSeed);
+    }
+    other_generator.SetSeed(kSeed + 1);
+
+    std::vector<float> expected(kDataTestSetSize);
+    std::vector<float> other(kDataTestSetSize);
+    expected_generator.Process(&expected[0], kDataTestSetSize);
+    other_generator.Process(&other[0], kDataTestSetSize);
+    std::vector<float> actual(kDataTestSetSize);
+    unsigned int sample_idx(0);
+    while (sample_idx < kDataTestSetSize) {
+      const unsigned int kLength(
+        std::min(kBlockSizeDistribution(kRandomGenerator),
+                 kDataTestSetSize - sample_idx));
+      generator.Process(&actual[sample_idx], kLength);
+      sample_idx += kLength;
+    }
+
+    unsigned int differences(0);
+    for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+      EXPECT_EQ(expected[i], actual[i]);
+      if (expected[i] != other[i]) {
+        differences += 1;
+      }
+    }
+    EXPECT_LT(kDataTestSetSize / 2, differences);
+  }
+}
+
+/// @brief Synthesizers seeded alike render the same noise
+TEST(NoiseGenerator, SynthesizerSeed) {
+  const unsigned int kBlockSize(256);
+  const uint32_t kSeed(kRandomGenerator());
+  Synthesizer expected_synth;
+  Synthesizer synth;
+  for (Synthesizer* current : {&expected_synth, &synth}) {
+    current->SetMaxBlockSize(kBlockSize);
+    current->SetValue(openmini::synthesizer::Parameters::kOsc1Volume, 0.0f);
+    current->SetValue(openmini::synthesizer::Parameters::kNoiseVolume, 1.0f);
+    current->SetNoiseSeed(kSeed);
+    current->NoteOn(kMinKeyNote + 13);
+  }
+
+  std::vector<float> expected(kBlockSize);
+  std::vector<float> actual(kBlockSize);
+  float power(0.0f);
+  for (unsigned int block(0); block < 16; ++block) {
+    expected_synth.ProcessAudio(&expected[0], kBlockSize);
+    synth.ProcessAudio(&actual[0], kBlockSize);
+    for (unsigned int i(0); i < kBlockSize; ++i) {
+      EXPECT_EQ(expected[i], actual[i]);
+      power += expected[i] * expected[i];
+    }
+  }
+  EXPECT_LT(0.0f, power);
+}
+
+/// @brief Generates noise (performance test)
+TEST(NoiseGenerator, Perf) {
+  std::vector<float> output(kGeneratorDataPerfSetSize);
+  for (const auto color : {NoiseColor::kWhite, NoiseColor::kPink}) {
+    NoiseGenerator generator;
+    generator.SetVolume(1.0f);
+    generator.SetColor(color);
+
+    PerfCounters counters;
+    counters.Start();
+    generator.Process(&output[0], kGeneratorDataPerfSetSize);
+    counters.Stop();
+    counters.Report(color == NoiseColor::kWhite ? "NoiseGenerator white"
+                                                : "NoiseGenerator pink",
+                    kGeneratorDataPerfSetSize);
+  }
+  {
+    // Standard library distribution, drawn one sample at a time
+    std::minstd_rand engine(openmini::synthesizer::kDefaultNoiseSeed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+    PerfCounters counters;
+    counters.Start();
+    for (unsigned int i(0); i < kGeneratorDataPerfSetSize; ++i) {
+      output[i] = distribution(engine);
+    }
+    counters.Stop();
+    counters.Report("std::uniform_real_distribution",
+                    kGeneratorDataPerfSetSize);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
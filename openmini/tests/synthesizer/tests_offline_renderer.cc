@@ -0,0 +1,217 @@
+/// @filename tests_offline_renderer.cc
+/// @brief OfflineRenderer specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/offline_renderer.h"
+#include "openmini/src/synthesizer/parameters.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::OfflineEvent;
+using openmini::synthesizer::OfflineRenderer;
+
+/// @brief Sampling rate used in these tests
+static const float kOfflineSamplingRate(48000.0f);
+
+/// @brief Time in between checkpoints used in these tests, in seconds
+static const float kCheckpointPeriod(0.25f);
+
+/// @brief Build a timeline: one half-second note each second,
+/// with a fast release so that the synthesizer goes silent in between
+static std::vector<OfflineEvent> BuildTimeline(const unsigned int seconds) {
+  const unsigned int kSecond(static_cast<unsigned int>(kOfflineSamplingRate));
+  std::vector<OfflineEvent> events;
+  events.push_back({0,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kDecayTime,
+                    0.0f});
+  for (unsigned int second(0); second < seconds; ++second) {
+    const int note(static_cast<int>(kMinKeyNote + 13 + second % 24));
+    events.push_back({second * kSecond, OfflineEvent::kNoteOn, note, 0.0f});
+    events.push_back({second * kSecond + kSecond / 2,
+                      OfflineEvent::kNoteOff,
+                      note,
+                      0.0f});
+  }
+  return events;
+}
+
+/// @brief A change whose effect vanishes should be re-rendered
+/// up to the point the state converges only, exactly as a full render
+TEST(OfflineRenderer, IdenticalStateConvergence) {
+  const unsigned int kSeconds(8);
+  const unsigned int kLength(kSeconds
+                             * static_cast<unsigned int>(kOfflineSamplingRate));
+  std::vector<OfflineEvent> events(BuildTimeline(kSeconds));
+  OfflineRenderer renderer(kOfflineSamplingRate, kCheckpointPeriod);
+  renderer.Render(events, kLength);
+  EXPECT_EQ(kLength / renderer.CheckpointInterval(),
+            renderer.CheckpointsCount());
+
+  // Oscillator volume lowered within a region, then back to its default
+  const unsigned int kBegin(kLength / 3);
+  const unsigned int kEnd(kLength / 2 + 1);
+  const float kDefault(openmini::synthesizer::Parameters::kParametersMeta[
+    openmini::synthesizer::Parameters::kOsc1Volume].default_value());
+  events.push_back({kBegin,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kOsc1Volume,
+                    kDefault / 2.0f});
+  events.push_back({kEnd - 1,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kOsc1Volume,
+                    kDefault});
+  const unsigned int rendered(renderer.Rerender(events, kBegin, kEnd));
+  EXPECT_GE(rendered, kEnd - kBegin);
+  EXPECT_LT(rendered, kLength - kBegin);
+
+  OfflineRenderer expected(kOfflineSamplingRate, kCheckpointPeriod);
+  expected.Render(events, kLength);
+  for (unsigned int i(0); i < kLength; ++i) {
+    EXPECT_EQ(expected.Output()[i], renderer.Output()[i]);
+  }
+}
+
+/// @brief A changed note should be re-rendered up to the following silence,
+/// the previous render being kept from there
+TEST(OfflineRenderer, SilenceConvergence) {
+  const unsigned int kSeconds(8);
+  const unsigned int kSecond(static_cast<unsigned int>(kOfflineSamplingRate));
+  const unsigned int kLength(kSeconds * kSecond);
+  std::vector<OfflineEvent> events(BuildTimeline(kSeconds));
+  OfflineRenderer renderer(kOfflineSamplingRate, kCheckpointPeriod);
+  renderer.Render(events, kLength);
+  const std::vector<float> previous(renderer.Output());
+
+  // Third note changed
+  const unsigned int kBegin(2 * kSecond);
+  const unsigned int kEnd(2 * kSecond + kSecond / 2 + 1);
+  for (auto& event : events) {
+    if ((event.position >= kBegin) && (event.position < kEnd)
+        && (event.type != OfflineEvent::kParameter)) {
+      event.id += 7;
+    }
+  }
+  const unsigned int rendered(renderer.Rerender(events, kBegin, kEnd));
+  EXPECT_GE(rendered, kEnd - kBegin);
+  EXPECT_LT(rendered, kLength - kBegin);
+
+  OfflineRenderer expected(kOfflineSamplingRate, kCheckpointPeriod);
+  expected.Render(events, kLength);
+  const unsigned int kSpliced(kBegin + rendered);
+  for (unsigned int i(0); i < kSpliced; ++i) {
+    EXPECT_EQ(expected.Output()[i], renderer.Output()[i]);
+  }
+  for (unsigned int i(kSpliced); i < kLength; ++i) {
+    EXPECT_EQ(previous[i], renderer.Output()[i]);
+  }
+
+  // Without splicing on silence: as a full render
+  OfflineRenderer exact(kOfflineSamplingRate, kCheckpointPeriod, false);
+  exact.Render(BuildTimeline(kSeconds), kLength);
+  exact.Rerender(events, kBegin, kEnd);
+  for (unsigned int i(0); i < kLength; ++i) {
+    EXPECT_EQ(expected.Output()[i], exact.Output()[i]);
+  }
+}
+
+/// @brief A re-render starting within the region changed by a previous one
+/// should start from the current timeline, exactly as a full render
+TEST(OfflineRenderer, ChainedRerenders) {
+  const unsigned int kSeconds(8);
+  const unsigned int kLength(kSeconds
+                             * static_cast<unsigned int>(kOfflineSamplingRate));
+  std::vector<OfflineEvent> events(BuildTimeline(kSeconds));
+  OfflineRenderer renderer(kOfflineSamplingRate, kCheckpointPeriod, false);
+  renderer.Render(events, kLength);
+
+  // Filter lowered over a region spanning several checkpoints
+  const unsigned int kFirstBegin(kLength / 8);
+  const unsigned int kFirstEnd(kLength / 2);
+  events.push_back({kFirstBegin,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kFilterFreq,
+                    0.2f});
+  events.push_back({kFirstEnd - 1,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kFilterFreq,
+                    0.7f});
+  renderer.Rerender(events, kFirstBegin, kFirstEnd);
+
+  // Resonance raised within the first region
+  const unsigned int kSecondBegin(kLength / 4);
+  const unsigned int kSecondEnd(kLength / 4 + kLength / 16);
+  events.push_back({kSecondBegin,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kFilterResonance,
+                    0.8f});
+  events.push_back({kSecondEnd - 1,
+                    OfflineEvent::kParameter,
+                    openmini::synthesizer::Parameters::kFilterResonance,
+                    0.0f});
+  renderer.Rerender(events, kSecondBegin, kSecondEnd);
+
+  OfflineRenderer expected(kOfflineSamplingRate, kCheckpointPeriod);
+  expected.Render(events, kLength);
+  for (unsigned int i(0); i < kLength; ++i) {
+    EXPECT_EQ(expected.Output()[i], renderer.Output()[i]);
+  }
+}
+
+/// @brief Full render versus re-rendering one changed note
+/// (performance test)
+TEST(OfflineRenderer, Perf) {
+  const unsigned int kSeconds(30);
+  const unsigned int kSecond(static_cast<unsigned int>(kOfflineSamplingRate));
+  const unsigned int kLength(kSeconds * kSecond);
+  std::vector<OfflineEvent> events(BuildTimeline(kSeconds));
+  OfflineRenderer renderer(kOfflineSamplingRate, kCheckpointPeriod);
+
+  const std::chrono::high_resolution_clock::time_point render_start(
+    std::chrono::high_resolution_clock::now());
+  renderer.Render(events, kLength);
+  const std::chrono::high_resolution_clock::time_point rerender_start(
+    std::chrono::high_resolution_clock::now());
+  const unsigned int kBegin((kSeconds / 2) * kSecond);
+  const unsigned int kEnd(kBegin + kSecond / 2 + 1);
+  for (auto& event : events) {
+    if ((event.position >= kBegin) && (event.position < kEnd)
+        && (event.type != OfflineEvent::kParameter)) {
+      event.id += 7;
+    }
+  }
+  const unsigned int rendered(renderer.Rerender(events, kBegin, kEnd));
+  const std::chrono::high_resolution_clock::time_point end(
+    std::chrono::high_resolution_clock::now());
+
+  std::printf("[ PERF     ] %u s render: full %.3f ms, "
+              "one note changed %.3f ms (%u samples re-rendered)\n",
+              kSeconds,
+              1e3 * std::chrono::duration<double>(
+                rerender_start - render_start).count(),
+              1e3 * std::chrono::duration<double>(
+                end - rerender_start).count(),
+              rendered);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
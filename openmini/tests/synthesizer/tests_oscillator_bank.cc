@@ -0,0 +1,188 @@
+/// @filename tests_oscillator_bank.cc
+/// @brief OscillatorBank specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "openmini/src/synthesizer/oscillator_bank.h"
+#include "openmini/src/synthesizer/vco.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::Arena;
+using openmini::synthesizer::OscillatorBank;
+using openmini::synthesizer::Vco;
+
+/// @brief Lanes actually used in these tests, as within the mixer
+static const unsigned int kBankUsedLanes(3);
+
+/// @brief Each lane should be independent from the other ones:
+/// the bank output is the sum of single lane banks outputs
+TEST(OscillatorBank, LanesIndependence) {
+  const openmini::Waveform::Type kWaveforms[kBankUsedLanes] = {
+    openmini::Waveform::kTriangle,
+    openmini::Waveform::kSawtooth,
+    openmini::Waveform::kTriangle
+  };
+  OscillatorBank bank;
+  OscillatorBank references[kBankUsedLanes];
+  for (unsigned int lane(0); lane < kBankUsedLanes; ++lane) {
+    const float frequency(kFreqDistribution(kRandomGenerator));
+    const float volume(kNormPosDistribution(kRandomGenerator));
+    bank.SetFrequency(lane, frequency);
+    bank.SetVolume(lane, volume);
+    bank.SetWaveform(lane, kWaveforms[lane]);
+    references[lane].SetFrequency(lane, frequency);
+    references[lane].SetVolume(lane, volume);
+    references[lane].SetWaveform(lane, kWaveforms[lane]);
+  }
+
+  std::vector<float> actual(kDataTestSetSize);
+  bank.Process(&actual[0], kDataTestSetSize);
+  std::vector<float> expected(kDataTestSetSize, 0.0f);
+  std::vector<float> lane_output(kDataTestSetSize);
+  for (OscillatorBank& reference : references) {
+    reference.Process(&lane_output[0], kDataTestSetSize);
+    for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+      expected[i] += lane_output[i];
+    }
+  }
+  for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 1e-5f);
+  }
+}
+
+/// @brief Each waveform should be periodic and within [-1.0f ; 1.0f]
+TEST(OscillatorBank, Periodicity) {
+  // Exactly representable phase increment
+  const unsigned int kPeriod(64);
+  const float kFrequency(1.0f / static_cast<float>(kPeriod));
+  for (unsigned int waveform(0);
+       waveform < openmini::Waveform::kCount;
+       ++waveform) {
+    OscillatorBank bank;
+    bank.SetFrequency(0, kFrequency);
+    bank.SetVolume(0, 1.0f);
+    bank.SetWaveform(0, static_cast<openmini::Waveform::Type>(waveform));
+
+    std::vector<float> output(kDataTestSetSize);
+    bank.Process(&output[0], kDataTestSetSize);
+    for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+      EXPECT_GE(1.0f + 1e-5f, std::fabs(output[i]));
+      if (i >= kPeriod) {
+        EXPECT_NEAR(output[i - kPeriod], output[i], 1e-4f)
+          << "waveform " << waveform << ", sample " << i;
+      }
+    }
+  }
+}
+
+/// @brief A muted lane should output zeros, then resume exactly where it
+/// stopped once unmuted
+TEST(OscillatorBank, MutedResume) {
+  const unsigned int kHistoryLength(1024);
+  OscillatorBank bank;
+  OscillatorBank reference;
+  const float kFrequency(kFreqDistribution(kRandomGenerator));
+  for (OscillatorBank* oscillators : {&bank, &reference}) {
+    oscillators->SetFrequency(0, kFrequency);
+    oscillators->SetVolume(0, 1.0f);
+  }
+
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(reference(), bank()));
+  }
+  bank.SetVolume(0, 0.0f);
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(VectorMath::Fill(0.0f), bank()));
+  }
+  bank.SetVolume(0, 1.0f);
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(reference(), bank()));
+  }
+}
+
+/// @brief Changing the waveform keeps the phase: the output does not spike
+TEST(OscillatorBank, WaveformChange) {
+  const float kFrequency(kFreqDistribution(kRandomGenerator));
+  OscillatorBank bank;
+  bank.SetFrequency(0, kFrequency);
+  bank.SetVolume(0, 1.0f);
+
+  std::vector<float> output(kDataTestSetSize);
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    bank.SetWaveform(0, static_cast<openmini::Waveform::Type>(
+                          (i / SampleSize) % openmini::Waveform::kCount));
+    bank.Process(&output[i], SampleSize);
+  }
+  for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+    EXPECT_GE(1.0f + 1e-5f, std::fabs(output[i]));
+  }
+}
+
+/// @brief All VCOs at once, compared to three separate ones
+/// (performance test)
+TEST(OscillatorBank, Perf) {
+  std::vector<float> output(kGeneratorDataPerfSetSize);
+  {
+    OscillatorBank bank;
+    for (unsigned int lane(0); lane < kBankUsedLanes; ++lane) {
+      bank.SetFrequency(lane, kFreqDistribution(kRandomGenerator));
+      bank.SetVolume(lane, 1.0f / kBankUsedLanes);
+      bank.SetWaveform(lane, static_cast<openmini::Waveform::Type>(
+                               lane % openmini::Waveform::kCount));
+    }
+
+    PerfCounters counters;
+    counters.Start();
+    bank.Process(&output[0], kGeneratorDataPerfSetSize);
+    counters.Stop();
+    counters.Report("OscillatorBank", kGeneratorDataPerfSetSize);
+  }
+  {
+    // The former Mixer processing
+    Arena arena(kBankUsedLanes * Vco::ArenaSize());
+    Vco vco0(&arena);
+    Vco vco1(&arena);
+    Vco vco2(&arena);
+    Vco* const vcos[kBankUsedLanes] = {&vco0, &vco1, &vco2};
+    for (unsigned int lane(0); lane < kBankUsedLanes; ++lane) {
+      vcos[lane]->SetFrequency(kFreqDistribution(kRandomGenerator)
+                               * SamplingRate::Instance().Get());
+      vcos[lane]->SetVolume(1.0f / kBankUsedLanes);
+      vcos[lane]->SetWaveform(static_cast<openmini::Waveform::Type>(
+                                lane % openmini::Waveform::kCount));
+    }
+
+    PerfCounters counters;
+    counters.Start();
+    for (unsigned int i(0); i < kGeneratorDataPerfSetSize; i += SampleSize) {
+      Sample mixed(VectorMath::Fill(0.0f));
+      for (Vco* vco : vcos) {
+        mixed = VectorMath::Add(mixed, (*vco)());
+      }
+      VectorMath::Store(&output[i], mixed);
+    }
+    counters.Stop();
+    counters.Report("Vco x3", kGeneratorDataPerfSetSize);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
@@ -0,0 +1,279 @@
+/// @filename tests_polyblep.cc
+/// @brief PolyBLEP generators specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "soundtailor/src/generators/generator_base.h"
+
+#include "openmini/src/synthesizer/generator_factory.h"
+#include "openmini/src/synthesizer/polyblep.h"
+#include "openmini/src/synthesizer/wavetable_oscillator.h"
+#include "openmini/src/synthesizer/wavetables.h"
+
+// Using declarations for tested class
+using openmini::generators::GeneratorType::Type;
+using openmini::generators::PolyBlep_Base;
+using openmini::generators::WavetableOscillator;
+using openmini::synthesizer::Wavetables;
+using soundtailor::generators::Generator_Base;
+
+namespace GeneratorType = openmini::generators::GeneratorType;
+
+/// @brief Generators names, for reports
+static const char* kGeneratorNames[GeneratorType::kCount] = {
+  "TriangleDPW",
+  "SawtoothDPW",
+  "TrianglePolyBlep",
+  "SawtoothPolyBlep",
+  "PulsePolyBlep",
+  "TriangleWavetable",
+  "SawtoothWavetable"
+};
+
+/// @brief Replays a rendered buffer, for SoundTailor analysis helpers
+class BufferReader {
+ public:
+  explicit BufferReader(const std::vector<float>& data)
+      : data_(data),
+        index_(0) {
+    // Nothing to do here for now
+  }
+
+  Sample operator()(void) {
+    const Sample output(VectorMath::Fill(&data_[index_]));
+    index_ += SampleSize;
+    return output;
+  }
+
+ private:
+  const std::vector<float>& data_;
+  unsigned int index_;
+};
+
+/// @brief Give the given tables to the generator, if it is a wavetable one
+static void SetTables(const Type type,
+                      const Wavetables* tables,
+                      Generator_Base* generator) {
+  if (type >= GeneratorType::kTriangleWavetable) {
+    static_cast<WavetableOscillator*>(generator)->SetTables(tables);
+  }
+}
+
+/// @brief Render the given generator type into the given buffer
+static void Render(const Type type,
+                   const float frequency,
+                   std::vector<float>* output) {
+  const Wavetables* tables(
+    Wavetables::Acquire(SamplingRate::Instance().Get()));
+  void* slot(openmini::Allocate(openmini::generators::GeneratorSlotSize()));
+  Generator_Base* generator(openmini::generators::CreateGenerator(slot, type));
+  SetTables(type, tables, generator);
+  generator->SetFrequency(frequency);
+  generator->ProcessParameters();
+  for (unsigned int i(0); i < output->size(); i += SampleSize) {
+    VectorMath::StoreUnaligned(&(*output)[i], (*generator)());
+  }
+  openmini::generators::DestroyGeneratorInPlace(generator);
+  openmini::Deallocate(slot);
+  Wavetables::Release(tables);
+}
+
+/// @brief Aliasing to harmonics power ratio, in dB
+///
+/// Harmonics amplitudes are estimated by projecting the signal on each of
+/// them, anything else within the signal power is considered as aliasing
+static double ComputeAliasingRatio(const std::vector<float>& signal,
+                                   const float frequency) {
+  const unsigned int length(static_cast<unsigned int>(signal.size()));
+  double harmonics(0.0);
+  for (unsigned int harmonic(1);
+       harmonic * frequency < 0.5f;
+       ++harmonic) {
+    const double omega(2.0 * openmini::Pi * harmonic * frequency);
+    double real(0.0);
+    double imaginary(0.0);
+    for (unsigned int i(0); i < length; ++i) {
+      real += signal[i] * std::cos(omega * i);
+      imaginary += signal[i] * std::sin(omega * i);
+    }
+    real *= 2.0 / length;
+    imaginary *= 2.0 / length;
+    harmonics += 0.5 * (real * real + imaginary * imaginary);
+  }
+  BufferReader reader(signal);
+  const double power(ComputePower(reader, length));
+  return 10.0 * std::log10(std::max(power - harmonics, 1e-12) / harmonics);
+}
+
+/// @brief All polyBLEP generators should stay within [-1.0f ; 1.0f]
+/// and have the expected fundamental frequency
+TEST(PolyBlep, Frequency) {
+  for (const Type type : {GeneratorType::kTrianglePolyBlep,
+                          GeneratorType::kSawtoothPolyBlep,
+                          GeneratorType::kPulsePolyBlep}) {
+    const float kFrequency(kFreqDistribution(kRandomGenerator));
+    std::vector<float> output(kDataTestSetSize);
+    Render(type, kFrequency, &output);
+    for (const float value : output) {
+      EXPECT_GE(1.0f + 1e-3f, std::fabs(value)) << kGeneratorNames[type];
+    }
+    // Two zero crossings per period
+    BufferReader reader(output);
+    const float expected(2.0f * kFrequency * kDataTestSetSize);
+    const unsigned int actual(ComputeZeroCrossing(reader, kDataTestSetSize));
+    EXPECT_NEAR(expected, static_cast<float>(actual), 2.0f)
+      << kGeneratorNames[type];
+  }
+}
+
+/// @brief Block and per Sample rendering should be the same
+TEST(PolyBlep, BlockProcessing) {
+  const float kFrequency(kFreqDistribution(kRandomGenerator));
+  openmini::generators::SawtoothPolyBlep block(0.3f);
+  openmini::generators::SawtoothPolyBlep sample(0.3f);
+  for (PolyBlep_Base* generator : {static_cast<PolyBlep_Base*>(&block),
+                                   static_cast<PolyBlep_Base*>(&sample)}) {
+    generator->SetFrequency(kFrequency);
+  }
+  std::vector<float> output(kDataTestSetSize);
+  block.Process(&output[0], kDataTestSetSize);
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(VectorMath::Fill(&output[i]), sample()));
+  }
+}
+
+/// @brief A generator restored from its logical state should render
+/// the very same output as the captured one
+TEST(PolyBlep, SnapshotRestore) {
+  EXPECT_TRUE(std::is_trivially_copyable<
+    openmini::generators::GeneratorState>::value);
+  const Wavetables* tables(
+    Wavetables::Acquire(SamplingRate::Instance().Get()));
+  for (const Type type : {GeneratorType::kTrianglePolyBlep,
+                          GeneratorType::kSawtoothPolyBlep,
+                          GeneratorType::kPulsePolyBlep,
+                          GeneratorType::kTriangleWavetable,
+                          GeneratorType::kSawtoothWavetable}) {
+    const float kFrequency(kFreqDistribution(kRandomGenerator));
+    void* slot(openmini::Allocate(openmini::generators::GeneratorSlotSize()));
+    void* other_slot(
+      openmini::Allocate(openmini::generators::GeneratorSlotSize()));
+    Generator_Base* generator(
+      openmini::generators::CreateGenerator(slot, type, 0.3f));
+    SetTables(type, tables, generator);
+    generator->SetFrequency(kFrequency);
+    for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+      (*generator)();
+    }
+    openmini::generators::GeneratorState state;
+    openmini::generators::SnapshotGenerator(*generator,
+                                            type,
+                                            0.0f,
+                                            kFrequency,
+                                            &state);
+    Generator_Base* restored(
+      openmini::generators::RestoreGenerator(other_slot, state));
+    SetTables(type, tables, restored);
+    for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+      EXPECT_TRUE(VectorMath::Equal((*generator)(), (*restored)()))
+        << kGeneratorNames[type];
+    }
+    openmini::generators::DestroyGeneratorInPlace(restored);
+    openmini::generators::DestroyGeneratorInPlace(generator);
+    openmini::Deallocate(other_slot);
+    openmini::Deallocate(slot);
+  }
+  Wavetables::Release(tables);
+}
+
+/// @brief Aliasing of all generators at high notes,
+/// polyBLEP and wavetable ones compared to DPW ones
+TEST(PolyBlep, Aliasing) {
+  const unsigned int kAliasingDataLength(16384);
+  // ~2.5kHz and ~5kHz at 48kHz, not an integer number of samples per period
+  for (const float frequency : {0.0513f, 0.1037f}) {
+    double ratios[GeneratorType::kCount];
+    std::vector<float> output(kAliasingDataLength);
+    for (unsigned int type(0); type < GeneratorType::kCount; ++type) {
+      Render(static_cast<Type>(type), frequency, &output);
+      ratios[type] = ComputeAliasingRatio(output, frequency);
+      std::printf("[ PERF     ] %s aliasing at %.4f: %.1f dB\n",
+                  kGeneratorNames[type],
+                  frequency,
+                  ratios[type]);
+    }
+    EXPECT_GT(ratios[GeneratorType::kSawtoothDPW],
+              ratios[GeneratorType::kSawtoothPolyBlep]);
+    EXPECT_GT(ratios[GeneratorType::kSawtoothPolyBlep],
+              ratios[GeneratorType::kSawtoothWavetable]);
+  }
+}
+
+/// @brief Generates a signal, by block or per Sample (performance test)
+TEST(PolyBlep, Perf) {
+  const float kFrequency(kFreqDistribution(kRandomGenerator));
+  std::vector<float> output(kGeneratorDataPerfSetSize);
+  const Wavetables* tables(
+    Wavetables::Acquire(SamplingRate::Instance().Get()));
+  void* slot(openmini::Allocate(openmini::generators::GeneratorSlotSize()));
+  for (unsigned int type(0); type < GeneratorType::kCount; ++type) {
+    Generator_Base* generator(openmini::generators::CreateGenerator(
+      slot,
+      static_cast<Type>(type)));
+    SetTables(static_cast<Type>(type), tables, generator);
+    generator->SetFrequency(kFrequency);
+    generator->ProcessParameters();
+
+    PerfCounters counters;
+    counters.Start();
+    for (unsigned int i(0); i < kGeneratorDataPerfSetSize; i += SampleSize) {
+      VectorMath::StoreUnaligned(&output[i], (*generator)());
+    }
+    counters.Stop();
+    counters.Report(kGeneratorNames[type], kGeneratorDataPerfSetSize);
+
+    if (type >= GeneratorType::kTrianglePolyBlep) {
+      counters.Start();
+      if (type <= GeneratorType::kPulsePolyBlep) {
+        static_cast<PolyBlep_Base*>(generator)->Process(
+          &output[0],
+          kGeneratorDataPerfSetSize);
+      } else {
+        static_cast<WavetableOscillator*>(generator)->Process(
+          &output[0],
+          kGeneratorDataPerfSetSize);
+      }
+      counters.Stop();
+      const std::string name(std::string(kGeneratorNames[type]) + ", block");
+      counters.Report(name.c_str(), kGeneratorDataPerfSetSize);
+    }
+    openmini::generators::DestroyGeneratorInPlace(generator);
+  }
+  openmini::Deallocate(slot);
+  Wavetables::Release(tables);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
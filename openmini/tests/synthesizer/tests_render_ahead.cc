@@ -0,0 +1,304 @@
+/// @filename tests_render_ahead.cc
+/// @brief RenderAhead specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <thread>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/render_ahead.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::RenderAhead;
+using openmini::synthesizer::Synthesizer;
+
+/// @brief Host-like block size used in these tests
+static const unsigned int kHostBlockSize(256);
+
+/// @brief Lookahead used in these tests
+static const unsigned int kLookahead(1024);
+
+/// @brief Time given to the worker to notice events in these tests
+static const std::chrono::milliseconds kWorkerReactionTime(100);
+
+/// @brief Wait until the worker rendered enough samples for one host block
+///
+/// This emulates a host calling back at the actual audio rate
+static void WaitForBlock(const RenderAhead& render_ahead,
+                         const unsigned int length) {
+  while (render_ahead.Available() < length) {
+    std::this_thread::yield();
+  }
+}
+
+/// @brief Without any event, the output should be exactly the same
+/// as the synthesizer one processed directly
+TEST(RenderAhead, SameOutput) {
+  const unsigned int kDataLength(32 * kHostBlockSize);
+  std::vector<float> expected(kDataLength);
+  std::vector<float> actual(kDataLength);
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    synth.NoteOn(kMinKeyNote + 37);
+    for (unsigned int i(0); i < kDataLength; i += kHostBlockSize) {
+      synth.ProcessAudio(&expected[i], kHostBlockSize);
+    }
+  }
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    synth.NoteOn(kMinKeyNote + 37);
+    RenderAhead render_ahead(&synth, kLookahead);
+    render_ahead.Start();
+    EXPECT_TRUE(render_ahead.IsRunning());
+    for (unsigned int i(0); i < kDataLength; i += kHostBlockSize) {
+      WaitForBlock(render_ahead, kHostBlockSize);
+      render_ahead.ProcessAudio(&actual[i], kHostBlockSize);
+    }
+    render_ahead.Stop();
+    EXPECT_FALSE(render_ahead.IsRunning());
+    EXPECT_EQ(0u, render_ahead.UnderrunsCount());
+  }
+
+  for (unsigned int i(0); i < kDataLength; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+}
+
+/// @brief Events sent while running should re-render the samples not played
+/// yet: the output should be exactly the same as the synthesizer one
+/// processed directly, events being applied at the same host block boundaries
+TEST(RenderAhead, EventsReRendered) {
+  const unsigned int kDataLength(32 * kHostBlockSize);
+  const unsigned int kNoteOnBlock(4);
+  const unsigned int kParameterBlock(9);
+  const unsigned int kNoteOffBlock(17);
+  const float kCutoff(0.25f);
+  std::vector<float> expected(kDataLength);
+  std::vector<float> actual(kDataLength);
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    for (unsigned int block(0); block < kDataLength / kHostBlockSize;
+         ++block) {
+      if (kNoteOnBlock == block) {
+        synth.NoteOn(kMinKeyNote + 37);
+      } else if (kParameterBlock == block) {
+        synth.SetValue(openmini::synthesizer::Parameters::kFilterFreq,
+                       kCutoff);
+      } else if (kNoteOffBlock == block) {
+        synth.NoteOff(kMinKeyNote + 37);
+      }
+      synth.ProcessAudio(&expected[block * kHostBlockSize], kHostBlockSize);
+    }
+  }
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    RenderAhead render_ahead(&synth, kLookahead);
+    render_ahead.Start();
+    for (unsigned int block(0); block < kDataLength / kHostBlockSize;
+         ++block) {
+      if (kNoteOnBlock == block) {
+        render_ahead.NoteOn(kMinKeyNote + 37);
+      } else if (kParameterBlock == block) {
+        render_ahead.SetValue(openmini::synthesizer::Parameters::kFilterFreq,
+                              kCutoff);
+      } else if (kNoteOffBlock == block) {
+        render_ahead.NoteOff(kMinKeyNote + 37);
+      }
+      if ((kNoteOnBlock == block)
+          || (kParameterBlock == block)
+          || (kNoteOffBlock == block)) {
+        // Host blocks are block-aligned: the event is applied right here
+        std::this_thread::sleep_for(kWorkerReactionTime);
+      }
+      WaitForBlock(render_ahead, kHostBlockSize);
+      render_ahead.ProcessAudio(&actual[block * kHostBlockSize],
+                                kHostBlockSize);
+    }
+    render_ahead.Stop();
+    EXPECT_EQ(0u, render_ahead.UnderrunsCount());
+    EXPECT_EQ(kCutoff,
+              render_ahead.GetValue(
+                openmini::synthesizer::Parameters::kFilterFreq));
+  }
+
+  for (unsigned int i(0); i < kDataLength; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+}
+
+/// @brief Notes and parameters sent while running are taken into account,
+/// at most one block later - not the lookahead
+TEST(RenderAhead, EventsLatency) {
+  Synthesizer synth;
+  synth.SetOutputSamplingFrequency(48000.0f);
+  RenderAhead render_ahead(&synth, kLookahead);
+  render_ahead.Start();
+  // Instantaneous attack
+  render_ahead.SetValue(openmini::synthesizer::Parameters::kAttackTime, 0.0f);
+
+  std::vector<float> data(kHostBlockSize);
+  // Silence before the note on
+  for (unsigned int block(0); block < 8; ++block) {
+    WaitForBlock(render_ahead, kHostBlockSize);
+    render_ahead.ProcessAudio(&data[0], kHostBlockSize);
+    for (const float sample : data) {
+      EXPECT_EQ(0.0f, sample);
+    }
+  }
+
+  EXPECT_TRUE(render_ahead.NoteOn(kMinKeyNote + 37));
+  std::this_thread::sleep_for(kWorkerReactionTime);
+  unsigned int sample_idx(0);
+  bool audible(false);
+  while (!audible && (sample_idx < 4 * kLookahead)) {
+    WaitForBlock(render_ahead, kHostBlockSize);
+    render_ahead.ProcessAudio(&data[0], kHostBlockSize);
+    for (unsigned int i(0); i < kHostBlockSize; ++i) {
+      if (std::fabs(data[i]) > 1e-3f) {
+        audible = true;
+        sample_idx += i;
+        break;
+      }
+    }
+    if (!audible) {
+      sample_idx += kHostBlockSize;
+    }
+  }
+  render_ahead.Stop();
+
+  EXPECT_TRUE(audible);
+  EXPECT_GE(render_ahead.Latency(), sample_idx);
+}
+
+/// @brief The tail length should follow parameters sent while running
+TEST(RenderAhead, TailLength) {
+  const float kDecayTime(0.0f);
+  Synthesizer reference;
+  reference.SetOutputSamplingFrequency(48000.0f);
+  Synthesizer synth;
+  synth.SetOutputSamplingFrequency(48000.0f);
+  RenderAhead render_ahead(&synth, kLookahead);
+  EXPECT_EQ(reference.TailLength(), render_ahead.TailLength());
+  render_ahead.Start();
+
+  reference.SetValue(openmini::synthesizer::Parameters::kDecayTime,
+                     kDecayTime);
+  render_ahead.SetValue(openmini::synthesizer::Parameters::kDecayTime,
+                        kDecayTime);
+  std::this_thread::sleep_for(kWorkerReactionTime);
+  EXPECT_NE(reference.TailLength(), Synthesizer().TailLength());
+  EXPECT_EQ(reference.TailLength(), render_ahead.TailLength());
+  render_ahead.Stop();
+}
+
+/// @brief Output flagged as silent should only be zeros, from before
+/// the note on to after the synthesizer went back to sleep
+TEST(RenderAhead, SilentOutput) {
+  const unsigned int kBlocksCount(64);
+  const unsigned int kNoteOnBlock(4);
+  const unsigned int kNoteOffBlock(12);
+  Synthesizer synth;
+  synth.SetOutputSamplingFrequency(48000.0f);
+  synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.0f);
+  RenderAhead render_ahead(&synth, kLookahead);
+  render_ahead.Start();
+
+  std::vector<float> data(kHostBlockSize);
+  unsigned int silent_count(0);
+  for (unsigned int block(0); block < kBlocksCount; ++block) {
+    if (kNoteOnBlock == block) {
+      EXPECT_TRUE(render_ahead.NoteOn(kMinKeyNote + 37));
+    } else if (kNoteOffBlock == block) {
+      EXPECT_TRUE(render_ahead.NoteOff(kMinKeyNote + 37));
+    }
+    WaitForBlock(render_ahead, kHostBlockSize);
+    render_ahead.ProcessAudio(&data[0], kHostBlockSize);
+    if (0 == block) {
+      EXPECT_TRUE(render_ahead.IsOutputSilent());
+    }
+    if (render_ahead.IsOutputSilent()) {
+      silent_count += 1;
+      for (const float sample : data) {
+        EXPECT_EQ(0.0f, sample);
+      }
+    }
+  }
+  // Back to sleep
+  EXPECT_TRUE(render_ahead.IsOutputSilent());
+  EXPECT_GT(kBlocksCount, silent_count);
+  render_ahead.Stop();
+}
+
+/// @brief Host callback cost with and without rendering ahead,
+/// the host being "late" on some callbacks (performance test)
+TEST(RenderAhead, Perf) {
+  const unsigned int kBlocksCount(kFilterDataPerfSetSize / kHostBlockSize);
+  std::vector<float> data(kHostBlockSize);
+  double direct_max(0.0);
+  double ahead_max(0.0);
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    synth.NoteOn(kMinKeyNote + 37);
+    for (unsigned int block(0); block < kBlocksCount; ++block) {
+      const std::chrono::high_resolution_clock::time_point start(
+        std::chrono::high_resolution_clock::now());
+      synth.ProcessAudio(&data[0], kHostBlockSize);
+      direct_max = std::max(direct_max,
+                            std::chrono::duration<double>(
+                              std::chrono::high_resolution_clock::now()
+                              - start).count());
+    }
+  }
+  unsigned int underruns(0);
+  {
+    Synthesizer synth;
+    synth.SetOutputSamplingFrequency(48000.0f);
+    synth.NoteOn(kMinKeyNote + 37);
+    RenderAhead render_ahead(&synth, kLookahead);
+    render_ahead.Start();
+    for (unsigned int block(0); block < kBlocksCount; ++block) {
+      WaitForBlock(render_ahead, kHostBlockSize);
+      const std::chrono::high_resolution_clock::time_point start(
+        std::chrono::high_resolution_clock::now());
+      render_ahead.ProcessAudio(&data[0], kHostBlockSize);
+      ahead_max = std::max(ahead_max,
+                           std::chrono::duration<double>(
+                             std::chrono::high_resolution_clock::now()
+                             - start).count());
+    }
+    render_ahead.Stop();
+    underruns = render_ahead.UnderrunsCount();
+  }
+  std::printf("[ PERF     ] Host callback worst case: direct %.3f us, "
+              "render ahead %.3f us (%u underruns)\n",
+              1e6 * direct_max,
+              1e6 * ahead_max,
+              underruns);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
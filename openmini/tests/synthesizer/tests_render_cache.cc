@@ -0,0 +1,260 @@
+/// @filename tests_render_cache.cc
+/// @brief RenderCache specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+// std::snprintf
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/render_cache.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::OfflineEvent;
+using openmini::synthesizer::RenderCache;
+using openmini::synthesizer::Synthesizer;
+
+/// @brief Sampling rate used in these tests
+static const float kCacheSamplingRate(48000.0f);
+
+/// @brief Render length used in these tests
+static const unsigned int kCacheRenderLength(8192);
+
+/// @brief Directory the tests renders are stored into
+static const std::string kCacheDirectory("openmini_tests_render_cache");
+
+/// @brief One note of the given length
+static std::vector<OfflineEvent> BuildNote(const int note,
+                                           const unsigned int duration) {
+  std::vector<OfflineEvent> events;
+  events.push_back({0, OfflineEvent::kNoteOn, note, 0.0f});
+  events.push_back({duration, OfflineEvent::kNoteOff, note, 0.0f});
+  return events;
+}
+
+/// @brief Identical renders should be found into the cache,
+/// and be the same as actual renders
+TEST(RenderCache, HitMiss) {
+  RenderCache cache(kCacheDirectory, 1 << 20);
+  cache.Clear();
+  Synthesizer patch;
+  patch.SetValue(openmini::synthesizer::Parameters::kFilterFreq, 0.3f);
+  const std::vector<OfflineEvent> events(BuildNote(kMinKeyNote + 13,
+                                                   kCacheRenderLength / 2));
+
+  std::vector<float> expected;
+  EXPECT_FALSE(cache.Render(patch,
+                            events,
+                            kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &expected));
+  EXPECT_EQ(kCacheRenderLength, expected.size());
+  // All renders below have the same inputs count, hence the same file size
+  const size_t kFileSize(cache.Size());
+  EXPECT_LT(kCacheRenderLength * sizeof(float), kFileSize);
+  std::vector<float> actual;
+  EXPECT_TRUE(cache.Render(patch,
+                           events,
+                           kCacheRenderLength,
+                           kCacheSamplingRate,
+                           &actual));
+  ASSERT_EQ(expected.size(), actual.size());
+  for (unsigned int i(0); i < kCacheRenderLength; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+
+  // Any change is a miss
+  EXPECT_FALSE(cache.Render(patch,
+                            BuildNote(kMinKeyNote + 14,
+                                      kCacheRenderLength / 2),
+                            kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &actual));
+  patch.SetValue(openmini::synthesizer::Parameters::kFilterFreq, 0.4f);
+  EXPECT_FALSE(cache.Render(patch,
+                            events,
+                            kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &actual));
+  EXPECT_EQ(1u, cache.Hits());
+  EXPECT_EQ(3u, cache.Misses());
+  EXPECT_DOUBLE_EQ(0.25, cache.HitRate());
+  EXPECT_EQ(3u, cache.Count());
+  EXPECT_EQ(3 * kFileSize, cache.Size());
+
+  // Already stored renders are found again by another cache
+  RenderCache other(kCacheDirectory, 1 << 20);
+  EXPECT_EQ(3u, other.Count());
+  EXPECT_TRUE(other.Render(patch,
+                           events,
+                           kCacheRenderLength,
+                           kCacheSamplingRate,
+                           &actual));
+  other.Clear();
+}
+
+/// @brief Least recently used renders should be evicted first
+TEST(RenderCache, Eviction) {
+  Synthesizer patch;
+  std::vector<float> output;
+  const std::vector<OfflineEvent> first(BuildNote(kMinKeyNote + 13, 256));
+  const std::vector<OfflineEvent> second(BuildNote(kMinKeyNote + 14, 256));
+  const std::vector<OfflineEvent> third(BuildNote(kMinKeyNote + 15, 256));
+  // All renders below have the same inputs count, hence the same file size
+  size_t render_size(0);
+  {
+    RenderCache cache(kCacheDirectory, 1 << 20);
+    cache.Clear();
+    cache.Render(patch, first, kCacheRenderLength, kCacheSamplingRate, &output);
+    render_size = cache.Size();
+    cache.Clear();
+  }
+  RenderCache cache(kCacheDirectory, 2 * render_size);
+
+  cache.Render(patch, first, kCacheRenderLength, kCacheSamplingRate, &output);
+  cache.Render(patch, second, kCacheRenderLength, kCacheSamplingRate, &output);
+  // First one used again: the second one is the least recently used
+  EXPECT_TRUE(cache.Render(patch,
+                           first,
+                           kCacheRenderLength,
+                           kCacheSamplingRate,
+                           &output));
+  cache.Render(patch, third, kCacheRenderLength, kCacheSamplingRate, &output);
+  EXPECT_EQ(2u, cache.Count());
+  EXPECT_EQ(2 * render_size, cache.Size());
+  EXPECT_TRUE(cache.Render(patch,
+                           first,
+                           kCacheRenderLength,
+                           kCacheSamplingRate,
+                           &output));
+  EXPECT_TRUE(cache.Render(patch,
+                           third,
+                           kCacheRenderLength,
+                           kCacheSamplingRate,
+                           &output));
+  EXPECT_FALSE(cache.Render(patch,
+                            second,
+                            kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &output));
+
+  // Renders bigger than the whole cache are never stored
+  EXPECT_FALSE(cache.Render(patch,
+                            first,
+                            3 * kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &output));
+  EXPECT_FALSE(cache.Render(patch,
+                            first,
+                            3 * kCacheRenderLength,
+                            kCacheSamplingRate,
+                            &output));
+  EXPECT_EQ(2u, cache.Count());
+  cache.Clear();
+}
+
+/// @brief Renders stored with other inputs under the same key,
+/// or in another format, should be misses
+TEST(RenderCache, InputsMismatch) {
+  RenderCache cache(kCacheDirectory, 1 << 20);
+  cache.Clear();
+  Synthesizer patch;
+  const std::vector<uint32_t> inputs(RenderCache::DescribeInputs(
+    patch,
+    BuildNote(kMinKeyNote + 13, 256),
+    kCacheRenderLength,
+    kCacheSamplingRate));
+  const std::vector<uint32_t> other_inputs(RenderCache::DescribeInputs(
+    patch,
+    BuildNote(kMinKeyNote + 14, 256),
+    kCacheRenderLength,
+    kCacheSamplingRate));
+  const uint64_t key(RenderCache::ComputeKey(inputs));
+  const std::vector<float> render(kCacheRenderLength, 0.5f);
+  std::vector<float> output;
+
+  // Emulating a hash collision
+  cache.Store(key, other_inputs, &render[0], kCacheRenderLength);
+  EXPECT_EQ(1u, cache.Count());
+  EXPECT_FALSE(cache.Fetch(key, inputs, &output));
+  EXPECT_EQ(0u, cache.Count());
+
+  cache.Store(key, inputs, &render[0], kCacheRenderLength);
+  EXPECT_TRUE(cache.Fetch(key, inputs, &output));
+  EXPECT_EQ(render, output);
+  cache.Clear();
+
+  // Emulating a render file without any header
+  char name[64];
+  std::snprintf(name,
+                sizeof(name),
+                "/%016llx.render",
+                static_cast<unsigned long long>(key));  // NOLINT
+  {
+    std::ofstream file((kCacheDirectory + name).c_str(), std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&render[0]),
+               render.size() * sizeof(float));
+  }
+  RenderCache other(kCacheDirectory, 1 << 20);
+  EXPECT_EQ(1u, other.Count());
+  EXPECT_FALSE(other.Fetch(key, inputs, &output));
+  EXPECT_EQ(0u, other.Count());
+  other.Clear();
+}
+
+/// @brief Actual render versus cached one (performance test)
+TEST(RenderCache, Perf) {
+  const unsigned int kRendersCount(16);
+  RenderCache cache(kCacheDirectory, 1 << 24);
+  cache.Clear();
+  Synthesizer patch;
+  std::vector<float> output;
+
+  double elapsed[2] = {0.0, 0.0};
+  for (unsigned int pass(0); pass < 2; ++pass) {
+    const std::chrono::high_resolution_clock::time_point start(
+      std::chrono::high_resolution_clock::now());
+    for (unsigned int i(0); i < kRendersCount; ++i) {
+      cache.Render(patch,
+                   BuildNote(kMinKeyNote + 13 + i, kCacheRenderLength / 2),
+                   kCacheRenderLength,
+                   kCacheSamplingRate,
+                   &output);
+    }
+    elapsed[pass] = std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start).count();
+  }
+
+  std::printf("[ PERF     ] %u renders of %u samples: rendered %.3f ms, "
+              "cached %.3f ms (hit rate %.2f)\n",
+              kRendersCount,
+              kCacheRenderLength,
+              1e3 * elapsed[0],
+              1e3 * elapsed[1],
+              cache.HitRate());
+  cache.Clear();
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
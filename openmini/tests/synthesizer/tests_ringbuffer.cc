@@ -19,11 +19,13 @@
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
 
 #include "openmini/src/synthesizer/ringbuffer.h"
 
 // Using declarations for tested class
 using openmini::synthesizer::RingBuffer;
+using openmini::synthesizer::IsMultipleOf;
 
 /// @brief Push and pop random data of random length,
 /// and check that no data gets corrupted
@@ -31,7 +33,7 @@ TEST(Synthesizer, RingBufferRandomPushPop) {
   std::uniform_int_distribution<int> kLengthDistribution(1, kDataTestSetSize);
   const unsigned int kRingbufferLength(
     GetNextMultiple(kLengthDistribution(kRandomGenerator), SampleSize));
-  RingBuffer ringbuf(kRingbufferLength);
+  RingBuffer<float> ringbuf(kRingbufferLength);
   // Creating random data
   std::vector<float> data(kRingbufferLength);
   std::vector<float> data_out(kRingbufferLength);
@@ -70,7 +72,7 @@ TEST(Synthesizer, RingBufferTypicalUse) {
   const unsigned int kDataLength(GetNextMultiple(GetNextMultiple(32768, 3303),
                                                  SampleSize));
 
-  RingBuffer ringbuf(kBlockSize);
+  RingBuffer<float> ringbuf(kBlockSize);
   // Creating random data
   std::vector<float> data(kDataLength);
   std::vector<float> data_out(kDataLength);
@@ -104,7 +106,7 @@ TEST(Synthesizer, RingBufferZeroPush) {
   std::uniform_int_distribution<int> kLengthDistribution(1, kDataTestSetSize);
   const unsigned int kRingbufferLength(
     GetNextMultiple(kLengthDistribution(kRandomGenerator), SampleSize));
-  RingBuffer ringbuf(kRingbufferLength);
+  RingBuffer<float> ringbuf(kRingbufferLength);
   // Creating random data
   std::vector<float> data(kRingbufferLength);
   std::vector<float> data_out(kRingbufferLength);
@@ -148,7 +150,7 @@ TEST(Synthesizer, RingBufferZeroPop) {
   std::uniform_int_distribution<int> kLengthDistribution(1, kDataTestSetSize);
   const unsigned int kRingbufferLength(
     GetNextMultiple(kLengthDistribution(kRandomGenerator), SampleSize));
-  RingBuffer ringbuf(kRingbufferLength);
+  RingBuffer<float> ringbuf(kRingbufferLength);
   // Creating random data
   std::vector<float> data(kRingbufferLength);
   std::vector<float> data_out(kRingbufferLength);
@@ -194,7 +196,7 @@ TEST(Synthesizer, RingBufferReserve) {
   std::uniform_int_distribution<int> kPushBlockSizeDistribution(1,
                                                                 kRingbufferLength);
   const unsigned int kPushBlockSize(kPushBlockSizeDistribution(kRandomGenerator));
-  RingBuffer ringbuf;
+  RingBuffer<float> ringbuf(kRingbufferLength, kPushBlockSize);
   ringbuf.Reserve(kRingbufferLength, kPushBlockSize);
   // Creating random data
   std::vector<float> data(kRingbufferLength);
@@ -225,3 +227,47 @@ TEST(Synthesizer, RingBufferReserve) {
     EXPECT_EQ(data[i], data_out[i]);
   }
 }
+
+/// @brief Check that the capacity is always a power of two,
+/// big enough for the requested length, and never changes when pushing
+TEST(Synthesizer, RingBufferCapacity) {
+  std::uniform_int_distribution<int> kLengthDistribution(1, kDataTestSetSize);
+  for (unsigned int iteration(0); iteration < 64; ++iteration) {
+    const unsigned int kRingbufferLength(kLengthDistribution(kRandomGenerator));
+    RingBuffer<float> ringbuf(kRingbufferLength);
+    const unsigned int kCapacity(ringbuf.Capacity());
+    EXPECT_LE(kRingbufferLength, kCapacity);
+    EXPECT_EQ(0u, kCapacity & (kCapacity - 1));
+
+    const Sample kInput(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+    while (ringbuf.Size() < kRingbufferLength) {
+      ringbuf.Push(kInput);
+    }
+    EXPECT_EQ(kCapacity, ringbuf.Capacity());
+    EXPECT_TRUE(IsMultipleOf(ringbuf.Size(), SampleSize));
+  }
+}
+
+/// @brief Typical use with a host-like block size (performance test)
+TEST(Synthesizer, RingBufferPerf) {
+  const unsigned int kBlockSize(512);
+  RingBuffer<float> ringbuf(kBlockSize);
+  std::vector<float> data_out(kBlockSize);
+  const Sample kInput(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+
+  PerfCounters counters;
+  counters.Start();
+  unsigned int out_data_idx(0);
+  while (out_data_idx < kFilterDataPerfSetSize) {
+    while (ringbuf.Size() < kBlockSize) {
+      ringbuf.Push(kInput);
+    }
+    ringbuf.Pop(&data_out[0], kBlockSize);
+    out_data_idx += kBlockSize;
+  }
+  counters.Stop();
+  counters.Report("RingBuffer", out_data_idx);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
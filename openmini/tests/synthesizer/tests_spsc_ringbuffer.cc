@@ -0,0 +1,157 @@
+/// @filename tests_spsc_ringbuffer.cc
+/// @brief SpscRingBuffer specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <thread>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/spsc_ringbuffer.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::SpscRingBuffer;
+
+/// @brief Elements count transferred by threaded tests
+static const unsigned int kSpscTransferCount(1 << 20);
+
+/// @brief Push and pop more than possible: counts are clamped, nothing asserts
+TEST(Synthesizer, SpscRingBufferBounds) {
+  SpscRingBuffer<float> ringbuf(1000);
+  const unsigned int kCapacity(ringbuf.Capacity());
+  EXPECT_LE(1000u, kCapacity);
+  std::vector<float> data(2 * kCapacity);
+  std::generate(data.begin(),
+                data.end(),
+                std::bind(kNormDistribution, kRandomGenerator));
+  std::vector<float> data_out(data.size());
+
+  EXPECT_EQ(0u, ringbuf.Pop(&data_out[0], 1));
+  EXPECT_EQ(kCapacity, ringbuf.Push(&data[0], 2 * kCapacity));
+  EXPECT_EQ(0u, ringbuf.WriteAvailable());
+  EXPECT_EQ(0u, ringbuf.Push(&data[0], 1));
+  EXPECT_EQ(kCapacity, ringbuf.Pop(&data_out[0], 2 * kCapacity));
+  EXPECT_EQ(0u, ringbuf.ReadAvailable());
+
+  for (unsigned int i(0); i < kCapacity; ++i) {
+    EXPECT_EQ(data[i], data_out[i]);
+  }
+}
+
+/// @brief One thread pushes an increasing sequence by random chunks,
+/// another one pops it by random chunks and checks that no element is lost,
+/// duplicated or reordered
+TEST(Synthesizer, SpscRingBufferThreadedPushPop) {
+  SpscRingBuffer<unsigned int> ringbuf(1024);
+  const unsigned int kMaxChunk(3 * ringbuf.Capacity() / 2);
+
+  std::thread producer([&ringbuf, kMaxChunk]() {
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<unsigned int> chunk_distribution(1,
+                                                                   kMaxChunk);
+    std::vector<unsigned int> chunk(kMaxChunk);
+    unsigned int next(0);
+    while (next < kSpscTransferCount) {
+      const unsigned int kCount(std::min(chunk_distribution(generator),
+                                         kSpscTransferCount - next));
+      for (unsigned int i(0); i < kCount; ++i) {
+        chunk[i] = next + i;
+      }
+      const unsigned int kPushed(ringbuf.Push(&chunk[0], kCount));
+      if (0 == kPushed) {
+        std::this_thread::yield();
+      }
+      next += kPushed;
+    }
+  });
+
+  std::mt19937 generator(2);
+  std::uniform_int_distribution<unsigned int> chunk_distribution(1, kMaxChunk);
+  std::vector<unsigned int> chunk(kMaxChunk);
+  unsigned int expected(0);
+  unsigned int errors(0);
+  while (expected < kSpscTransferCount) {
+    const unsigned int kCount(ringbuf.Pop(&chunk[0],
+                                          chunk_distribution(generator)));
+    for (unsigned int i(0); i < kCount; ++i) {
+      errors += (chunk[i] != expected + i) ? 1 : 0;
+    }
+    if (0 == kCount) {
+      std::this_thread::yield();
+    }
+    expected += kCount;
+  }
+  producer.join();
+
+  EXPECT_EQ(0u, errors);
+  EXPECT_EQ(kSpscTransferCount, expected);
+  EXPECT_EQ(0u, ringbuf.ReadAvailable());
+}
+
+/// @brief Same as above, using spans on both sides:
+/// the producer renders directly into the buffer,
+/// the consumer reads directly from it
+TEST(Synthesizer, SpscRingBufferThreadedSpans) {
+  SpscRingBuffer<float> ringbuf(512);
+
+  std::thread producer([&ringbuf]() {
+    unsigned int next(0);
+    while (next < kSpscTransferCount) {
+      const SpscRingBuffer<float>::Spans spans(
+        ringbuf.GetWriteSpans(kSpscTransferCount - next));
+      for (unsigned int i(0); i < spans.first_count; ++i) {
+        spans.first[i] = static_cast<float>((next + i) & 0xFFFF);
+      }
+      for (unsigned int i(0); i < spans.second_count; ++i) {
+        spans.second[i] = static_cast<float>(
+          (next + spans.first_count + i) & 0xFFFF);
+      }
+      const unsigned int kCount(spans.first_count + spans.second_count);
+      ringbuf.CommitWrite(kCount);
+      if (0 == kCount) {
+        std::this_thread::yield();
+      }
+      next += kCount;
+    }
+  });
+
+  unsigned int expected(0);
+  unsigned int errors(0);
+  while (expected < kSpscTransferCount) {
+    const SpscRingBuffer<float>::Spans spans(ringbuf.GetReadSpans(64));
+    for (unsigned int i(0); i < spans.first_count; ++i) {
+      const float kExpected(static_cast<float>((expected + i) & 0xFFFF));
+      errors += (spans.first[i] != kExpected) ? 1 : 0;
+    }
+    for (unsigned int i(0); i < spans.second_count; ++i) {
+      const float kExpected(static_cast<float>(
+        (expected + spans.first_count + i) & 0xFFFF));
+      errors += (spans.second[i] != kExpected) ? 1 : 0;
+    }
+    const unsigned int kCount(spans.first_count + spans.second_count);
+    ringbuf.CommitRead(kCount);
+    if (0 == kCount) {
+      std::this_thread::yield();
+    }
+    expected += kCount;
+  }
+  producer.join();
+
+  EXPECT_EQ(0u, errors);
+  EXPECT_EQ(kSpscTransferCount, expected);
+}
@@ -18,10 +18,17 @@
 /// You should have received a copy of the GNU General Public License
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
 #include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
 
 #include "openmini/src/synthesizer/parameters.h"
 #include "openmini/src/synthesizer/synthesizer.h"
+#include "openmini/src/synthesizer/wavetables.h"
 
 // Using declarations for tested class
 using openmini::synthesizer::Synthesizer;
@@ -243,12 +250,16 @@ TEST(Synthesizer, Perf96k) {
     synth.SetValue(param_id, kNormPosDistribution(kRandomGenerator));
   }
 
+  PerfCounters counters;
+  counters.Start();
   while (sample_idx < static_cast<unsigned int>(kSynthesizerPerfSetLength
                                                 * kOutFrequency)) {
     // not storing everything, only creating an "history"
     synth.ProcessAudio(&data[0], openmini::kBlockSize);
     sample_idx += openmini::kBlockSize;
   }
+  counters.Stop();
+  counters.Report("Synthesizer 96k", sample_idx);
 
   // No actual test!
   EXPECT_TRUE(true);
@@ -271,12 +282,16 @@ TEST(Synthesizer, Perf48k) {
     synth.SetValue(param_id, kNormPosDistribution(kRandomGenerator));
   }
 
+  PerfCounters counters;
+  counters.Start();
   while (sample_idx < static_cast<unsigned int>(kSynthesizerPerfSetLength
                                                 * kOutFrequency)) {
     // not storing everything, only creating an "history"
     synth.ProcessAudio(&data[0], openmini::kBlockSize);
     sample_idx += openmini::kBlockSize;
   }
+  counters.Stop();
+  counters.Report("Synthesizer 48k", sample_idx);
 
   // No actual test!
   EXPECT_TRUE(true);
@@ -397,7 +412,14 @@ TEST(Synthesizer, ParametersMax) {
     for (unsigned int param_id(0);
          param_id < openmini::synthesizer::Parameters::kCount;
          ++param_id) {
-      synth.SetValue(param_id, 1.0f);
+      // Noise is discontinuous by nature: it is kept muted here.
+      // Wavetables ringing around the sawtooth edge is seen as clicks:
+      // the engine is kept to its default one
+      if ((param_id != openmini::synthesizer::Parameters::kNoiseVolume)
+          && (param_id
+              != openmini::synthesizer::Parameters::kOscillatorEngine)) {
+        synth.SetValue(param_id, 1.0f);
+      }
     }
 
     synth.ProcessAudio(&data[sample_idx], block.size());
@@ -410,3 +432,504 @@ TEST(Synthesizer, ParametersMax) {
   const float kEpsilon(5.0f);
   EXPECT_FALSE(ClickWasFound(&data[1], data.size() - 1, kEpsilon));
 }
+
+/// @brief Memory usage report should account for each module,
+/// and follow the block size
+TEST(Synthesizer, MemoryUsage) {
+  Synthesizer synth;
+  const openmini::synthesizer::MemoryReport report(synth.MemoryUsage());
+  EXPECT_LT(0u, report.generators);
+  EXPECT_LT(0u, report.filters);
+  EXPECT_LT(0u, report.envelopes);
+  EXPECT_LT(0u, report.ring_buffer);
+  EXPECT_LT(0u, report.parameters);
+  EXPECT_LE(sizeof(Synthesizer)
+            + Synthesizer::ArenaSize(openmini::synthesizer::kDefaultBlockSize),
+            report.Total());
+
+  // Growing beyond the arena: the ring buffer gets bigger
+  synth.SetMaxBlockSize(4 * openmini::synthesizer::kDefaultBlockSize);
+  const openmini::synthesizer::MemoryReport grown(synth.MemoryUsage());
+  EXPECT_LT(report.ring_buffer, grown.ring_buffer);
+  EXPECT_LT(report.Total(), grown.Total());
+  EXPECT_EQ(report.generators, grown.generators);
+  EXPECT_EQ(report.filters, grown.filters);
+  EXPECT_EQ(report.envelopes, grown.envelopes);
+}
+
+/// @brief Resident memory growth when creating many instances
+/// (performance test)
+TEST(Synthesizer, MemoryDensity) {
+  const unsigned int kHostBlockSize(256);
+  const std::array<unsigned int, 5> kInstancesCounts = {{1, 10, 100, 1000, 2000}};
+  std::vector<float> data(kHostBlockSize);
+  for (const unsigned int instances_count : kInstancesCounts) {
+    const size_t resident_before(GetResidentMemory());
+    std::vector<std::unique_ptr<Synthesizer>> synths;
+    for (unsigned int i(0); i < instances_count; ++i) {
+      synths.emplace_back(new Synthesizer());
+      synths.back()->SetMaxBlockSize(kHostBlockSize);
+      synths.back()->NoteOn(kMinKeyNote + 13 + i % 64);
+      // Touching all of the instance memory
+      synths.back()->ProcessAudio(&data[0], kHostBlockSize);
+    }
+    const size_t resident_after(GetResidentMemory());
+    const double resident_growth(
+      static_cast<double>(resident_after)
+      - static_cast<double>(resident_before));
+    std::printf("[ PERF     ] %u instances: reported %u bytes per instance, "
+                "resident memory growth %.0f bytes per instance\n",
+                instances_count,
+                static_cast<unsigned int>(synths.back()->MemoryUsage().Total()),
+                resident_growth / instances_count);
+  }
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
+
+/// @brief Maximum instances count rendered in real time on one core,
+/// at 48kHz with 256 samples blocks (performance test)
+TEST(Synthesizer, RealTimeDensity) {
+  const float kOutFrequency(48000.0f);
+  const unsigned int kHostBlockSize(256);
+  const unsigned int kMaxInstancesCount(2000);
+  const unsigned int kMeasuredBlocksCount(8);
+  const double kBlockDuration(kHostBlockSize / kOutFrequency);
+  std::vector<float> data(kHostBlockSize);
+  std::vector<std::unique_ptr<Synthesizer>> synths;
+
+  // Mean time spent rendering one block for the given instances count
+  auto measure = [&](const unsigned int instances_count) {
+    while (synths.size() < instances_count) {
+      synths.emplace_back(new Synthesizer());
+      synths.back()->SetOutputSamplingFrequency(kOutFrequency);
+      synths.back()->SetMaxBlockSize(kHostBlockSize);
+      synths.back()->NoteOn(kMinKeyNote + 13 + synths.size() % 64);
+      synths.back()->ProcessAudio(&data[0], kHostBlockSize);
+    }
+    const std::chrono::high_resolution_clock::time_point start(
+      std::chrono::high_resolution_clock::now());
+    for (unsigned int block(0); block < kMeasuredBlocksCount; ++block) {
+      for (unsigned int i(0); i < instances_count; ++i) {
+        synths[i]->ProcessAudio(&data[0], kHostBlockSize);
+      }
+    }
+    return std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start).count()
+      / kMeasuredBlocksCount;
+  };
+
+  // Bisecting the biggest instances count fitting into one block duration
+  unsigned int fitting(0);
+  unsigned int not_fitting(kMaxInstancesCount + 1);
+  while (not_fitting - fitting > 1) {
+    const unsigned int middle((fitting + not_fitting) / 2);
+    if (measure(middle) <= kBlockDuration) {
+      fitting = middle;
+    } else {
+      not_fitting = middle;
+    }
+  }
+  std::printf("[ PERF     ] Real-time instances on one core "
+              "(48kHz, %u samples blocks): %u%s\n",
+              kHostBlockSize,
+              fitting,
+              (fitting == kMaxInstancesCount) ? " (or more)" : "");
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
+
+/// @brief Default parameters should be the same whichever way
+/// they are assigned
+TEST(Synthesizer, PrecomputedDefaults) {
+  Synthesizer synth;
+  for (unsigned int param_id(0);
+       param_id < openmini::synthesizer::Parameters::kCount;
+       ++param_id) {
+    EXPECT_FLOAT_EQ(kParametersMeta[param_id].default_value(),
+                    synth.GetValue(param_id));
+  }
+}
+
+/// @brief Session-load-like instantiation: construction, preparation
+/// and first block rendering of many instances (performance test)
+TEST(Synthesizer, Instantiation) {
+  const unsigned int kInstancesCount(256);
+  const unsigned int kHostBlockSize(256);
+  std::vector<float> data(kHostBlockSize);
+  std::vector<std::unique_ptr<Synthesizer>> synths;
+
+  const std::chrono::high_resolution_clock::time_point construction_start(
+    std::chrono::high_resolution_clock::now());
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    synths.emplace_back(new Synthesizer());
+  }
+  const unsigned int kConstructedTables(
+    openmini::synthesizer::Wavetables::InstancesCount());
+  const std::chrono::high_resolution_clock::time_point prepare_start(
+    std::chrono::high_resolution_clock::now());
+  for (auto& synth : synths) {
+    synth->SetOutputSamplingFrequency(SamplingRate::Instance().Get());
+    synth->SetMaxBlockSize(kHostBlockSize);
+  }
+  const std::chrono::high_resolution_clock::time_point first_block_start(
+    std::chrono::high_resolution_clock::now());
+  for (auto& synth : synths) {
+    synth->ProcessAudio(&data[0], kHostBlockSize);
+  }
+  const std::chrono::high_resolution_clock::time_point end(
+    std::chrono::high_resolution_clock::now());
+
+  std::printf("[ PERF     ] Instantiation, per instance: construction %.3f us, "
+              "prepare %.3f us, first block %.3f us\n",
+              1e6 * std::chrono::duration<double>(
+                prepare_start - construction_start).count() / kInstancesCount,
+              1e6 * std::chrono::duration<double>(
+                first_block_start - prepare_start).count() / kInstancesCount,
+              1e6 * std::chrono::duration<double>(
+                end - first_block_start).count() / kInstancesCount);
+
+  // Wavetables are only acquired once prepared
+  EXPECT_EQ(0u, kConstructedTables);
+}
+
+/// @brief Warm a synthesizer up: parameters, note and an odd-sized render
+/// leaving pending samples behind
+static void WarmUp(Synthesizer* synth) {
+  synth->SetValue(openmini::synthesizer::Parameters::kOsc2Waveform, 1.0f);
+  synth->SetValue(openmini::synthesizer::Parameters::kFilterFreq, 0.3f);
+  synth->SetValue(openmini::synthesizer::Parameters::kFilterResonance, 0.7f);
+  synth->NoteOn(kMinKeyNote + 25);
+  std::vector<float> intro(kDataTestSetSize + SampleSize - 1);
+  synth->ProcessAudio(&intro[0], intro.size());
+  // Pending parameter change, not processed yet
+  synth->SetValue(openmini::synthesizer::Parameters::kOsc1Volume, 0.5f);
+}
+
+/// @brief Rendering from a restored state should be the same as going on
+/// rendering from the captured one, whichever instance it is restored into
+TEST(Synthesizer, SnapshotRestore) {
+  EXPECT_TRUE(std::is_trivially_copyable<Synthesizer::State>::value);
+
+  Synthesizer synth;
+  WarmUp(&synth);
+  Synthesizer::State state;
+  synth.Snapshot(&state);
+
+  std::vector<float> expected(kDataTestSetSize);
+  synth.NoteOff(kMinKeyNote + 25);
+  synth.ProcessAudio(&expected[0], expected.size());
+
+  // Another instance, in a totally different state
+  Synthesizer other;
+  other.SetValue(openmini::synthesizer::Parameters::kOsc1Waveform, 1.0f);
+  other.NoteOn(kMinKeyNote);
+  std::vector<float> actual(kDataTestSetSize);
+  other.ProcessAudio(&actual[0], actual.size() / 3);
+  // The state blob being trivially copyable, it may be copied around
+  Synthesizer::State copied_state;
+  std::memcpy(&copied_state, &state, sizeof(state));
+  other.Restore(copied_state);
+  other.NoteOff(kMinKeyNote + 25);
+  other.ProcessAudio(&actual[0], actual.size());
+  for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+
+  // Back to the past within the same instance
+  synth.Restore(state);
+  synth.NoteOff(kMinKeyNote + 25);
+  synth.ProcessAudio(&actual[0], actual.size());
+  for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+}
+
+/// @brief Normalized value selecting the given oscillators engine
+static float EngineValue(const int engine) {
+  return (static_cast<float>(engine) + 0.5f)
+         / static_cast<float>(openmini::OscillatorEngine::kCount);
+}
+
+/// @brief Each oscillators engine should render a note at roughly the same
+/// level as the default one, and be restored as well
+/// (without leaking any shared wavetables)
+TEST(Synthesizer, OscillatorEngines) {
+  std::vector<float> reference(kDataTestSetSize);
+  float reference_mean_square(0.0f);
+  for (int engine(openmini::OscillatorEngine::kDPW);
+       engine < openmini::OscillatorEngine::kCount;
+       ++engine) {
+    Synthesizer synth;
+    synth.SetValue(openmini::synthesizer::Parameters::kOscillatorEngine,
+                   EngineValue(engine));
+    WarmUp(&synth);
+    Synthesizer::State state;
+    synth.Snapshot(&state);
+
+    std::vector<float> expected(kDataTestSetSize);
+    synth.ProcessAudio(&expected[0], expected.size());
+    float mean_square(0.0f);
+    for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+      mean_square += expected[i] * expected[i];
+    }
+    mean_square /= kDataTestSetSize;
+    if (openmini::OscillatorEngine::kDPW == engine) {
+      reference = expected;
+      reference_mean_square = mean_square;
+    } else {
+      // Another generators family actually runs
+      EXPECT_NE(reference, expected);
+    }
+    EXPECT_LT(0.0f, mean_square);
+    EXPECT_NEAR(reference_mean_square, mean_square, reference_mean_square);
+
+    // Restored into an instance running with another engine
+    Synthesizer other;
+    other.SetValue(openmini::synthesizer::Parameters::kOscillatorEngine,
+                   EngineValue((engine + 1)
+                               % openmini::OscillatorEngine::kCount));
+    other.NoteOn(kMinKeyNote);
+    std::vector<float> actual(kDataTestSetSize);
+    other.ProcessAudio(&actual[0], actual.size() / 3);
+    other.Restore(state);
+    other.ProcessAudio(&actual[0], actual.size());
+    for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+      EXPECT_EQ(expected[i], actual[i]);
+    }
+  }
+  EXPECT_EQ(0u, openmini::synthesizer::Wavetables::InstancesCount());
+}
+
+/// @brief Render the given length, by blocks of random sizes
+static void RenderByRandomBlocks(Synthesizer* synth,
+                                 float* const output,
+                                 const unsigned int length) {
+  unsigned int data_idx(0);
+  while (data_idx < length) {
+    const unsigned int kMaxLength(std::min(length - data_idx,
+                                           4 * openmini::kBlockSize));
+    const unsigned int kLength(std::uniform_int_distribution<unsigned int>(
+      1,
+      kMaxLength)(kRandomGenerator));
+    synth->ProcessAudio(&output[data_idx], kLength);
+    data_idx += kLength;
+  }
+}
+
+/// @brief Rendering should not depend on the block size, from a note on
+/// to going to sleep and waking up, whatever the oscillators engine
+TEST(Synthesizer, BlockSizeIndependence) {
+  const unsigned int kSegmentLength(kDataTestSetSize / 2);
+  for (int engine(openmini::OscillatorEngine::kDPW);
+       engine < openmini::OscillatorEngine::kCount;
+       ++engine) {
+    Synthesizer whole;
+    Synthesizer random;
+    std::vector<float> expected(3 * kSegmentLength);
+    std::vector<float> actual(3 * kSegmentLength);
+    for (Synthesizer* synth : {&whole, &random}) {
+      synth->SetValue(openmini::synthesizer::Parameters::kOscillatorEngine,
+                      EngineValue(engine));
+      synth->SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.0f);
+      synth->SetValue(openmini::synthesizer::Parameters::kFilterResonance,
+                      0.0f);
+    }
+    // Events happen at the same positions in both cases
+    whole.NoteOn(kMinKeyNote + 13);
+    whole.ProcessAudio(&expected[0], kSegmentLength);
+    whole.NoteOff(kMinKeyNote + 13);
+    whole.ProcessAudio(&expected[kSegmentLength], kSegmentLength);
+    EXPECT_TRUE(whole.IsSleeping());
+    whole.NoteOn(kMinKeyNote + 14);
+    whole.ProcessAudio(&expected[2 * kSegmentLength], kSegmentLength);
+
+    random.NoteOn(kMinKeyNote + 13);
+    RenderByRandomBlocks(&random, &actual[0], kSegmentLength);
+    random.NoteOff(kMinKeyNote + 13);
+    RenderByRandomBlocks(&random, &actual[kSegmentLength], kSegmentLength);
+    random.NoteOn(kMinKeyNote + 14);
+    RenderByRandomBlocks(&random,
+                         &actual[2 * kSegmentLength],
+                         kSegmentLength);
+
+    for (unsigned int i(0); i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i], actual[i]) << i;
+    }
+  }
+}
+
+/// @brief A clone should render the very same output as its original
+TEST(Synthesizer, Clone) {
+  Synthesizer synth(0.5f);
+  WarmUp(&synth);
+  std::unique_ptr<Synthesizer> clone(synth.Clone());
+
+  std::vector<float> expected(kDataTestSetSize);
+  std::vector<float> actual(kDataTestSetSize);
+  synth.ProcessAudio(&expected[0], expected.size());
+  clone->ProcessAudio(&actual[0], actual.size());
+  for (unsigned int i(0); i < kDataTestSetSize; ++i) {
+    EXPECT_EQ(expected[i], actual[i]);
+  }
+}
+
+/// @brief Rendering variations of an intro: from scratch each time,
+/// or forking from a single intro rendering (performance test)
+TEST(Synthesizer, ClonePerf) {
+  const unsigned int kVariationsCount(64);
+  const unsigned int kIntroLength(kDataTestSetSize);
+  const unsigned int kVariationLength(kDataTestSetSize / 8);
+  std::vector<float> data(kIntroLength + SampleSize - 1);
+
+  const std::chrono::high_resolution_clock::time_point scratch_start(
+    std::chrono::high_resolution_clock::now());
+  for (unsigned int i(0); i < kVariationsCount; ++i) {
+    Synthesizer synth;
+    WarmUp(&synth);
+    synth.NoteOn(kMinKeyNote + i % 64);
+    synth.ProcessAudio(&data[0], kVariationLength);
+  }
+  const std::chrono::high_resolution_clock::time_point fork_start(
+    std::chrono::high_resolution_clock::now());
+  Synthesizer intro;
+  WarmUp(&intro);
+  for (unsigned int i(0); i < kVariationsCount; ++i) {
+    std::unique_ptr<Synthesizer> synth(intro.Clone());
+    synth->NoteOn(kMinKeyNote + i % 64);
+    synth->ProcessAudio(&data[0], kVariationLength);
+  }
+  const std::chrono::high_resolution_clock::time_point end(
+    std::chrono::high_resolution_clock::now());
+
+  std::printf("[ PERF     ] %u variations: from scratch %.3f ms, "
+              "forked from one intro %.3f ms\n",
+              kVariationsCount,
+              1e3 * std::chrono::duration<double>(
+                fork_start - scratch_start).count(),
+              1e3 * std::chrono::duration<double>(
+                end - fork_start).count());
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
+
+/// @brief The synthesizer should go to sleep once the note is released
+/// and the filter has rung out, and wake up on the next note
+TEST(Synthesizer, Sleep) {
+  const unsigned int kBlockSize(256);
+  std::vector<float> block(kBlockSize);
+  Synthesizer synth;
+  synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.0f);
+  // A self-oscillating filter never rings out
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterResonance, 0.0f);
+  // Nothing to render before the first note
+  EXPECT_TRUE(synth.IsSleeping());
+  synth.ProcessAudio(&block[0], kBlockSize);
+  for (unsigned int i(0); i < kBlockSize; ++i) {
+    EXPECT_EQ(0.0f, block[i]);
+  }
+
+  for (unsigned int note(0); note < 2; ++note) {
+    synth.NoteOn(kMinKeyNote + 13 + note);
+    EXPECT_FALSE(synth.IsSleeping());
+    float mean_square(0.0f);
+    for (unsigned int sample_idx(0);
+         sample_idx < kDataTestSetSize / 2;
+         sample_idx += kBlockSize) {
+      synth.ProcessAudio(&block[0], kBlockSize);
+      for (unsigned int i(0); i < kBlockSize; ++i) {
+        mean_square += block[i] * block[i];
+      }
+    }
+    EXPECT_FALSE(synth.IsSleeping());
+    EXPECT_LT(0.0f, mean_square);
+
+    synth.NoteOff(kMinKeyNote + 13 + note);
+    for (unsigned int sample_idx(0);
+         sample_idx < kDataTestSetSize / 2;
+         sample_idx += kBlockSize) {
+      synth.ProcessAudio(&block[0], kBlockSize);
+    }
+    EXPECT_TRUE(synth.IsSleeping());
+    synth.ProcessAudio(&block[0], kBlockSize);
+    for (unsigned int i(0); i < kBlockSize; ++i) {
+      EXPECT_EQ(0.0f, block[i]);
+    }
+  }
+}
+
+/// @brief The output should be flagged silent exactly when it is,
+/// and the synthesizer should go to sleep within the reported tail
+TEST(Synthesizer, TailLength) {
+  const unsigned int kBlockSize(64);
+  std::vector<float> block(kBlockSize);
+  Synthesizer synth;
+  synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.1f);
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterFreq, 0.05f);
+  // A self-oscillating filter never rings out
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterResonance, 1.0f);
+  EXPECT_EQ(openmini::synthesizer::kInfiniteTail, synth.TailLength());
+  synth.SetValue(openmini::synthesizer::Parameters::kFilterResonance, 0.0f);
+  const unsigned int kTailLength(synth.TailLength());
+  EXPECT_GT(openmini::synthesizer::kInfiniteTail, kTailLength);
+
+  synth.ProcessAudio(&block[0], kBlockSize);
+  EXPECT_TRUE(synth.IsOutputSilent());
+  synth.NoteOn(kMinKeyNote + 13);
+  for (unsigned int sample_idx(0);
+       sample_idx < kDataTestSetSize / 2;
+       sample_idx += kBlockSize) {
+    synth.ProcessAudio(&block[0], kBlockSize);
+    EXPECT_FALSE(synth.IsOutputSilent());
+  }
+
+  synth.NoteOff(kMinKeyNote + 13);
+  unsigned int tail(0);
+  while (!synth.IsOutputSilent()) {
+    synth.ProcessAudio(&block[0], kBlockSize);
+    tail += kBlockSize;
+    ASSERT_GE(kTailLength + 2 * kBlockSize, tail);
+  }
+  for (unsigned int i(0); i < kBlockSize; ++i) {
+    EXPECT_EQ(0.0f, block[i]);
+  }
+}
+
+/// @brief Rendering cost of a playing versus a sleeping synthesizer
+/// (performance test)
+TEST(Synthesizer, SleepPerf) {
+  const unsigned int kBlockSize(256);
+  const unsigned int kBlocksCount(kFilterDataPerfSetSize / kBlockSize);
+  std::vector<float> block(kBlockSize);
+  double elapsed[2] = {0.0, 0.0};
+  for (unsigned int sleeping(0); sleeping < 2; ++sleeping) {
+    Synthesizer synth;
+    synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.0f);
+    synth.SetValue(openmini::synthesizer::Parameters::kFilterResonance, 0.0f);
+    synth.NoteOn(kMinKeyNote + 13);
+    if (sleeping) {
+      synth.NoteOff(kMinKeyNote + 13);
+      while (!synth.IsSleeping()) {
+        synth.ProcessAudio(&block[0], kBlockSize);
+      }
+    }
+    const std::chrono::high_resolution_clock::time_point start(
+      std::chrono::high_resolution_clock::now());
+    for (unsigned int i(0); i < kBlocksCount; ++i) {
+      synth.ProcessAudio(&block[0], kBlockSize);
+    }
+    elapsed[sleeping] = std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start).count();
+  }
+
+  std::printf("[ PERF     ] Time per block: playing %.3f us, "
+              "sleeping %.3f us\n",
+              1e6 * elapsed[0] / kBlocksCount,
+              1e6 * elapsed[1] / kBlocksCount);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
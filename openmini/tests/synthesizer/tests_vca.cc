@@ -19,6 +19,7 @@
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
 
 // For the Differentiator
 #include "soundtailor/src/generators/generators_common.h"
@@ -26,6 +27,7 @@
 #include "openmini/src/synthesizer/vca.h"
 
 // Using declarations for tested class
+using openmini::synthesizer::Arena;
 using openmini::synthesizer::Vca;
 using soundtailor::generators::Differentiator;
 
@@ -51,7 +53,8 @@ TEST(Vca, Range) {
     const unsigned int kSustain(kTimeDistribution(kRandomGenerator));
     const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
 
-    Vca modulator;
+    Arena arena(Vca::ArenaSize());
+    Vca modulator(&arena);
     modulator.SetAttack(kAttack);
     modulator.SetDecay(kDecay);
     modulator.SetSustain(kSustainLevel);
@@ -123,7 +126,8 @@ TEST(Vca, Timings) {
       SampleSize));
     const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
 
-    Vca modulator;
+    Arena arena(Vca::ArenaSize());
+    Vca modulator(&arena);
     modulator.SetAttack(kAttack);
     modulator.SetDecay(kDecay);
     modulator.SetSustain(kSustainLevel);
@@ -169,7 +173,8 @@ TEST(Vca, ClickEnvelop) {
     const unsigned int kSustain(kTimeDistribution(kRandomGenerator));
     const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
 
-    Vca modulator;
+    Arena arena(Vca::ArenaSize());
+    Vca modulator(&arena);
     modulator.SetAttack(kAttack);
     modulator.SetDecay(kDecay);
     modulator.SetSustain(kSustainLevel);
@@ -201,3 +206,65 @@ TEST(Vca, ClickEnvelop) {
     }
   }  // iterations?
 }
+
+/// @brief Block and per Sample rendering should be the same,
+/// from the attack to the end of the release
+TEST(Vca, BlockProcessing) {
+  const float kFrequency(1000.0f);
+  SinusGenerator input_signal(kFrequency, SamplingRate::Instance().Get());
+  Arena block_arena(Vca::ArenaSize());
+  Arena sample_arena(Vca::ArenaSize());
+  Vca block(&block_arena);
+  Vca sample(&sample_arena);
+  const unsigned int kAttack(kTimeDistribution(kRandomGenerator));
+  const unsigned int kDecay(kTimeDistribution(kRandomGenerator));
+  const float kSustainLevel(kNormPosDistribution(kRandomGenerator));
+  for (Vca* modulator : {&block, &sample}) {
+    modulator->SetAttack(kAttack);
+    modulator->SetDecay(kDecay);
+    modulator->SetSustain(kSustainLevel);
+    modulator->TriggerOn();
+  }
+  std::vector<float> input(kDataTestSetSize);
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    VectorMath::Store(&input[i],
+                      VectorMath::FillWithFloatGenerator(input_signal));
+  }
+  std::vector<float> output(kDataTestSetSize);
+  for (unsigned int i(0); i < kDataTestSetSize; i += openmini::kBlockSize) {
+    if (i == kDataTestSetSize / 2) {
+      block.TriggerOff();
+      sample.TriggerOff();
+    }
+    block.Process(&input[i], &output[i], openmini::kBlockSize);
+    for (unsigned int j(i); j < i + openmini::kBlockSize; j += SampleSize) {
+      EXPECT_TRUE(VectorMath::Equal(VectorMath::Fill(&output[j]),
+                                    sample(VectorMath::Fill(&input[j]))));
+    }
+  }
+}
+
+/// @brief Modulates a sinus with random parameters (performance test)
+TEST(Vca, Perf) {
+  const float kFrequency(1000.0f);
+  SinusGenerator input_signal(kFrequency, SamplingRate::Instance().Get());
+  Arena arena(Vca::ArenaSize());
+  Vca modulator(&arena);
+  modulator.SetAttack(kTimeDistribution(kRandomGenerator));
+  modulator.SetDecay(kTimeDistribution(kRandomGenerator));
+  modulator.SetSustain(kNormPosDistribution(kRandomGenerator));
+  const Sample kInput(VectorMath::FillWithFloatGenerator(input_signal));
+
+  modulator.TriggerOn();
+  PerfCounters counters;
+  counters.Start();
+  for (unsigned int i(0); i < kGeneratorDataPerfSetSize; i += SampleSize) {
+    const Sample output(modulator(kInput));
+    IGNORE(output);
+  }
+  counters.Stop();
+  counters.Report("Vca", kGeneratorDataPerfSetSize);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
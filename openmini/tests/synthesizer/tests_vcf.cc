@@ -0,0 +1,141 @@
+/// @filename tests_vcf.cc
+/// @brief VCF specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
+
+#include "openmini/src/synthesizer/dual_ladder.h"
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/vcf.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::Arena;
+using openmini::synthesizer::DualLadder;
+using openmini::synthesizer::Vcf;
+
+// Using declarations for parameters metadata
+using openmini::synthesizer::Parameters::kParametersMeta;
+
+/// @brief A fully dry setting should output the dry filter only
+TEST(Vcf, DryOnly) {
+  const float kFrequency(0.25f);
+  const float kResonance(1.0f);
+  Arena arena(Vcf::ArenaSize());
+  Vcf filter(&arena);
+  filter.SetFrequency(kFrequency);
+  filter.SetResonance(kResonance);
+  filter.SetAmount(0.0f);
+  filter.TriggerOn();
+  DualLadder reference;
+  reference.SetFrequency(openmini::synthesizer::LadderLane::kDry, kFrequency);
+  reference.SetResonance(kResonance);
+
+  for (unsigned int i(0); i < kDataTestSetSize; i += SampleSize) {
+    const Sample input(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+    EXPECT_TRUE(VectorMath::Equal(reference(input, 1.0f, 0.0f),
+                                  filter(input)));
+  }
+}
+
+/// @brief Switching from fully dry to fully wet should not click:
+/// both filters are always run on the same input
+TEST(Vcf, SmoothDryWetChange) {
+  const unsigned int kHistoryLength(4096);
+  Arena arena(Vcf::ArenaSize());
+  Vcf filter(&arena);
+  filter.SetFrequency(0.1f);
+  filter.SetResonance(1.0f);
+  filter.SetAmount(0.0f);
+  SinusGenerator generator(440.0f, 48000.0f);
+  std::vector<float> output(2 * kHistoryLength);
+
+  for (unsigned int i(0); i < output.size(); i += SampleSize) {
+    if (i == kHistoryLength) {
+      filter.SetAmount(1.0f);
+    }
+    const Sample input(VectorMath::FillWithFloatGenerator(generator));
+    VectorMath::Store(&output[i], filter(input));
+  }
+  // Not testing the filter onset
+  const float kEpsilon(10.0f);
+  EXPECT_FALSE(ClickWasFound(&output[kHistoryLength / 2],
+                             kHistoryLength,
+                             kEpsilon));
+}
+
+/// @brief Block and per Sample rendering should be the same,
+/// the wet filter following its contour
+TEST(Vcf, BlockProcessing) {
+  Arena block_arena(Vcf::ArenaSize());
+  Arena sample_arena(Vcf::ArenaSize());
+  Vcf block(&block_arena);
+  Vcf sample(&sample_arena);
+  for (Vcf* filter : {&block, &sample}) {
+    filter->SetFrequency(0.1f);
+    filter->SetResonance(1.0f);
+    filter->SetAttack(kDataTestSetSize / 8);
+    filter->SetDecay(kDataTestSetSize / 8);
+    filter->SetSustain(0.5f);
+    filter->SetAmount(0.5f);
+    filter->TriggerOn();
+  }
+  std::vector<float> input(kDataTestSetSize);
+  for (float& value : input) {
+    value = kNormDistribution(kRandomGenerator);
+  }
+  std::vector<float> output(kDataTestSetSize);
+  for (unsigned int i(0); i < kDataTestSetSize; i += openmini::kBlockSize) {
+    if (i == kDataTestSetSize / 2) {
+      block.TriggerOff();
+      sample.TriggerOff();
+    }
+    block.Process(&input[i], &output[i], openmini::kBlockSize);
+    for (unsigned int j(i); j < i + openmini::kBlockSize; j += SampleSize) {
+      EXPECT_TRUE(VectorMath::Equal(VectorMath::Fill(&output[j]),
+                                    sample(VectorMath::Fill(&input[j]))));
+    }
+  }
+}
+
+/// @brief Filters a random signal with a half dry/wet mix (performance test)
+TEST(Vcf, Perf) {
+  const openmini::synthesizer::ParameterMeta& kFreqMeta(
+    kParametersMeta[openmini::synthesizer::Parameters::kFilterFreq]);
+  Arena arena(Vcf::ArenaSize());
+  Vcf filter(&arena);
+  filter.SetFrequency(kFreqMeta.min()
+                      + (kFreqMeta.max() - kFreqMeta.min())
+                        * kNormPosDistribution(kRandomGenerator));
+  filter.SetAmount(0.5f);
+  filter.TriggerOn();
+  const Sample kInput(VectorMath::Fill(kNormDistribution(kRandomGenerator)));
+
+  PerfCounters counters;
+  counters.Start();
+  for (unsigned int i(0); i < kFilterDataPerfSetSize; i += SampleSize) {
+    const Sample output(filter(kInput));
+    IGNORE(output);
+  }
+  counters.Stop();
+  counters.Report("Vcf", kFilterDataPerfSetSize);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
@@ -19,6 +19,7 @@
 /// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "openmini/tests/tests.h"
+#include "openmini/tests/perf_counters.h"
 
 // For the Differentiator
 // TODO(gm): do not use SoundTailor Differentiator here
@@ -27,6 +28,7 @@
 #include "openmini/src/synthesizer/vco.h"
 
 // Using declarations for tested class
+using openmini::synthesizer::Arena;
 using openmini::synthesizer::Vco;
 using soundtailor::generators::Differentiator;
 
@@ -41,7 +43,8 @@ TEST(Vco, SmoothWaveformChange) {
   for (unsigned int iterations(0); iterations < kIterations; ++iterations) {
     IGNORE(iterations);
 
-    Vco vco;
+    Arena arena(Vco::ArenaSize());
+    Vco vco(&arena);
 
     const float kFrequency(kFreqDistribution(kRandomGenerator));
 
@@ -76,3 +79,48 @@ TEST(Vco, SmoothWaveformChange) {
     }
   }  // iterations?
 }
+
+/// @brief Generates a signal (performance test)
+/// @brief A muted VCO should output zeros, then resume exactly where it
+/// stopped once unmuted
+TEST(Vco, MutedResume) {
+  const unsigned int kHistoryLength(1024);
+  Arena arena(2 * Vco::ArenaSize());
+  Vco vco(&arena);
+  Vco reference(&arena);
+  const float kFrequency(kFreqDistribution(kRandomGenerator));
+  vco.SetFrequency(kFrequency);
+  reference.SetFrequency(kFrequency);
+
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(reference(), vco()));
+  }
+  vco.SetVolume(0.0f);
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(VectorMath::Fill(0.0f), vco()));
+  }
+  vco.SetVolume(1.0f);
+  for (unsigned int i(0); i < kHistoryLength; i += SampleSize) {
+    EXPECT_TRUE(VectorMath::Equal(reference(), vco()));
+  }
+}
+
+/// @brief Generates a signal (performance test)
+TEST(Vco, Perf) {
+  Arena arena(Vco::ArenaSize());
+  Vco vco(&arena);
+  vco.SetFrequency(kFreqDistribution(kRandomGenerator)
+                   * SamplingRate::Instance().Get());
+
+  PerfCounters counters;
+  counters.Start();
+  for (unsigned int i(0); i < kGeneratorDataPerfSetSize; i += SampleSize) {
+    const Sample output(vco());
+    IGNORE(output);
+  }
+  counters.Stop();
+  counters.Report("Vco", kGeneratorDataPerfSetSize);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
@@ -0,0 +1,172 @@
+/// @filename tests_wavetables.cc
+/// @brief Wavetables specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/wavetable_oscillator.h"
+#include "openmini/src/synthesizer/wavetables.h"
+
+// Using declarations for tested class
+using openmini::generators::WavetableOscillator;
+using openmini::synthesizer::kWavetableLength;
+using openmini::synthesizer::kWavetableOctavesCount;
+using openmini::synthesizer::kWavetableLowestFrequency;
+using openmini::synthesizer::Wavetables;
+
+/// @brief Sampling rate used in these tests
+static const float kTablesSamplingRate(44100.0f);
+
+/// @brief Directory the tests tables are stored into
+static const std::string kTablesDirectory("openmini_tests_wavetables");
+
+/// @brief All users share the same tables, destroyed with the last one;
+/// generators do not hold any by themselves
+TEST(Wavetables, Shared) {
+  EXPECT_EQ(0u, Wavetables::InstancesCount());
+  {
+    WavetableOscillator triangle(openmini::Waveform::kTriangle);
+    WavetableOscillator sawtooth(openmini::Waveform::kSawtooth);
+    EXPECT_EQ(0u, Wavetables::InstancesCount());
+    const Wavetables* tables(
+      Wavetables::Acquire(SamplingRate::Instance().Get()));
+    const Wavetables* same_tables(
+      Wavetables::Acquire(SamplingRate::Instance().Get()));
+    EXPECT_EQ(tables, same_tables);
+    EXPECT_EQ(1u, Wavetables::InstancesCount());
+    triangle.SetTables(tables);
+    sawtooth.SetTables(same_tables);
+    const Wavetables* other_tables(Wavetables::Acquire(kTablesSamplingRate));
+    EXPECT_EQ(2u, Wavetables::InstancesCount());
+    EXPECT_NE(tables, other_tables);
+    Wavetables::Release(other_tables);
+    Wavetables::Release(same_tables);
+    EXPECT_EQ(1u, Wavetables::InstancesCount());
+    Wavetables::Release(tables);
+  }
+  EXPECT_EQ(0u, Wavetables::InstancesCount());
+}
+
+/// @brief Each table holds all harmonics below Nyquist of its octave
+/// highest fundamental, and only them
+TEST(Wavetables, BandLimited) {
+  const Wavetables* tables(Wavetables::Acquire(kTablesSamplingRate));
+  for (unsigned int octave(0); octave < kWavetableOctavesCount; ++octave) {
+    const float fundamental(kWavetableLowestFrequency
+                            * std::pow(2.0f, static_cast<float>(octave)));
+    const float* table(tables->Table(openmini::Waveform::kSawtooth,
+                                     1.5f * fundamental));
+    // Lower octaves are limited by the table length
+    const unsigned int expected(std::max(1u, std::min(
+      kWavetableLength / 2 - 1,
+      static_cast<unsigned int>(0.25f * kTablesSamplingRate / fundamental))));
+    for (const unsigned int harmonic : {1u, expected, expected + 1}) {
+      double imaginary(0.0);
+      for (unsigned int i(0); i < kWavetableLength; ++i) {
+        imaginary += table[i] * std::sin(2.0 * openmini::Pi * harmonic * i
+                                         / kWavetableLength);
+      }
+      // Sawtooth harmonics amplitudes: 2 / (pi * k)
+      const double amplitude(std::fabs(2.0 * imaginary / kWavetableLength));
+      if (harmonic <= expected) {
+        EXPECT_NEAR(2.0 / (openmini::Pi * harmonic), amplitude, 1e-4)
+          << "octave " << octave << ", harmonic " << harmonic;
+      } else {
+        EXPECT_NEAR(0.0, amplitude, 1e-4)
+          << "octave " << octave << ", harmonic " << harmonic;
+      }
+    }
+    EXPECT_EQ(table[0], table[kWavetableLength]);
+  }
+  Wavetables::Release(tables);
+}
+
+/// @brief Saved tables should be mapped by later instances,
+/// and be the same as built ones
+TEST(Wavetables, Mapped) {
+  const std::string path(kTablesDirectory + "/wavetables_44100.tables");
+  std::remove(path.c_str());
+  Wavetables::SetDirectory(kTablesDirectory);
+
+  const Wavetables* built(Wavetables::Acquire(kTablesSamplingRate));
+  EXPECT_FALSE(built->IsMapped());
+  std::vector<float> expected;
+  for (unsigned int waveform(0);
+       waveform < openmini::Waveform::kCount;
+       ++waveform) {
+    for (unsigned int octave(0); octave < kWavetableOctavesCount; ++octave) {
+      const float* table(built->Table(
+        static_cast<openmini::Waveform::Type>(waveform),
+        kWavetableLowestFrequency * std::pow(2.0f, octave + 0.5f)));
+      expected.insert(expected.end(), table, &table[kWavetableLength + 1]);
+    }
+  }
+  Wavetables::Release(built);
+
+  const Wavetables* mapped(Wavetables::Acquire(kTablesSamplingRate));
+#if (defined(__unix__) || defined(__APPLE__))
+  EXPECT_TRUE(mapped->IsMapped());
+#endif  // (defined(__unix__) || defined(__APPLE__))
+  unsigned int index(0);
+  for (unsigned int waveform(0);
+       waveform < openmini::Waveform::kCount;
+       ++waveform) {
+    for (unsigned int octave(0); octave < kWavetableOctavesCount; ++octave) {
+      const float* table(mapped->Table(
+        static_cast<openmini::Waveform::Type>(waveform),
+        kWavetableLowestFrequency * std::pow(2.0f, octave + 0.5f)));
+      for (unsigned int i(0); i <= kWavetableLength; ++i) {
+        EXPECT_EQ(expected[index], table[i]);
+        index += 1;
+      }
+    }
+  }
+  Wavetables::Release(mapped);
+  Wavetables::SetDirectory("");
+}
+
+/// @brief Tables building and mapping durations (performance test)
+TEST(Wavetables, Perf) {
+  const std::string path(kTablesDirectory + "/wavetables_44100.tables");
+  std::remove(path.c_str());
+  Wavetables::SetDirectory(kTablesDirectory);
+  double durations[2];
+  for (double& duration : durations) {
+    const std::chrono::high_resolution_clock::time_point start(
+      std::chrono::high_resolution_clock::now());
+    const Wavetables* tables(Wavetables::Acquire(kTablesSamplingRate));
+    duration = std::chrono::duration<double>(
+      std::chrono::high_resolution_clock::now() - start).count();
+    Wavetables::Release(tables);
+  }
+  Wavetables::SetDirectory("");
+
+  std::printf("[ PERF     ] Wavetables: built %.3f ms, "
+              "mapped %.3f ms, %u bytes per generator\n",
+              1e3 * durations[0],
+              1e3 * durations[1],
+              static_cast<unsigned int>(sizeof(WavetableOscillator)));
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}
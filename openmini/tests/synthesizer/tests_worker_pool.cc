@@ -0,0 +1,229 @@
+/// @filename tests_worker_pool.cc
+/// @brief WorkerPool and PooledRenderer specific tests
+/// @author gm
+/// @copyright gm 2016
+///
+/// This file is part of OpenMini
+///
+/// OpenMini is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU General Public License as published by
+/// the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// OpenMini is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with OpenMini.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <chrono>
+#include <memory>
+
+#include "openmini/tests/tests.h"
+
+#include "openmini/src/synthesizer/parameters.h"
+#include "openmini/src/synthesizer/synthesizer.h"
+#include "openmini/src/synthesizer/worker_pool.h"
+
+// Using declarations for tested class
+using openmini::synthesizer::PooledRenderer;
+using openmini::synthesizer::Synthesizer;
+using openmini::synthesizer::WorkerPool;
+
+/// @brief Maximum host block size used in these tests
+static const unsigned int kPoolMaxBlockSize(512);
+
+/// @brief The pool is shared: acquiring it twice gives the same one
+TEST(WorkerPool, Shared) {
+  WorkerPool* first(WorkerPool::Acquire());
+  WorkerPool* second(WorkerPool::Acquire());
+  EXPECT_EQ(first, second);
+  EXPECT_LE(1u, first->ThreadsCount());
+  WorkerPool::Release();
+  WorkerPool::Release();
+}
+
+/// @brief Output of several pooled instances, with random block sizes,
+/// should be the same as direct rendering delayed by the reported latency
+TEST(WorkerPool, SameOutput) {
+  const unsigned int kInstancesCount(8);
+  const unsigned int kDataLength(64 * kPoolMaxBlockSize);
+  std::vector<std::unique_ptr<Synthesizer>> direct_synths;
+  std::vector<std::unique_ptr<Synthesizer>> pooled_synths;
+  std::vector<std::unique_ptr<PooledRenderer>> renderers;
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    direct_synths.emplace_back(new Synthesizer());
+    pooled_synths.emplace_back(new Synthesizer());
+    for (auto* synth : {direct_synths.back().get(),
+                        pooled_synths.back().get()}) {
+      synth->SetOutputSamplingFrequency(48000.0f);
+      synth->SetMaxBlockSize(kPoolMaxBlockSize);
+      synth->NoteOn(kMinKeyNote + 13 + 4 * i);
+    }
+    renderers.emplace_back(new PooledRenderer(pooled_synths.back().get(),
+                                              kPoolMaxBlockSize));
+    EXPECT_TRUE(renderers.back()->IsPooled());
+    EXPECT_EQ(kPoolMaxBlockSize, renderers.back()->Latency());
+  }
+
+  std::vector<std::vector<float>> expected(kInstancesCount,
+                                           std::vector<float>(kDataLength));
+  std::vector<std::vector<float>> actual(kInstancesCount,
+                                         std::vector<float>(kDataLength));
+  std::uniform_int_distribution<unsigned int> kBlockSizeDistribution(
+    1,
+    kPoolMaxBlockSize);
+  unsigned int sample_idx(0);
+  while (sample_idx < kDataLength) {
+    const unsigned int kLength(std::min(kBlockSizeDistribution(kRandomGenerator),
+                                        kDataLength - sample_idx));
+    // Same as a host serially processing each instance
+    for (unsigned int i(0); i < kInstancesCount; ++i) {
+      direct_synths[i]->ProcessAudio(&expected[i][sample_idx], kLength);
+      renderers[i]->Sync();
+      renderers[i]->ProcessAudio(&actual[i][sample_idx], kLength);
+    }
+    sample_idx += kLength;
+  }
+  renderers.clear();
+
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    for (unsigned int j(0); j < kPoolMaxBlockSize; ++j) {
+      EXPECT_EQ(0.0f, actual[i][j]);
+    }
+    for (unsigned int j(kPoolMaxBlockSize); j < kDataLength; ++j) {
+      EXPECT_EQ(expected[i][j - kPoolMaxBlockSize], actual[i][j]);
+    }
+  }
+}
+
+/// @brief Blocks longer than the max block size should be split,
+/// the output staying the same as direct rendering
+TEST(WorkerPool, OversizedBlocks) {
+  const unsigned int kDataLength(64 * kPoolMaxBlockSize);
+  Synthesizer direct_synth;
+  Synthesizer pooled_synth;
+  for (auto* synth : {&direct_synth, &pooled_synth}) {
+    synth->SetOutputSamplingFrequency(48000.0f);
+    synth->SetMaxBlockSize(kPoolMaxBlockSize);
+    synth->NoteOn(kMinKeyNote + 13);
+  }
+  std::unique_ptr<PooledRenderer> renderer(
+    new PooledRenderer(&pooled_synth, kPoolMaxBlockSize));
+  EXPECT_TRUE(renderer->IsPooled());
+
+  std::vector<float> expected(kDataLength);
+  std::vector<float> actual(kDataLength);
+  std::uniform_int_distribution<unsigned int> kBlockSizeDistribution(
+    1,
+    3 * kPoolMaxBlockSize);
+  unsigned int sample_idx(0);
+  while (sample_idx < kDataLength) {
+    const unsigned int kLength(std::min(kBlockSizeDistribution(kRandomGenerator),
+                                        kDataLength - sample_idx));
+    direct_synth.ProcessAudio(&expected[sample_idx], kLength);
+    renderer->ProcessAudio(&actual[sample_idx], kLength);
+    sample_idx += kLength;
+  }
+  renderer.reset();
+
+  for (unsigned int j(0); j < kPoolMaxBlockSize; ++j) {
+    EXPECT_EQ(0.0f, actual[j]);
+  }
+  for (unsigned int j(kPoolMaxBlockSize); j < kDataLength; ++j) {
+    EXPECT_EQ(expected[j - kPoolMaxBlockSize], actual[j]);
+  }
+}
+
+/// @brief Output flagged as silent should only be zeros, from before
+/// the note on to after the synthesizer went back to sleep
+TEST(WorkerPool, SilentOutput) {
+  const unsigned int kHostBlockSize(kPoolMaxBlockSize / 2);
+  const unsigned int kBlocksCount(64);
+  const unsigned int kNoteOnBlock(4);
+  const unsigned int kNoteOffBlock(12);
+  Synthesizer synth;
+  synth.SetOutputSamplingFrequency(48000.0f);
+  synth.SetMaxBlockSize(kPoolMaxBlockSize);
+  synth.SetValue(openmini::synthesizer::Parameters::kDecayTime, 0.0f);
+  PooledRenderer renderer(&synth, kPoolMaxBlockSize);
+  EXPECT_TRUE(renderer.IsPooled());
+
+  std::vector<float> data(kHostBlockSize);
+  unsigned int silent_count(0);
+  for (unsigned int block(0); block < kBlocksCount; ++block) {
+    renderer.Sync();
+    if (kNoteOnBlock == block) {
+      synth.NoteOn(kMinKeyNote + 37);
+    } else if (kNoteOffBlock == block) {
+      synth.NoteOff(kMinKeyNote + 37);
+    }
+    renderer.ProcessAudio(&data[0], kHostBlockSize);
+    // The note on is delayed by the latency
+    if (block <= kNoteOnBlock) {
+      EXPECT_TRUE(renderer.IsOutputSilent());
+    }
+    if (renderer.IsOutputSilent()) {
+      silent_count += 1;
+      for (const float sample : data) {
+        EXPECT_EQ(0.0f, sample);
+      }
+    }
+  }
+  // Back to sleep
+  EXPECT_TRUE(renderer.IsOutputSilent());
+  EXPECT_GT(kBlocksCount, silent_count);
+}
+
+/// @brief Many instances processed serially by the host thread,
+/// rendered directly or through the pool (performance test)
+TEST(WorkerPool, Perf) {
+  const unsigned int kInstancesCount(48);
+  const unsigned int kBlockSize(256);
+  const unsigned int kBlocksCount(kFilterDataPerfSetSize / kBlockSize / 16);
+  std::vector<std::unique_ptr<Synthesizer>> synths;
+  for (unsigned int i(0); i < kInstancesCount; ++i) {
+    synths.emplace_back(new Synthesizer());
+    synths.back()->SetOutputSamplingFrequency(48000.0f);
+    synths.back()->SetMaxBlockSize(kBlockSize);
+    synths.back()->NoteOn(kMinKeyNote + 13 + i);
+  }
+  std::vector<float> data(kBlockSize);
+
+  const std::chrono::high_resolution_clock::time_point direct_start(
+    std::chrono::high_resolution_clock::now());
+  for (unsigned int block(0); block < kBlocksCount; ++block) {
+    for (auto& synth : synths) {
+      synth->ProcessAudio(&data[0], kBlockSize);
+    }
+  }
+  const double direct(std::chrono::duration<double>(
+    std::chrono::high_resolution_clock::now() - direct_start).count());
+
+  std::vector<std::unique_ptr<PooledRenderer>> renderers;
+  for (auto& synth : synths) {
+    renderers.emplace_back(new PooledRenderer(synth.get(), kBlockSize));
+  }
+  const std::chrono::high_resolution_clock::time_point pooled_start(
+    std::chrono::high_resolution_clock::now());
+  for (unsigned int block(0); block < kBlocksCount; ++block) {
+    for (auto& renderer : renderers) {
+      renderer->Sync();
+      renderer->ProcessAudio(&data[0], kBlockSize);
+    }
+  }
+  const double pooled(std::chrono::duration<double>(
+    std::chrono::high_resolution_clock::now() - pooled_start).count());
+  renderers.clear();
+
+  std::printf("[ PERF     ] %u instances, host thread time per block: "
+              "direct %.3f us, pooled %.3f us\n",
+              kInstancesCount,
+              1e6 * direct / kBlocksCount,
+              1e6 * pooled / kBlocksCount);
+
+  // No actual test!
+  EXPECT_TRUE(true);
+}